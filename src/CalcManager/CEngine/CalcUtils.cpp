@@ -33,7 +33,8 @@ bool IsDigitOpCode(OpCode opCode)
 // was never inout, we need to revert the state changes made as a result of this test
 bool IsGuiSettingOpCode(OpCode opCode)
 {
-    if (IsOpInRange(opCode, IDM_HEX, IDM_BIN) || IsOpInRange(opCode, IDM_QWORD, IDM_BYTE) || IsOpInRange(opCode, IDM_DEG, IDM_GRAD))
+    if (IsOpInRange(opCode, IDM_HEX, IDM_BIN) || IsOpInRange(opCode, IDM_QWORD, IDM_BYTE) || IsOpInRange(opCode, IDM_WORD128, IDM_WORD1024)
+        || IsOpInRange(opCode, IDM_DEG, IDM_GRAD))
     {
         return true;
     }
@@ -27,6 +27,7 @@ void CHistoryCollector::ReinitHistory()
     m_lastBinOpStartIndex = -1;
     m_curOperandIndex = 0;
     m_bLastOpndBrace = false;
+    m_cShownTokens = 0;
     if (m_spTokens != nullptr)
     {
         m_spTokens->Clear();
@@ -44,6 +45,8 @@ CHistoryCollector::CHistoryCollector(ICalcDisplay* pCalcDisplay, std::shared_ptr
     , m_pCalcDisplay(pCalcDisplay)
     , m_iCurLineHistStart(-1)
     , m_decimalSymbol(decimalSymbol)
+    , m_fDeferTokens(false)
+    , m_cShownTokens(0)
 {
     ReinitHistory();
 }
@@ -60,6 +63,29 @@ CHistoryCollector::~CHistoryCollector()
 }
 
 void CHistoryCollector::AddOpndToHistory(wstring_view numStr, Rational const& rat, bool fRepetition)
+{
+    if (m_fDeferTokens)
+    {
+        // numStr isn't looked at, it may not be up to date. The token is made from rat later.
+        auto operandCommand = std::make_shared<COpndCommand>(std::make_shared<CalculatorVector<int>>(), false, false, false);
+        operandCommand->Initialize(rat);
+        m_lastOpStartIndex = IchAddSzToEquationSz(wstring_view{}, AddCommand(operandCommand));
+    }
+    else
+    {
+        int iCommandEnd = AddCommand(CreateOperandCommand(numStr, rat));
+        m_lastOpStartIndex = IchAddSzToEquationSz(numStr, iCommandEnd);
+    }
+
+    if (fRepetition)
+    {
+        SetExpressionDisplay();
+    }
+    m_bLastOpndBrace = false;
+    m_lastBinOpStartIndex = -1;
+}
+
+shared_ptr<COpndCommand> CHistoryCollector::CreateOperandCommand(wstring_view numStr, Rational const& rat)
 {
     std::shared_ptr<CalculatorVector<int>> commands = std::make_shared<CalculatorVector<int>>();
     // Check for negate
@@ -101,15 +127,7 @@ void CHistoryCollector::AddOpndToHistory(wstring_view numStr, Rational const& ra
 
     auto operandCommand = std::make_shared<COpndCommand>(commands, fNegative, fDecimal, fSciFmt);
     operandCommand->Initialize(rat);
-    int iCommandEnd = AddCommand(operandCommand);
-    m_lastOpStartIndex = IchAddSzToEquationSz(numStr, iCommandEnd);
-
-    if (fRepetition)
-    {
-        SetExpressionDisplay();
-    }
-    m_bLastOpndBrace = false;
-    m_lastBinOpStartIndex = -1;
+    return operandCommand;
 }
 
 void CHistoryCollector::RemoveLastOpndFromHistory()
@@ -301,7 +319,7 @@ void CHistoryCollector::AddUnaryOpToHistory(int nOpCode, bool fInv, ANGLE_TYPE a
 // history of equations
 void CHistoryCollector::CompleteHistoryLine(wstring_view numStr)
 {
-    if (nullptr != m_pCalcDisplay)
+    if (nullptr != m_pCalcDisplay && !m_fDeferTokens)
     {
         m_pCalcDisplay->SetExpressionDisplay(
             std::make_shared<CalculatorVector<std::pair<std::wstring, int>>>(), std::make_shared<CalculatorVector<std::shared_ptr<IExpressionCommand>>>());
@@ -323,7 +341,7 @@ void CHistoryCollector::ClearHistoryLine(wstring_view errStr)
 {
     if (errStr.empty()) // in case of error let the display stay as it is
     {
-        if (nullptr != m_pCalcDisplay)
+        if (nullptr != m_pCalcDisplay && !m_fDeferTokens)
         {
             m_pCalcDisplay->SetExpressionDisplay(
                 std::make_shared<CalculatorVector<std::pair<std::wstring, int>>>(), std::make_shared<CalculatorVector<std::shared_ptr<IExpressionCommand>>>());
@@ -390,7 +408,13 @@ void CHistoryCollector::TruncateEquationSzFromIch(int ich)
 // Adds the m_pszEquation into the running history text
 void CHistoryCollector::SetExpressionDisplay()
 {
-    if (nullptr != m_pCalcDisplay)
+    m_cShownTokens = 0;
+    if (m_spTokens != nullptr)
+    {
+        IFT(m_spTokens->GetSize(&m_cShownTokens));
+    }
+
+    if (nullptr != m_pCalcDisplay && !m_fDeferTokens)
     {
         m_pCalcDisplay->SetExpressionDisplay(m_spTokens, m_spCommands);
     }
@@ -448,6 +472,95 @@ void CHistoryCollector::UpdateHistoryExpression(uint32_t radix, int32_t precisio
     SetExpressionDisplay();
 }
 
+// Once tokens are no longer deferred the expression is shown as it is, what was deferred has to have been made first
+void CHistoryCollector::SetDeferTokens(bool fDeferTokens)
+{
+    bool fShow = m_fDeferTokens && !fDeferTokens;
+    m_fDeferTokens = fDeferTokens;
+
+    if (fShow && nullptr != m_pCalcDisplay)
+    {
+        // Only the tokens that would have been shown are, an operand added since is not until the next operator
+        auto spTokens = std::make_shared<CalculatorVector<std::pair<std::wstring, int>>>();
+        for (unsigned int i = 0; m_spTokens != nullptr && i < m_cShownTokens; i++)
+        {
+            std::pair<std::wstring, int> token;
+            IFT(m_spTokens->GetAt(i, &token));
+            IFT(spTokens->Append(token));
+        }
+        m_pCalcDisplay->SetExpressionDisplay(
+            spTokens, m_spCommands != nullptr ? m_spCommands : std::make_shared<CalculatorVector<std::shared_ptr<IExpressionCommand>>>());
+    }
+}
+
+// Called after = in place of CompleteHistoryLine while tokens are deferred. The line is kept with its result,
+// to be made and added to the history by CompleteDeferredLines.
+void CHistoryCollector::DeferHistoryLine(Rational const& result)
+{
+    if (nullptr != m_pHistoryDisplay && m_spTokens != nullptr && m_spCommands != nullptr)
+    {
+        if (m_deferredLines.size() == MAXDEFERREDLINES)
+        {
+            m_deferredLines.pop_front();
+        }
+        m_deferredLines.push_back({ m_spTokens, m_spCommands, result });
+    }
+
+    m_spTokens = nullptr;
+    m_spCommands = nullptr;
+    m_iCurLineHistStart = -1; // It will get recomputed at the first Opnd
+    ReinitHistory();
+}
+
+// Makes the tokens of the lines completed while deferred and adds them to the history, then makes those of the
+// current line. The engine has to call it before anything its display strings depend on changes, it makes the
+// strings the way it made them for its display.
+void CHistoryCollector::CompleteDeferredLines(CCalcEngine& engine)
+{
+    for (auto& line : m_deferredLines)
+    {
+        RenderDeferredOperands(engine, *line.spTokens, *line.spCommands);
+        uint32_t radix = engine.GetCurrentRadix();
+        wstring result = engine.GroupDigitsPerRadix(engine.GetStringForDisplay(line.result, radix), radix);
+        unsigned int addedItemIndex = m_pHistoryDisplay->AddToHistory(line.spTokens, line.spCommands, result);
+        m_pCalcDisplay->OnHistoryItemAdded(addedItemIndex);
+    }
+    m_deferredLines.clear();
+
+    if (m_spTokens != nullptr && m_spCommands != nullptr)
+    {
+        RenderDeferredOperands(engine, *m_spTokens, *m_spCommands);
+    }
+}
+
+// Gives each operand added while deferred, which has an empty token, its token and the commands it would have been added with
+void CHistoryCollector::RenderDeferredOperands(
+    CCalcEngine& engine,
+    CalculatorVector<std::pair<std::wstring, int>>& tokens,
+    CalculatorVector<std::shared_ptr<IExpressionCommand>>& commands)
+{
+    unsigned int size;
+    IFT(tokens.GetSize(&size));
+
+    for (unsigned int i = 0; i < size; ++i)
+    {
+        std::pair<std::wstring, int> token;
+        IFT(tokens.GetAt(i, &token));
+        if (token.second != -1 && token.first.empty())
+        {
+            std::shared_ptr<IExpressionCommand> expCommand;
+            IFT(commands.GetAt(token.second, &expCommand));
+            if (expCommand != nullptr && CalculationManager::CommandType::OperandCommand == expCommand->GetCommandType())
+            {
+                std::shared_ptr<COpndCommand> opndCommand = std::static_pointer_cast<COpndCommand>(expCommand);
+                token.first = engine.GetStringForDisplay(opndCommand->GetValue(), engine.GetCurrentRadix());
+                IFT(tokens.SetAt(i, token));
+                IFT(commands.SetAt(token.second, CreateOperandCommand(token.first, opndCommand->GetValue())));
+            }
+        }
+    }
+}
+
 void CHistoryCollector::SetDecimalSymbol(wchar_t decimalSymbol)
 {
     m_decimalSymbol = decimalSymbol;
@@ -0,0 +1,712 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Header Files/IntegerMath.h"
+#include "Header Files/RationalMath.h"
+
+using namespace std;
+using namespace CalcEngine;
+using namespace CalcEngine::IntegerMath;
+
+namespace
+{
+    constexpr int32_t LIMB_BITS = 32;
+
+    int32_t LimbCount(int32_t bitWidth)
+    {
+        return (bitWidth + LIMB_BITS - 1) / LIMB_BITS;
+    }
+
+    // Clears the bits of a at and above bitWidth.
+    void Truncate(WideWord& a, int32_t bitWidth)
+    {
+        int32_t n = LimbCount(bitWidth);
+        if (bitWidth % LIMB_BITS != 0)
+        {
+            a.limbs[n - 1] &= (uint32_t{ 1 } << (bitWidth % LIMB_BITS)) - 1;
+        }
+        for (int32_t i = n; i < WIDE_WORD_LIMBS; i++)
+        {
+            a.limbs[i] = 0;
+        }
+    }
+
+    // The count of significant limbs among the low n of a.
+    int32_t Length(WideWord const& a, int32_t n)
+    {
+        while (n > 0 && a.limbs[n - 1] == 0)
+        {
+            n--;
+        }
+        return n;
+    }
+
+    // The count of significant bits of a.
+    int32_t BitLength(WideWord const& a)
+    {
+        int32_t n = Length(a, WIDE_WORD_LIMBS);
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        int32_t bits = (n - 1) * LIMB_BITS;
+        for (uint32_t top = a.limbs[n - 1]; top != 0; top >>= 1)
+        {
+            bits++;
+        }
+        return bits;
+    }
+
+    // The count bits of a from bit up, count is at most a nibble.
+    uint32_t Bits(WideWord const& a, int32_t bit, int32_t count)
+    {
+        int32_t limb = bit / LIMB_BITS;
+        uint64_t pair = a.limbs[limb];
+        if (limb + 1 < WIDE_WORD_LIMBS)
+        {
+            pair |= static_cast<uint64_t>(a.limbs[limb + 1]) << LIMB_BITS;
+        }
+        return static_cast<uint32_t>(pair >> (bit % LIMB_BITS)) & ((uint32_t{ 1 } << count) - 1);
+    }
+
+    constexpr wchar_t DIGITS[] = L"0123456789ABCDEF";
+
+    // The binary digits of every nibble, binary strings go out four digits at a time.
+    constexpr wchar_t NIBBLES[16][5] = { L"0000", L"0001", L"0010", L"0011", L"0100", L"0101", L"0110", L"0111",
+                                         L"1000", L"1001", L"1010", L"1011", L"1100", L"1101", L"1110", L"1111" };
+
+    WideWord LogicalShiftLeft(WideWord const& a, int32_t bits, int32_t bitWidth)
+    {
+        int32_t n = LimbCount(bitWidth);
+        int32_t limbShift = bits / LIMB_BITS;
+        int32_t bitShift = bits % LIMB_BITS;
+        WideWord result;
+        for (int32_t i = limbShift; i < n; i++)
+        {
+            int32_t src = i - limbShift;
+            result.limbs[i] = a.limbs[src] << bitShift;
+            if (bitShift != 0 && src > 0)
+            {
+                result.limbs[i] |= a.limbs[src - 1] >> (LIMB_BITS - bitShift);
+            }
+        }
+        Truncate(result, bitWidth);
+        return result;
+    }
+
+    WideWord LogicalShiftRight(WideWord const& a, int32_t bits, int32_t bitWidth)
+    {
+        int32_t n = LimbCount(bitWidth);
+        int32_t limbShift = bits / LIMB_BITS;
+        int32_t bitShift = bits % LIMB_BITS;
+        WideWord result;
+        for (int32_t i = 0; i + limbShift < n; i++)
+        {
+            int32_t src = i + limbShift;
+            result.limbs[i] = a.limbs[src] >> bitShift;
+            if (bitShift != 0 && src + 1 < n)
+            {
+                result.limbs[i] |= a.limbs[src + 1] << (LIMB_BITS - bitShift);
+            }
+        }
+        return result;
+    }
+
+    // The shift count held in count, throws if it is the word size or more.
+    int32_t ShiftCount(WideWord const& count, int32_t bitWidth)
+    {
+        if (Length(count, WIDE_WORD_LIMBS) > 1 || count.limbs[0] >= static_cast<uint32_t>(bitWidth))
+        {
+            throw(CALC_E_NORESULT);
+        }
+        return static_cast<int32_t>(count.limbs[0]);
+    }
+
+    // q = a / b and r = a % b of two unsigned words, b nonzero.  This is
+    // Knuth's algorithm D on 32 bit limbs.
+    void DivideMagnitudes(WideWord const& a, WideWord const& b, int32_t bitWidth, WideWord& q, WideWord& r)
+    {
+        int32_t n = LimbCount(bitWidth);
+        int32_t na = Length(a, n);
+        int32_t nb = Length(b, n);
+        q = WideWord{};
+        r = WideWord{};
+        if (na < nb)
+        {
+            r = a;
+            return;
+        }
+
+        if (nb == 1)
+        {
+            uint64_t rem = 0;
+            for (int32_t i = na - 1; i >= 0; i--)
+            {
+                rem = (rem << LIMB_BITS) | a.limbs[i];
+                q.limbs[i] = static_cast<uint32_t>(rem / b.limbs[0]);
+                rem %= b.limbs[0];
+            }
+            r.limbs[0] = static_cast<uint32_t>(rem);
+            return;
+        }
+
+        // Shift both so the top limb of the divisor has its high bit set,
+        // then every quotient limb estimate is at most two too big.
+        int32_t shift = 0;
+        while (((b.limbs[nb - 1] << shift) & 0x80000000u) == 0)
+        {
+            shift++;
+        }
+        array<uint32_t, WIDE_WORD_LIMBS + 1> u{};
+        array<uint32_t, WIDE_WORD_LIMBS> v{};
+        for (int32_t i = 0; i < nb; i++)
+        {
+            v[i] = (b.limbs[i] << shift) | (shift != 0 && i > 0 ? b.limbs[i - 1] >> (LIMB_BITS - shift) : 0);
+        }
+        for (int32_t i = 0; i < na; i++)
+        {
+            u[i] = (a.limbs[i] << shift) | (shift != 0 && i > 0 ? a.limbs[i - 1] >> (LIMB_BITS - shift) : 0);
+        }
+        u[na] = shift != 0 ? a.limbs[na - 1] >> (LIMB_BITS - shift) : 0;
+
+        for (int32_t j = na - nb; j >= 0; j--)
+        {
+            uint64_t top = (uint64_t{ u[j + nb] } << LIMB_BITS) | u[j + nb - 1];
+            uint64_t qhat = top / v[nb - 1];
+            uint64_t rhat = top % v[nb - 1];
+            while (qhat > UINT32_MAX || qhat * v[nb - 2] > ((rhat << LIMB_BITS) | u[j + nb - 2]))
+            {
+                qhat--;
+                rhat += v[nb - 1];
+                if (rhat > UINT32_MAX)
+                {
+                    break;
+                }
+            }
+
+            // u[j..j+nb] -= qhat * v
+            int64_t borrow = 0;
+            int64_t t;
+            for (int32_t i = 0; i < nb; i++)
+            {
+                uint64_t product = qhat * v[i];
+                t = static_cast<int64_t>(u[i + j]) - borrow - static_cast<int64_t>(product & UINT32_MAX);
+                u[i + j] = static_cast<uint32_t>(t);
+                borrow = static_cast<int64_t>(product >> LIMB_BITS) - (t >> LIMB_BITS);
+            }
+            t = static_cast<int64_t>(u[j + nb]) - borrow;
+            u[j + nb] = static_cast<uint32_t>(t);
+
+            // The estimate was still one too big, add v back.
+            if (t < 0)
+            {
+                qhat--;
+                uint64_t carry = 0;
+                for (int32_t i = 0; i < nb; i++)
+                {
+                    carry += uint64_t{ u[i + j] } + v[i];
+                    u[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= LIMB_BITS;
+                }
+                u[j + nb] += static_cast<uint32_t>(carry);
+            }
+            q.limbs[j] = static_cast<uint32_t>(qhat);
+        }
+
+        for (int32_t i = 0; i < nb; i++)
+        {
+            r.limbs[i] = (u[i] >> shift) | (shift != 0 ? u[i + 1] << (LIMB_BITS - shift) : 0);
+        }
+    }
+}
+
+uint64_t IntegerMath::WordMask(int32_t bitWidth)
+{
+    return bitWidth >= 64 ? UINT64_MAX : (uint64_t{ 1 } << bitWidth) - 1;
+}
+
+/// <summary>
+/// Gets the word of an integer the way TruncateNumForIntMath would cut it,
+/// negative values in two's complement.
+/// </summary>
+/// <returns>false if rat isn't an integer of at most 64 bits.</returns>
+bool IntegerMath::TryToWord(Rational const& rat, int32_t bitWidth, uint64_t& word)
+{
+    if (!rat.TryToUInt64(word))
+    {
+        return false;
+    }
+    word &= WordMask(bitWidth);
+    return true;
+}
+
+uint64_t IntegerMath::Add(uint64_t a, uint64_t b, int32_t bitWidth)
+{
+    return (a + b) & WordMask(bitWidth);
+}
+
+uint64_t IntegerMath::Subtract(uint64_t a, uint64_t b, int32_t bitWidth)
+{
+    return (a - b) & WordMask(bitWidth);
+}
+
+uint64_t IntegerMath::Multiply(uint64_t a, uint64_t b, int32_t bitWidth)
+{
+    return (a * b) & WordMask(bitWidth);
+}
+
+/// <summary>
+/// Signed division of a by b rounding towards zero.
+/// </summary>
+uint64_t IntegerMath::Divide(uint64_t a, uint64_t b, int32_t bitWidth)
+{
+    bool negativeA = IsNegative(a, bitWidth);
+    bool negativeB = IsNegative(b, bitWidth);
+    uint64_t magnitudeA = negativeA ? Negate(a, bitWidth) : a;
+    uint64_t magnitudeB = negativeB ? Negate(b, bitWidth) : b;
+
+    // Matches divrat, 0 / 0 is indefinite and anything else over 0 is a
+    // divide by zero.
+    if (magnitudeB == 0)
+    {
+        throw(magnitudeA == 0 ? CALC_E_INDEFINITE : CALC_E_DIVIDEBYZERO);
+    }
+
+    uint64_t quotient = magnitudeA / magnitudeB;
+    return negativeA != negativeB ? Negate(quotient, bitWidth) : quotient & WordMask(bitWidth);
+}
+
+/// <summary>
+/// Signed remainder of a by b, the sign of a result will match the sign of a like the C/C++ operator '%'.
+/// </summary>
+uint64_t IntegerMath::Remainder(uint64_t a, uint64_t b, int32_t bitWidth)
+{
+    bool negativeA = IsNegative(a, bitWidth);
+    uint64_t magnitudeA = negativeA ? Negate(a, bitWidth) : a;
+    uint64_t magnitudeB = IsNegative(b, bitWidth) ? Negate(b, bitWidth) : b;
+
+    if (magnitudeB == 0)
+    {
+        throw(CALC_E_INDEFINITE);
+    }
+
+    uint64_t remainder = magnitudeA % magnitudeB;
+    return negativeA ? Negate(remainder, bitWidth) : remainder;
+}
+
+uint64_t IntegerMath::Negate(uint64_t a, int32_t bitWidth)
+{
+    return (0 - a) & WordMask(bitWidth);
+}
+
+uint64_t IntegerMath::Complement(uint64_t a, int32_t bitWidth)
+{
+    return ~a & WordMask(bitWidth);
+}
+
+/// <summary>
+/// Shifts left by count bits, a count of the word size or more has no result.
+/// </summary>
+uint64_t IntegerMath::ShiftLeft(uint64_t a, uint64_t count, int32_t bitWidth)
+{
+    if (count >= static_cast<uint64_t>(bitWidth))
+    {
+        throw(CALC_E_NORESULT);
+    }
+    return (a << count) & WordMask(bitWidth);
+}
+
+/// <summary>
+/// Arithmetic shift right by count bits, the sign bit is copied into the
+/// bits vacated at the top.  A count of the word size or more has no result.
+/// </summary>
+uint64_t IntegerMath::ShiftRight(uint64_t a, uint64_t count, int32_t bitWidth)
+{
+    if (count >= static_cast<uint64_t>(bitWidth))
+    {
+        throw(CALC_E_NORESULT);
+    }
+
+    uint64_t mask = WordMask(bitWidth);
+    uint64_t result = a >> count;
+    if (IsNegative(a, bitWidth))
+    {
+        result |= mask ^ (mask >> count);
+    }
+    return result;
+}
+
+uint64_t IntegerMath::RotateLeft(uint64_t a, int32_t bitWidth)
+{
+    return ((a << 1) | (IsNegative(a, bitWidth) ? 1 : 0)) & WordMask(bitWidth);
+}
+
+uint64_t IntegerMath::RotateRight(uint64_t a, int32_t bitWidth)
+{
+    return ((a & WordMask(bitWidth)) >> 1) | ((a & 1) << (bitWidth - 1));
+}
+
+bool IntegerMath::IsNegative(uint64_t a, int32_t bitWidth)
+{
+    return ((a >> (bitWidth - 1)) & 1) != 0;
+}
+
+/// <summary>
+/// Gets the word of an integer the way TruncateNumForIntMath would cut it,
+/// negative values in two's complement.
+/// </summary>
+/// <returns>false if rat isn't an integer.</returns>
+bool IntegerMath::TryToWideWord(Rational const& rat, int32_t bitWidth, WideWord& word)
+{
+    word = WideWord{};
+
+    uint64_t value;
+    if (rat.TryToUInt64(value))
+    {
+        word.limbs[0] = static_cast<uint32_t>(value);
+        word.limbs[1] = static_cast<uint32_t>(value >> LIMB_BITS);
+        if (rat < 0)
+        {
+            // A negative magnitude below 2^64 has every bit above them set.
+            for (int32_t i = 2; i < WIDE_WORD_LIMBS; i++)
+            {
+                word.limbs[i] = UINT32_MAX;
+            }
+        }
+        Truncate(word, bitWidth);
+        return true;
+    }
+
+    Number const& p = rat.P();
+    Number const& q = rat.Q();
+    if (q.Exp() != 0 || q.Mantissa().size() != 1 || q.Mantissa()[0] != 1)
+    {
+        return false;
+    }
+
+    // Copy the bits of every BASEX digit below bitWidth, digits past the
+    // point have to be zero.
+    constexpr int32_t digitBits = BASEXPWR;
+    auto const& mantissa = p.Mantissa();
+    for (int32_t i = 0; i < static_cast<int32_t>(mantissa.size()); i++)
+    {
+        int32_t position = i + p.Exp();
+        uint64_t digit = mantissa[i];
+        if (position < 0)
+        {
+            if (digit != 0)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        int32_t bit = position * digitBits;
+        for (int32_t done = 0; done < digitBits && bit + done < bitWidth;)
+        {
+            int32_t offset = (bit + done) % LIMB_BITS;
+            int32_t take = min(LIMB_BITS - offset, digitBits - done);
+            uint64_t chunk = (digit >> done) & ((uint64_t{ 1 } << take) - 1);
+            word.limbs[(bit + done) / LIMB_BITS] |= static_cast<uint32_t>(chunk << offset);
+            done += take;
+        }
+    }
+
+    if (p.Sign() * q.Sign() < 0)
+    {
+        word = Negate(word, bitWidth);
+    }
+    Truncate(word, bitWidth);
+    return true;
+}
+
+/// <summary>
+/// The word read as an unsigned integer, like TruncateNumForIntMath returns it.
+/// </summary>
+Rational IntegerMath::FromWideWord(WideWord const& word, int32_t bitWidth)
+{
+    constexpr int32_t digitBits = BASEXPWR;
+    array<MANTTYPE, WIDE_WORD_BITS / digitBits + 1> digits{};
+    int32_t cdigit = 0;
+    for (int32_t bit = 0; bit < bitWidth; bit += digitBits)
+    {
+        uint64_t digit = 0;
+        for (int32_t done = 0; done < digitBits && bit + done < bitWidth;)
+        {
+            int32_t offset = (bit + done) % LIMB_BITS;
+            int32_t take = min(LIMB_BITS - offset, digitBits - done);
+            uint64_t chunk = (word.limbs[(bit + done) / LIMB_BITS] >> offset) & ((uint64_t{ 1 } << take) - 1);
+            digit |= chunk << done;
+            done += take;
+        }
+        digits[cdigit++] = static_cast<MANTTYPE>(digit);
+    }
+    while (cdigit > 1 && digits[cdigit - 1] == 0)
+    {
+        cdigit--;
+    }
+
+    return Rational{ Number{ 1, 0, NumberMantissa(digits.data(), cdigit) } };
+}
+
+// The bitwise operators run over every limb, the fixed trip count lets the
+// compiler vectorise them and the limbs above the word stay zero anyway.
+WideWord IntegerMath::And(WideWord const& a, WideWord const& b, int32_t /*bitWidth*/)
+{
+    WideWord result;
+    for (int32_t i = 0; i < WIDE_WORD_LIMBS; i++)
+    {
+        result.limbs[i] = a.limbs[i] & b.limbs[i];
+    }
+    return result;
+}
+
+WideWord IntegerMath::Or(WideWord const& a, WideWord const& b, int32_t /*bitWidth*/)
+{
+    WideWord result;
+    for (int32_t i = 0; i < WIDE_WORD_LIMBS; i++)
+    {
+        result.limbs[i] = a.limbs[i] | b.limbs[i];
+    }
+    return result;
+}
+
+WideWord IntegerMath::Xor(WideWord const& a, WideWord const& b, int32_t /*bitWidth*/)
+{
+    WideWord result;
+    for (int32_t i = 0; i < WIDE_WORD_LIMBS; i++)
+    {
+        result.limbs[i] = a.limbs[i] ^ b.limbs[i];
+    }
+    return result;
+}
+
+WideWord IntegerMath::Complement(WideWord const& a, int32_t bitWidth)
+{
+    WideWord result;
+    for (int32_t i = 0; i < WIDE_WORD_LIMBS; i++)
+    {
+        result.limbs[i] = ~a.limbs[i];
+    }
+    Truncate(result, bitWidth);
+    return result;
+}
+
+WideWord IntegerMath::Add(WideWord const& a, WideWord const& b, int32_t bitWidth)
+{
+    WideWord result;
+    uint64_t carry = 0;
+    for (int32_t i = 0; i < LimbCount(bitWidth); i++)
+    {
+        carry += uint64_t{ a.limbs[i] } + b.limbs[i];
+        result.limbs[i] = static_cast<uint32_t>(carry);
+        carry >>= LIMB_BITS;
+    }
+    Truncate(result, bitWidth);
+    return result;
+}
+
+WideWord IntegerMath::Subtract(WideWord const& a, WideWord const& b, int32_t bitWidth)
+{
+    WideWord result;
+    uint64_t borrow = 0;
+    for (int32_t i = 0; i < LimbCount(bitWidth); i++)
+    {
+        uint64_t difference = uint64_t{ a.limbs[i] } - b.limbs[i] - borrow;
+        result.limbs[i] = static_cast<uint32_t>(difference);
+        borrow = (difference >> LIMB_BITS) & 1;
+    }
+    Truncate(result, bitWidth);
+    return result;
+}
+
+WideWord IntegerMath::Negate(WideWord const& a, int32_t bitWidth)
+{
+    return Subtract(WideWord{}, a, bitWidth);
+}
+
+/// <summary>
+/// The low bitWidth bits of a * b, the products landing above the word
+/// are never formed.
+/// </summary>
+WideWord IntegerMath::Multiply(WideWord const& a, WideWord const& b, int32_t bitWidth)
+{
+    int32_t n = LimbCount(bitWidth);
+    int32_t na = Length(a, n);
+    WideWord result;
+    for (int32_t i = 0; i < na; i++)
+    {
+        uint64_t carry = 0;
+        for (int32_t j = 0; i + j < n; j++)
+        {
+            carry += uint64_t{ a.limbs[i] } * b.limbs[j] + result.limbs[i + j];
+            result.limbs[i + j] = static_cast<uint32_t>(carry);
+            carry >>= LIMB_BITS;
+        }
+    }
+    Truncate(result, bitWidth);
+    return result;
+}
+
+/// <summary>
+/// Signed division of a by b rounding towards zero.
+/// </summary>
+WideWord IntegerMath::Divide(WideWord const& a, WideWord const& b, int32_t bitWidth)
+{
+    bool negativeA = IsNegative(a, bitWidth);
+    bool negativeB = IsNegative(b, bitWidth);
+    WideWord magnitudeA = negativeA ? Negate(a, bitWidth) : a;
+    WideWord magnitudeB = negativeB ? Negate(b, bitWidth) : b;
+
+    if (Length(magnitudeB, WIDE_WORD_LIMBS) == 0)
+    {
+        throw(Length(magnitudeA, WIDE_WORD_LIMBS) == 0 ? CALC_E_INDEFINITE : CALC_E_DIVIDEBYZERO);
+    }
+
+    WideWord quotient, remainder;
+    DivideMagnitudes(magnitudeA, magnitudeB, bitWidth, quotient, remainder);
+    return negativeA != negativeB ? Negate(quotient, bitWidth) : quotient;
+}
+
+/// <summary>
+/// Signed remainder of a by b, the sign of a result will match the sign of a like the C/C++ operator '%'.
+/// </summary>
+WideWord IntegerMath::Remainder(WideWord const& a, WideWord const& b, int32_t bitWidth)
+{
+    bool negativeA = IsNegative(a, bitWidth);
+    WideWord magnitudeA = negativeA ? Negate(a, bitWidth) : a;
+    WideWord magnitudeB = IsNegative(b, bitWidth) ? Negate(b, bitWidth) : b;
+
+    if (Length(magnitudeB, WIDE_WORD_LIMBS) == 0)
+    {
+        throw(CALC_E_INDEFINITE);
+    }
+
+    WideWord quotient, remainder;
+    DivideMagnitudes(magnitudeA, magnitudeB, bitWidth, quotient, remainder);
+    return negativeA ? Negate(remainder, bitWidth) : remainder;
+}
+
+WideWord IntegerMath::ShiftLeft(WideWord const& a, WideWord const& count, int32_t bitWidth)
+{
+    return LogicalShiftLeft(a, ShiftCount(count, bitWidth), bitWidth);
+}
+
+/// <summary>
+/// Arithmetic shift right, a negative word is complemented around a logical
+/// shift so the vacated top bits fill with ones.
+/// </summary>
+WideWord IntegerMath::ShiftRight(WideWord const& a, WideWord const& count, int32_t bitWidth)
+{
+    int32_t bits = ShiftCount(count, bitWidth);
+    if (IsNegative(a, bitWidth))
+    {
+        return Complement(LogicalShiftRight(Complement(a, bitWidth), bits, bitWidth), bitWidth);
+    }
+    return LogicalShiftRight(a, bits, bitWidth);
+}
+
+WideWord IntegerMath::RotateLeft(WideWord const& a, int32_t bitWidth)
+{
+    WideWord result = LogicalShiftLeft(a, 1, bitWidth);
+    result.limbs[0] |= IsNegative(a, bitWidth) ? 1 : 0;
+    return result;
+}
+
+WideWord IntegerMath::RotateRight(WideWord const& a, int32_t bitWidth)
+{
+    WideWord result = LogicalShiftRight(a, 1, bitWidth);
+    if ((a.limbs[0] & 1) != 0)
+    {
+        result.limbs[(bitWidth - 1) / LIMB_BITS] |= uint32_t{ 1 } << ((bitWidth - 1) % LIMB_BITS);
+    }
+    return result;
+}
+
+bool IntegerMath::IsNegative(WideWord const& a, int32_t bitWidth)
+{
+    return ((a.limbs[(bitWidth - 1) / LIMB_BITS] >> ((bitWidth - 1) % LIMB_BITS)) & 1) != 0;
+}
+
+bool IntegerMath::IsMsbSet(Rational const& rat, int32_t bitWidth)
+{
+    if (bitWidth <= 64)
+    {
+        uint64_t w64Bits = rat.ToUInt64_t();
+        return ((w64Bits >> (bitWidth - 1)) & 1) != 0;
+    }
+
+    WideWord word;
+    return (TryToWideWord(rat, bitWidth, word) || TryToWideWord(RationalMath::Integer(rat), bitWidth, word)) && IsNegative(word, bitWidth);
+}
+
+/// <summary>
+/// Spells out the word without going back through a Rational.  The power of two
+/// radixes take each digit straight out of the bits, decimal peels nine digits
+/// at a time off the magnitude with a short division.
+/// </summary>
+wstring IntegerMath::ToRadixString(WideWord const& word, uint32_t radix, int32_t bitWidth)
+{
+    wstring result;
+    if (radix == 10)
+    {
+        bool negative = IsNegative(word, bitWidth);
+        WideWord magnitude = negative ? Negate(word, bitWidth) : word;
+        int32_t n = Length(magnitude, LimbCount(bitWidth));
+        do
+        {
+            uint64_t remainder = 0;
+            for (int32_t i = n - 1; i >= 0; i--)
+            {
+                uint64_t current = (remainder << LIMB_BITS) | magnitude.limbs[i];
+                magnitude.limbs[i] = static_cast<uint32_t>(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            n = Length(magnitude, n);
+
+            // Every group but the leading one is nine digits wide.
+            for (int32_t j = 0; j < 9 && (n > 0 || remainder != 0); j++)
+            {
+                result.push_back(DIGITS[remainder % 10]);
+                remainder /= 10;
+            }
+        } while (n > 0);
+
+        if (result.empty())
+        {
+            result.push_back(L'0');
+        }
+        if (negative)
+        {
+            result.push_back(L'-');
+        }
+        reverse(result.begin(), result.end());
+        return result;
+    }
+
+    int32_t digitBits = (radix == 16 ? 4 : (radix == 8 ? 3 : 1));
+    int32_t digits = max((BitLength(word) + digitBits - 1) / digitBits, 1);
+    result.reserve(digits);
+    if (radix == 2)
+    {
+        // The bits above the leading nibble are zero, so it can come from the table as well.
+        int32_t lead = digits % 4;
+        if (lead != 0)
+        {
+            result.append(NIBBLES[Bits(word, digits - lead, 4)] + 4 - lead, lead);
+        }
+        for (int32_t bit = digits - lead - 4; bit >= 0; bit -= 4)
+        {
+            result.append(NIBBLES[Bits(word, bit, 4)], 4);
+        }
+    }
+    else
+    {
+        for (int32_t digit = digits - 1; digit >= 0; digit--)
+        {
+            result.push_back(DIGITS[Bits(word, digit * digitBits, digitBits)]);
+        }
+    }
+    return result;
+}
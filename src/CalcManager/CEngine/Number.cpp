@@ -7,25 +7,172 @@ using namespace std;
 
 namespace CalcEngine
 {
+    NumberMantissa::NumberMantissa() noexcept
+        : m_size{ 0 }
+    {
+    }
+
+    NumberMantissa::NumberMantissa(initializer_list<MANTTYPE> digits)
+        : m_size{ 0 }
+    {
+        Assign(digits.begin(), digits.size());
+    }
+
+    NumberMantissa::NumberMantissa(vector<MANTTYPE> const& digits)
+        : m_size{ 0 }
+    {
+        Assign(digits.data(), digits.size());
+    }
+
+    NumberMantissa::NumberMantissa(MANTTYPE const* digits, size_t size)
+        : m_size{ 0 }
+    {
+        Assign(digits, size);
+    }
+
+    NumberMantissa::NumberMantissa(NumberMantissa const& other)
+        : m_size{ 0 }
+    {
+        Assign(other.data(), other.size());
+    }
+
+    NumberMantissa::NumberMantissa(NumberMantissa&& other) noexcept
+        : m_size{ other.m_size }
+    {
+        if (other.IsInline())
+        {
+            copy(other.m_inline, other.m_inline + m_size, m_inline);
+        }
+        else
+        {
+            m_heap = other.m_heap;
+            other.m_size = 0;
+        }
+    }
+
+    NumberMantissa::~NumberMantissa()
+    {
+        Release();
+    }
+
+    NumberMantissa& NumberMantissa::operator=(NumberMantissa const& other)
+    {
+        if (this != &other)
+        {
+            Assign(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    NumberMantissa& NumberMantissa::operator=(NumberMantissa&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            m_size = other.m_size;
+            if (other.IsInline())
+            {
+                copy(other.m_inline, other.m_inline + m_size, m_inline);
+            }
+            else
+            {
+                m_heap = other.m_heap;
+                other.m_size = 0;
+            }
+        }
+        return *this;
+    }
+
+    void NumberMantissa::Assign(MANTTYPE const* digits, size_t size)
+    {
+        // Keep a heap array that is already the right size.
+        if (size > MANTISSA_INLINE_DIGITS && size == m_size)
+        {
+            copy(digits, digits + size, m_heap);
+            return;
+        }
+
+        MANTTYPE* heap = size > MANTISSA_INLINE_DIGITS ? new MANTTYPE[size] : nullptr;
+        Release();
+        m_size = static_cast<uint32_t>(size);
+        if (heap != nullptr)
+        {
+            m_heap = heap;
+        }
+        copy(digits, digits + size, heap != nullptr ? heap : m_inline);
+    }
+
+    void NumberMantissa::Release() noexcept
+    {
+        if (!IsInline())
+        {
+            delete[] m_heap;
+        }
+        m_size = 0;
+    }
+
+    bool NumberMantissa::IsInline() const
+    {
+        return m_size <= MANTISSA_INLINE_DIGITS;
+    }
+
+    size_t NumberMantissa::size() const
+    {
+        return m_size;
+    }
+
+    bool NumberMantissa::empty() const
+    {
+        return m_size == 0;
+    }
+
+    MANTTYPE const* NumberMantissa::data() const
+    {
+        return IsInline() ? m_inline : m_heap;
+    }
+
+    MANTTYPE const* NumberMantissa::begin() const
+    {
+        return data();
+    }
+
+    MANTTYPE const* NumberMantissa::end() const
+    {
+        return data() + m_size;
+    }
+
+    MANTTYPE const& NumberMantissa::front() const
+    {
+        return data()[0];
+    }
+
+    MANTTYPE const& NumberMantissa::back() const
+    {
+        return data()[m_size - 1];
+    }
+
+    MANTTYPE const& NumberMantissa::operator[](size_t i) const
+    {
+        return data()[i];
+    }
+
     Number::Number() noexcept
         : Number(1, 0, { 0 })
     {
     }
 
-    Number::Number(int32_t sign, int32_t exp, vector<uint32_t> const& mantissa) noexcept
+    Number::Number(int32_t sign, int32_t exp, NumberMantissa mantissa) noexcept
         : m_sign{ sign }
         , m_exp{ exp }
-        , m_mantissa{ mantissa }
+        , m_mantissa{ move(mantissa) }
     {
     }
 
     Number::Number(PNUMBER p) noexcept
         : m_sign{ p->sign }
         , m_exp{ p->exp }
-        , m_mantissa{}
+        , m_mantissa{ p->mant, static_cast<size_t>(p->cdigit) }
     {
-        m_mantissa.reserve(p->cdigit);
-        copy(p->mant, p->mant + p->cdigit, back_inserter(m_mantissa));
     }
 
     PNUMBER Number::ToPNUMBER() const
@@ -54,7 +201,7 @@ namespace CalcEngine
         return m_exp;
     }
 
-    vector<uint32_t> const& Number::Mantissa() const
+    NumberMantissa const& Number::Mantissa() const
     {
         return m_mantissa;
     }
@@ -1,331 +1,571 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 
-#include <intsafe.h>
 #include "Header Files/Rational.h"
 
 using namespace std;
 
-namespace CalcEngine
+namespace
 {
-    Rational::Rational() noexcept
-        : m_p{}
-        , m_q{ 1, 0, { 1 } }
+    // Small values stay within +-INT64_MAX so negating them can't overflow.
+    constexpr int64_t SMALL_MAX = INT64_MAX;
+
+    bool CheckedAdd(int64_t a, int64_t b, int64_t& result)
     {
+        if ((b > 0 && a > SMALL_MAX - b) || (b < 0 && a < -SMALL_MAX - b))
+        {
+            return false;
+        }
+        result = a + b;
+        return true;
     }
 
-    Rational::Rational(Number const& n) noexcept
+    bool CheckedMul(int64_t a, int64_t b, int64_t& result)
     {
-        int32_t qExp = 0;
-        if (n.Exp() < 0)
+        uint64_t ua = static_cast<uint64_t>(a < 0 ? -a : a);
+        uint64_t ub = static_cast<uint64_t>(b < 0 ? -b : b);
+        if (ua != 0 && ub > static_cast<uint64_t>(SMALL_MAX) / ua)
         {
-            qExp -= n.Exp();
+            return false;
         }
-
-        m_p = Number(n.Sign(), 0, n.Mantissa());
-        m_q = Number(1, qExp, { 1 });
+        result = a * b;
+        return true;
     }
 
-    Rational::Rational(Number const& p, Number const& q) noexcept
-        : m_p{ p }
-        , m_q{ q }
+    int64_t Gcd(int64_t a, int64_t b)
     {
+        a = a < 0 ? -a : a;
+        b = b < 0 ? -b : b;
+        while (b != 0)
+        {
+            int64_t t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
     }
 
-    Rational::Rational(int32_t i)
+    // p1/q1 + p2/q2 in lowest terms, false if it doesn't fit.
+    bool AddSmall(int64_t p1, int64_t q1, int64_t p2, int64_t q2, int64_t& p, int64_t& q)
     {
-        PRAT pr = i32torat(static_cast<int32_t>(i));
-
-        m_p = Number{ pr->pp };
-        m_q = Number{ pr->pq };
+        int64_t g = Gcd(q1, q2);
+        int64_t a, b;
+        return CheckedMul(p1, q2 / g, a) && CheckedMul(p2, q1 / g, b) && CheckedAdd(a, b, p) && CheckedMul(q1, q2 / g, q);
+    }
 
-        destroyrat(pr);
+    // p1/q1 * p2/q2, cross reduced first so the products stay small.
+    bool MulSmall(int64_t p1, int64_t q1, int64_t p2, int64_t q2, int64_t& p, int64_t& q)
+    {
+        int64_t g1 = Gcd(p1, q2);
+        int64_t g2 = Gcd(p2, q1);
+        g1 = g1 == 0 ? 1 : g1;
+        g2 = g2 == 0 ? 1 : g2;
+        return CheckedMul(p1 / g1, p2 / g2, p) && CheckedMul(q1 / g2, q2 / g1, q);
     }
 
-    Rational::Rational(uint32_t ui)
+    // The value mant * BASEX^exp as a uint64_t, false if it isn't an integer
+    // that fits.
+    bool TryGetMagnitude(int32_t exp, MANTTYPE const* mant, size_t cdigit, uint64_t& result)
     {
-        PRAT pr = Ui32torat(static_cast<uint32_t>(ui));
+        if (exp < 0 || cdigit + exp > 64 / BASEXPWR + 1)
+        {
+            return false;
+        }
 
-        m_p = Number{ pr->pp };
-        m_q = Number{ pr->pq };
+        TWO_MANTTYPE v = 0;
+        for (size_t i = cdigit + exp; i-- > 0;)
+        {
+            if (v > (static_cast<TWO_MANTTYPE>(UINT64_MAX) >> BASEXPWR))
+            {
+                return false;
+            }
+            v = (v << BASEXPWR) | (i >= static_cast<size_t>(exp) ? mant[i - exp] : 0);
+        }
+        if (v > static_cast<TWO_MANTTYPE>(UINT64_MAX))
+        {
+            return false;
+        }
 
-        destroyrat(pr);
+        result = static_cast<uint64_t>(v);
+        return true;
     }
 
-    Rational::Rational(uint64_t ui)
+    // The value sign * mant * BASEX^exp as an int64_t, false if it isn't an
+    // integer that fits.
+    bool TryGetInt64(int32_t sign, int32_t exp, MANTTYPE const* mant, size_t cdigit, int64_t& result)
     {
-        uint32_t hi = HIDWORD(ui);
-        uint32_t lo = LODWORD(ui);
-
-        Rational temp = (Rational{ hi } << 32) | lo;
+        uint64_t v;
+        if (!TryGetMagnitude(exp, mant, cdigit, v) || v > static_cast<uint64_t>(SMALL_MAX))
+        {
+            return false;
+        }
 
-        m_p = Number{ temp.P() };
-        m_q = Number{ temp.Q() };
+        result = sign < 0 ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+        return true;
     }
 
-    Rational::Rational(PRAT prat) noexcept
-        : m_p{ Number{ prat->pp } }
-        , m_q{ Number{ prat->pq } }
+    bool TryGetInt64(PNUMBER pnum, int64_t& result)
     {
+        return TryGetInt64(pnum->sign, pnum->exp, pnum->mant, pnum->cdigit, result);
     }
 
-    PRAT Rational::ToPRAT() const
+    bool TryGetInt64(CalcEngine::Number const& n, int64_t& result)
     {
-        PRAT ret = _createrat();
-
-        ret->pp = this->P().ToPNUMBER();
-        ret->pq = this->Q().ToPNUMBER();
+        return TryGetInt64(n.Sign(), n.Exp(), n.Mantissa().data(), n.Mantissa().size(), result);
+    }
 
-        return ret;
+    CalcEngine::NumberMantissa Int64ToMantissa(int64_t i)
+    {
+        MANTTYPE digits[64 / BASEXPWR + 1];
+        size_t size = 0;
+        TWO_MANTTYPE v = static_cast<uint64_t>(i < 0 ? -i : i);
+        do
+        {
+            digits[size++] = static_cast<MANTTYPE>(v & BASEXMAX);
+            v >>= BASEXPWR;
+        } while (v != 0);
+        return CalcEngine::NumberMantissa(digits, size);
     }
 
-    Number const& Rational::P() const
+    PNUMBER UInt64ToPNUMBER(uint64_t magnitude, int32_t sign)
     {
-        return m_p;
+        PNUMBER ret = _createnum(64 / BASEXPWR + 1);
+        ret->sign = sign;
+        ret->exp = 0;
+        ret->cdigit = 0;
+        TWO_MANTTYPE v = magnitude;
+        do
+        {
+            ret->mant[ret->cdigit++] = static_cast<MANTTYPE>(v & BASEXMAX);
+            v >>= BASEXPWR;
+        } while (v != 0);
+        return ret;
     }
 
-    Number const& Rational::Q() const
+    PNUMBER Int64ToPNUMBER(int64_t i)
     {
-        return m_q;
+        return UInt64ToPNUMBER(static_cast<uint64_t>(i < 0 ? -i : i), i < 0 ? -1 : 1);
     }
+}
 
-    Rational Rational::operator-() const
+namespace CalcEngine
+{
+    Rational::Rational() noexcept
     {
-        return Rational{ Number{ -1 * m_p.Sign(), m_p.Exp(), m_p.Mantissa() }, m_q };
     }
 
-    Rational& Rational::operator+=(Rational const& rhs)
+    Rational::Rational(Number const& n) noexcept
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        int32_t qExp = 0;
+        if (n.Exp() < 0)
+        {
+            qExp -= n.Exp();
+        }
 
-        try
+        int64_t p, q;
+        MANTTYPE one = 1;
+        if (TryGetInt64(n.Sign(), 0, n.Mantissa().data(), n.Mantissa().size(), p) && TryGetInt64(1, qExp, &one, 1, q))
         {
-            addrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            SetSmall(p, q);
+            return;
         }
-        catch (uint32_t error)
+
+        m_isSmall = false;
+        m_rat = _createrat();
+        m_rat->pp = n.ToPNUMBER();
+        m_rat->pp->exp = 0;
+        m_rat->pq = Number(1, qExp, { 1 }).ToPNUMBER();
+    }
+
+    Rational::Rational(Number const& p, Number const& q) noexcept
+    {
+        int64_t smallP, smallQ;
+        if (TryGetInt64(p, smallP) && TryGetInt64(q, smallQ) && smallQ != 0)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            SetSmall(smallP, smallQ);
+            return;
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        m_isSmall = false;
+        m_rat = _createrat();
+        m_rat->pp = p.ToPNUMBER();
+        m_rat->pq = q.ToPNUMBER();
+    }
 
-        return *this;
+    Rational::Rational(int32_t i)
+    {
+        SetSmall(i, 1);
     }
 
-    Rational& Rational::operator-=(Rational const& rhs)
+    Rational::Rational(uint32_t ui)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        SetSmall(ui, 1);
+    }
 
-        try
+    Rational::Rational(uint64_t ui)
+    {
+        if (ui <= static_cast<uint64_t>(SMALL_MAX))
         {
-            subrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            SetSmall(static_cast<int64_t>(ui), 1);
+            return;
         }
-        catch (uint32_t error)
+
+        m_isSmall = false;
+        m_rat = _createrat();
+        m_rat->pp = UInt64ToPNUMBER(ui, 1);
+        m_rat->pq = UInt64ToPNUMBER(1, 1);
+    }
+
+    Rational::Rational(PRAT prat) noexcept
+    {
+        int64_t p, q;
+        if (TryGetInt64(prat->pp, p) && TryGetInt64(prat->pq, q) && q != 0)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            SetSmall(p, q);
+            return;
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        m_isSmall = false;
+        DUPRAT(m_rat, prat);
+    }
 
-        return *this;
+    Rational::Rational(Rational const& other)
+        : m_isSmall{ other.m_isSmall }
+        , m_smallP{ other.m_smallP }
+        , m_smallQ{ other.m_smallQ }
+    {
+        if (other.m_rat != nullptr)
+        {
+            DUPRAT(m_rat, other.m_rat);
+        }
     }
 
-    Rational& Rational::operator*=(Rational const& rhs)
+    Rational::Rational(Rational&& other) noexcept
+        : m_isSmall{ other.m_isSmall }
+        , m_smallP{ other.m_smallP }
+        , m_smallQ{ other.m_smallQ }
+        , m_rat{ other.m_rat }
+        , m_hasPQ{ other.m_hasPQ }
+        , m_p{ move(other.m_p) }
+        , m_q{ move(other.m_q) }
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        other.m_rat = nullptr;
+        other.SetSmall(0, 1);
+    }
 
-        try
+    Rational::~Rational()
+    {
+        if (m_rat != nullptr)
         {
-            mulrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            destroyrat(m_rat);
         }
-        catch (uint32_t error)
+    }
+
+    Rational& Rational::operator=(Rational const& other)
+    {
+        if (this != &other)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            if (other.m_isSmall)
+            {
+                SetSmall(other.m_smallP, other.m_smallQ);
+            }
+            else
+            {
+                // Reuses the blocks of m_rat when they are big enough.
+                DUPRAT(m_rat, other.m_rat);
+                m_isSmall = false;
+                m_hasPQ = false;
+            }
         }
-
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
         return *this;
     }
 
-    Rational& Rational::operator/=(Rational const& rhs)
+    Rational& Rational::operator=(Rational&& other) noexcept
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (this != &other)
         {
-            divrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            swap(m_rat, other.m_rat);
+            m_isSmall = other.m_isSmall;
+            m_smallP = other.m_smallP;
+            m_smallQ = other.m_smallQ;
+            m_hasPQ = other.m_hasPQ;
+            if (m_hasPQ)
+            {
+                m_p = move(other.m_p);
+                m_q = move(other.m_q);
+            }
+            other.SetSmall(0, 1);
         }
-        catch (uint32_t error)
+        return *this;
+    }
+
+    void Rational::SetSmall(int64_t p, int64_t q) noexcept
+    {
+        if (m_rat != nullptr)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            destroyrat(m_rat);
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        if (q < 0)
+        {
+            p = -p;
+            q = -q;
+        }
 
-        return *this;
+        int64_t g = Gcd(p, q);
+        m_isSmall = true;
+        m_smallP = p / g;
+        m_smallQ = q / g;
+        m_hasPQ = false;
     }
 
-    /// <summary>
-    /// Calculate the remainder after division, the sign of a result will match the sign of the current object.
-    /// </summary>
-    /// <remarks>
-    /// This function has the same behavior as the standard C/C++ operator '%'
-    /// to calculate the modulus after division instead, use <see cref="RationalMath::Mod"/> instead.
-    /// </remarks>
-    Rational& Rational::operator%=(Rational const& rhs)
+    // Takes ownership of prat.
+    void Rational::SetRat(PRAT prat) noexcept
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        int64_t p, q;
+        if (TryGetInt64(prat->pp, p) && TryGetInt64(prat->pq, q) && q != 0)
+        {
+            destroyrat(prat);
+            SetSmall(p, q);
+            return;
+        }
 
-        try
+        if (m_rat != nullptr)
         {
-            remrat(&lhsRat, rhsRat);
-            destroyrat(rhsRat);
+            destroyrat(m_rat);
         }
-        catch (uint32_t error)
+        m_rat = prat;
+        m_isSmall = false;
+        m_hasPQ = false;
+    }
+
+    PRAT Rational::ToPRAT() const
+    {
+        PRAT ret = nullptr;
+        if (m_isSmall)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            ret = _createrat();
+            ret->pp = Int64ToPNUMBER(m_smallP);
+            ret->pq = Int64ToPNUMBER(m_smallQ);
+        }
+        else
+        {
+            DUPRAT(ret, m_rat);
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        return ret;
+    }
 
-        return *this;
+    // The value to read from, m_rat itself when there is one.  A small value
+    // is built into a new PRAT that the caller destroys.
+    PRAT Rational::PeekPRAT() const
+    {
+        return m_isSmall ? ToPRAT() : m_rat;
     }
 
-    Rational& Rational::operator<<=(Rational const& rhs)
+    Number const& Rational::P() const
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        if (!m_hasPQ)
+        {
+            if (m_isSmall)
+            {
+                m_p = Number{ m_smallP < 0 ? -1 : 1, 0, Int64ToMantissa(m_smallP) };
+                m_q = Number{ 1, 0, Int64ToMantissa(m_smallQ) };
+            }
+            else
+            {
+                m_p = Number{ m_rat->pp };
+                m_q = Number{ m_rat->pq };
+            }
+            m_hasPQ = true;
+        }
+        return m_p;
+    }
+
+    Number const& Rational::Q() const
+    {
+        P();
+        return m_q;
+    }
+
+    // Runs op on m_rat in place.  Only for the operators that fail before
+    // they change *pa or not at all, a failure part way through would leave
+    // *this holding a partial result.
+    Rational& Rational::ApplyInPlace(Rational const& rhs, void (*op)(PRAT*, PRAT))
+    {
+        bool ownsRhs = rhs.m_isSmall || &rhs == this;
+        PRAT rhsRat = ownsRhs ? rhs.ToPRAT() : rhs.m_rat;
+
+        if (m_isSmall)
+        {
+            m_rat = ToPRAT();
+            m_isSmall = false;
+        }
+        m_hasPQ = false;
 
         try
         {
-            lshrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            op(&m_rat, rhsRat);
         }
         catch (uint32_t error)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
+            if (ownsRhs)
+            {
+                destroyrat(rhsRat);
+            }
             throw(error);
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        if (ownsRhs)
+        {
+            destroyrat(rhsRat);
+        }
+
+        PRAT result = m_rat;
+        m_rat = nullptr;
+        SetRat(result);
 
         return *this;
     }
 
-    Rational& Rational::operator>>=(Rational const& rhs)
+    // Runs op on a copy of *this, which is left as it was if op throws.
+    Rational& Rational::ApplyToCopy(Rational const& rhs, void (*op)(PRAT*, PRAT))
     {
         PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        PRAT rhsRat = rhs.PeekPRAT();
 
         try
         {
-            rshrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            op(&lhsRat, rhsRat);
         }
         catch (uint32_t error)
         {
             destroyrat(lhsRat);
-            destroyrat(rhsRat);
+            if (rhs.m_isSmall)
+            {
+                destroyrat(rhsRat);
+            }
             throw(error);
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        if (rhs.m_isSmall)
+        {
+            destroyrat(rhsRat);
+        }
+
+        SetRat(lhsRat);
 
         return *this;
     }
 
-    Rational& Rational::operator&=(Rational const& rhs)
+    Rational Rational::operator-() const
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
+        if (m_isSmall)
         {
-            andrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            Rational result;
+            result.SetSmall(-m_smallP, m_smallQ);
+            return result;
         }
-        catch (uint32_t error)
+
+        Rational result{ *this };
+        result.m_rat->pp->sign *= -1;
+        return result;
+    }
+
+    Rational& Rational::operator+=(Rational const& rhs)
+    {
+        int64_t p, q;
+        if (m_isSmall && rhs.m_isSmall && AddSmall(m_smallP, m_smallQ, rhs.m_smallP, rhs.m_smallQ, p, q))
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            SetSmall(p, q);
+            return *this;
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return ApplyInPlace(rhs, [](PRAT* pa, PRAT b) { addrat(pa, b, RATIONAL_PRECISION); });
     }
 
-    Rational& Rational::operator|=(Rational const& rhs)
+    Rational& Rational::operator-=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-        try
+        int64_t p, q;
+        if (m_isSmall && rhs.m_isSmall && AddSmall(m_smallP, m_smallQ, -rhs.m_smallP, rhs.m_smallQ, p, q))
         {
-            orrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            SetSmall(p, q);
+            return *this;
         }
-        catch (uint32_t error)
+
+        return ApplyInPlace(rhs, [](PRAT* pa, PRAT b) { subrat(pa, b, RATIONAL_PRECISION); });
+    }
+
+    Rational& Rational::operator*=(Rational const& rhs)
+    {
+        int64_t p, q;
+        if (m_isSmall && rhs.m_isSmall && MulSmall(m_smallP, m_smallQ, rhs.m_smallP, rhs.m_smallQ, p, q))
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            SetSmall(p, q);
+            return *this;
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return ApplyInPlace(rhs, [](PRAT* pa, PRAT b) { mulrat(pa, b, RATIONAL_PRECISION); });
     }
 
-    Rational& Rational::operator^=(Rational const& rhs)
+    Rational& Rational::operator/=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-        try
+        int64_t p, q;
+        if (m_isSmall && rhs.m_isSmall && rhs.m_smallP != 0 && MulSmall(m_smallP, m_smallQ, rhs.m_smallQ, rhs.m_smallP, p, q))
         {
-            xorrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            SetSmall(p, q);
+            return *this;
         }
-        catch (uint32_t error)
+
+        // divrat only finds a zero divisor after it has changed *pa.
+        auto div = [](PRAT* pa, PRAT b) { divrat(pa, b, RATIONAL_PRECISION); };
+        bool zeroDivisor = rhs.m_isSmall ? rhs.m_smallP == 0 : zernum(rhs.m_rat->pp);
+        return zeroDivisor ? ApplyToCopy(rhs, div) : ApplyInPlace(rhs, div);
+    }
+
+    /// <summary>
+    /// Calculate the remainder after division, the sign of a result will match the sign of the current object.
+    /// </summary>
+    /// <remarks>
+    /// This function has the same behavior as the standard C/C++ operator '%'
+    /// to calculate the modulus after division instead, use <see cref="RationalMath::Mod"/> instead.
+    /// </remarks>
+    Rational& Rational::operator%=(Rational const& rhs)
+    {
+        // (p1 * q2) % (p2 * q1) / (q1 * q2), which is what remrat works out.
+        int64_t a, b, q;
+        if (m_isSmall && rhs.m_isSmall && rhs.m_smallP != 0 && CheckedMul(m_smallP, rhs.m_smallQ, a) && CheckedMul(rhs.m_smallP, m_smallQ, b)
+            && CheckedMul(m_smallQ, rhs.m_smallQ, q))
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            SetSmall(a % b, q);
+            return *this;
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        return ApplyInPlace(rhs, [](PRAT* pa, PRAT b) { remrat(pa, b); });
+    }
 
-        return *this;
+    Rational& Rational::operator<<=(Rational const& rhs)
+    {
+        return ApplyToCopy(rhs, [](PRAT* pa, PRAT b) { lshrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
+    }
+
+    Rational& Rational::operator>>=(Rational const& rhs)
+    {
+        return ApplyToCopy(rhs, [](PRAT* pa, PRAT b) { rshrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
+    }
+
+    Rational& Rational::operator&=(Rational const& rhs)
+    {
+        return ApplyToCopy(rhs, [](PRAT* pa, PRAT b) { andrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
+    }
+
+    Rational& Rational::operator|=(Rational const& rhs)
+    {
+        return ApplyToCopy(rhs, [](PRAT* pa, PRAT b) { orrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
+    }
+
+    Rational& Rational::operator^=(Rational const& rhs)
+    {
+        return ApplyToCopy(rhs, [](PRAT* pa, PRAT b) { xorrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
     }
 
     Rational operator+(Rational lhs, Rational const& rhs)
@@ -397,8 +637,14 @@ namespace CalcEngine
 
     bool operator==(Rational const& lhs, Rational const& rhs)
     {
-        PRAT lhsRat = lhs.ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        // Both sides are in lowest terms with a positive denominator.
+        if (lhs.m_isSmall && rhs.m_isSmall)
+        {
+            return lhs.m_smallP == rhs.m_smallP && lhs.m_smallQ == rhs.m_smallQ;
+        }
+
+        PRAT lhsRat = lhs.PeekPRAT();
+        PRAT rhsRat = rhs.PeekPRAT();
 
         bool result = false;
         try
@@ -407,13 +653,25 @@ namespace CalcEngine
         }
         catch (uint32_t error)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
+            if (lhs.m_isSmall)
+            {
+                destroyrat(lhsRat);
+            }
+            if (rhs.m_isSmall)
+            {
+                destroyrat(rhsRat);
+            }
             throw(error);
         }
 
-        destroyrat(lhsRat);
-        destroyrat(rhsRat);
+        if (lhs.m_isSmall)
+        {
+            destroyrat(lhsRat);
+        }
+        if (rhs.m_isSmall)
+        {
+            destroyrat(rhsRat);
+        }
 
         return result;
     }
@@ -425,8 +683,14 @@ namespace CalcEngine
 
     bool operator<(Rational const& lhs, Rational const& rhs)
     {
-        PRAT lhsRat = lhs.ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        int64_t a, b;
+        if (lhs.m_isSmall && rhs.m_isSmall && CheckedMul(lhs.m_smallP, rhs.m_smallQ, a) && CheckedMul(rhs.m_smallP, lhs.m_smallQ, b))
+        {
+            return a < b;
+        }
+
+        PRAT lhsRat = lhs.PeekPRAT();
+        PRAT rhsRat = rhs.PeekPRAT();
 
         bool result = false;
         try
@@ -435,13 +699,25 @@ namespace CalcEngine
         }
         catch (uint32_t error)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
+            if (lhs.m_isSmall)
+            {
+                destroyrat(lhsRat);
+            }
+            if (rhs.m_isSmall)
+            {
+                destroyrat(rhsRat);
+            }
             throw(error);
         }
 
-        destroyrat(lhsRat);
-        destroyrat(rhsRat);
+        if (lhs.m_isSmall)
+        {
+            destroyrat(lhsRat);
+        }
+        if (rhs.m_isSmall)
+        {
+            destroyrat(rhsRat);
+        }
 
         return result;
     }
@@ -463,7 +739,7 @@ namespace CalcEngine
 
     wstring Rational::ToString(uint32_t radix, NUMOBJ_FMT fmt, int32_t precision) const
     {
-        PRAT rat = this->ToPRAT();
+        PRAT rat = this->PeekPRAT();
         wstring result{};
 
         try
@@ -472,18 +748,68 @@ namespace CalcEngine
         }
         catch (uint32_t error)
         {
-            destroyrat(rat);
+            if (m_isSmall)
+            {
+                destroyrat(rat);
+            }
             throw(error);
         }
 
-        destroyrat(rat);
+        if (m_isSmall)
+        {
+            destroyrat(rat);
+        }
 
         return result;
     }
 
+    // Integers in (-2^64, 2^64) come back as their low 64 bits, two's
+    // complement for negative ones.  Anything else returns false.
+    bool Rational::TryToUInt64(uint64_t& value) const
+    {
+        if (m_isSmall)
+        {
+            if (m_smallQ != 1)
+            {
+                return false;
+            }
+            value = static_cast<uint64_t>(m_smallP);
+            return true;
+        }
+
+        uint64_t p, q;
+        if (!TryGetMagnitude(m_rat->pp->exp, m_rat->pp->mant, m_rat->pp->cdigit, p)
+            || !TryGetMagnitude(m_rat->pq->exp, m_rat->pq->mant, m_rat->pq->cdigit, q) || q != 1)
+        {
+            return false;
+        }
+        value = m_rat->pp->sign * m_rat->pq->sign < 0 ? 0 - p : p;
+        return true;
+    }
+
+    int64_t Rational::Log2Bound() const
+    {
+        if (m_isSmall)
+        {
+            // Both fit in 63 bits
+            return 64;
+        }
+
+        // p/q lies strictly between BASEX^(digits - 1) and BASEX^(digits + 1)
+        int64_t digits = (int64_t{ m_rat->pp->cdigit } + m_rat->pp->exp) - (int64_t{ m_rat->pq->cdigit } + m_rat->pq->exp);
+        return (std::abs(digits) + 1) * BASEXPWR;
+    }
+
     uint64_t Rational::ToUInt64_t() const
     {
-        PRAT rat = this->ToPRAT();
+        uint64_t value;
+        bool negative = m_isSmall ? m_smallP < 0 : m_rat->pp->sign * m_rat->pq->sign < 0;
+        if (!negative && TryToUInt64(value))
+        {
+            return value;
+        }
+
+        PRAT rat = this->PeekPRAT();
         uint64_t result;
         try
         {
@@ -491,11 +817,17 @@ namespace CalcEngine
         }
         catch (uint32_t error)
         {
-            destroyrat(rat);
+            if (m_isSmall)
+            {
+                destroyrat(rat);
+            }
             throw(error);
         }
 
-        destroyrat(rat);
+        if (m_isSmall)
+        {
+            destroyrat(rat);
+        }
 
         return result;
     }
@@ -69,7 +69,25 @@ Rational RationalMath::Pow(Rational const& base, Rational const& pow)
 
 Rational RationalMath::Root(Rational const& base, Rational const& root)
 {
-    return Pow(base, Invert(root));
+    PRAT baseRat = base.ToPRAT();
+    PRAT rootRat = root.ToPRAT();
+
+    try
+    {
+        rootrat(&baseRat, rootRat, RATIONAL_BASE, RATIONAL_PRECISION);
+        destroyrat(rootRat);
+    }
+    catch (uint32_t error)
+    {
+        destroyrat(baseRat);
+        destroyrat(rootRat);
+        throw(error);
+    }
+
+    Rational result{ baseRat };
+    destroyrat(baseRat);
+
+    return result;
 }
 
 Rational RationalMath::Fact(Rational const& rat)
@@ -134,7 +152,7 @@ Rational RationalMath::Log(Rational const& rat)
 
 Rational RationalMath::Log10(Rational const& rat)
 {
-    return Log(rat) / Rational{ ln_ten };
+    return Log(rat) / Rational{ g_ratpack->ln_ten };
 }
 
 Rational RationalMath::Invert(Rational const& rat)
@@ -73,6 +73,7 @@ CCalcEngine::CCalcEngine(
     , m_bChangeOp(false)
     , m_bRecord(false)
     , m_bSetCalcState(false)
+    , m_fHeadless(false)
     , m_input(DEFAULT_DEC_SEPARATOR)
     , m_nFE(FMT_FLOAT)
     , m_memoryValue{ make_unique<Rational>() }
@@ -89,6 +90,9 @@ CCalcEngine::CCalcEngine(
     , m_cIntDigitsSav(DEFAULT_MAX_DIGITS)
     , m_decGrouping()
     , m_numberString(DEFAULT_NUMBER_STR)
+    , m_shownVal{}
+    , m_fShownInput(false)
+    , m_displayCache{}
     , m_nTempCom(0)
     , m_openParenCount(0)
     , m_nOp()
@@ -99,7 +103,12 @@ CCalcEngine::CCalcEngine(
     , m_numwidth(QWORD_WIDTH)
     , m_HistoryCollector(pCalcDisplay, pHistoryDisplay, DEFAULT_DEC_SEPARATOR)
     , m_groupSeparator(DEFAULT_GRP_SEPARATOR)
+    , m_ratpackContext{ make_unique<RATPACKCONTEXT>(*g_ratpack) }
 {
+    // Every instance keeps its own copy of the ratpak state so changing the
+    // precision or radix of one does not disturb the others.
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
+
     InitChopNumbers();
 
     m_dwWordBitWidth = DwWordBitWidthFromeNumWidth(m_numwidth);
@@ -116,10 +125,16 @@ void CCalcEngine::InitChopNumbers()
     // these rat numbers are set only once and then never change regardless of
     // base or precision changes
     assert(m_chopNumbers.size() >= 4);
-    m_chopNumbers[0] = Rational{ rat_qword };
-    m_chopNumbers[1] = Rational{ rat_dword };
-    m_chopNumbers[2] = Rational{ rat_word };
-    m_chopNumbers[3] = Rational{ rat_byte };
+    m_chopNumbers[0] = Rational{ g_ratpack->rat_qword };
+    m_chopNumbers[1] = Rational{ g_ratpack->rat_dword };
+    m_chopNumbers[2] = Rational{ g_ratpack->rat_word };
+    m_chopNumbers[3] = Rational{ g_ratpack->rat_byte };
+
+    // ratpak has no constants for the widths past 64 bits
+    for (size_t i = WORD128_WIDTH; i < m_chopNumbers.size(); i++)
+    {
+        m_chopNumbers[i] = (Rational{ 1 } << DwWordBitWidthFromeNumWidth(static_cast<NUM_WIDTH>(i))) - 1;
+    }
 
     // initialize the max dec number you can support for each of the supported bit lengths
     // this is basically max num in that width / 2 in integer
@@ -129,7 +144,9 @@ void CCalcEngine::InitChopNumbers()
         auto maxVal = m_chopNumbers[i] / 2;
         maxVal = RationalMath::Integer(maxVal);
 
-        m_maxDecimalValueStrings[i] = maxVal.ToString(10, FMT_FLOAT, m_precision);
+        // Every decimal digit holds more than a bit, so the bit width is always enough precision
+        int32_t precision = max(m_precision, DwWordBitWidthFromeNumWidth(static_cast<NUM_WIDTH>(i)));
+        m_maxDecimalValueStrings[i] = maxVal.ToString(10, FMT_FLOAT, precision);
     }
 }
 
@@ -147,6 +164,9 @@ void CCalcEngine::PersistedMemObject(Rational const& memObject)
 
 void CCalcEngine::SettingsChanged()
 {
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
+    CompleteDeferredHistory();
+
     wchar_t lastDec = m_decimalSeparator;
     wstring decStr = m_resourceProvider->GetCEngineString(L"sDecimal");
     m_decimalSeparator = decStr.empty() ? DEFAULT_DEC_SEPARATOR : decStr.at(0);
@@ -185,6 +205,9 @@ void CCalcEngine::SettingsChanged()
 
     if (numChanged)
     {
+        // The cached strings have the old separators in them.
+        m_displayCache.fValid = false;
+        m_displayCache.groupInput.clear();
         DisplayNum();
     }
 }
@@ -78,6 +78,8 @@ void CCalcEngine::ClearTemporaryValues()
 
 void CCalcEngine::ProcessCommand(OpCode wParam)
 {
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
+
     if (wParam == IDC_SET_RESULT)
     {
         wParam = IDC_RECALL;
@@ -125,7 +127,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
     if (m_bRecord)
     {
         if (IsOpInRange(wParam, IDC_AND, IDC_MMINUS) || IsOpInRange(wParam, IDC_OPENP, IDC_CLOSEP) || IsOpInRange(wParam, IDM_HEX, IDM_BIN)
-            || IsOpInRange(wParam, IDM_QWORD, IDM_BYTE) || IsOpInRange(wParam, IDM_DEG, IDM_GRAD)
+            || IsOpInRange(wParam, IDM_QWORD, IDM_BYTE) || IsOpInRange(wParam, IDM_WORD128, IDM_WORD1024) || IsOpInRange(wParam, IDM_DEG, IDM_GRAD)
             || IsOpInRange(wParam, IDC_BINEDITSTART, IDC_BINEDITSTART + 63) || (IDC_INV == wParam) || (IDC_SIGN == wParam && 10 != m_radix))
         {
             m_bRecord = false;
@@ -155,7 +157,9 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
             return;
         }
 
-        if (!m_input.TryAddDigit(iValue, m_radix, m_fIntegerMode, m_maxDecimalValueStrings[m_numwidth], m_dwWordBitWidth, m_cIntDigitsSav))
+        // The widest words have more digits than the input can hold, they are entered up to MAX_STRLEN digits.
+        int maxDigits = min(m_cIntDigitsSav, MAX_STRLEN - 1);
+        if (!m_input.TryAddDigit(iValue, m_radix, m_fIntegerMode, m_maxDecimalValueStrings[m_numwidth], m_dwWordBitWidth, maxDigits))
         {
             HandleErrorCommand(wParam);
             HandleMaxDigitsReached();
@@ -201,7 +205,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
         if (!m_HistoryCollector.FOpndAddedToHistory())
         {
             // if the prev command was ) or unop then it is already in history as a opnd form (...)
-            m_HistoryCollector.AddOpndToHistory(m_numberString, m_currentVal);
+            m_HistoryCollector.AddOpndToHistory(m_numberString, ShownValue());
         }
 
         /* m_bChangeOp is true if there was an operation done and the   */
@@ -297,7 +301,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
         {
             if (!m_HistoryCollector.FOpndAddedToHistory())
             {
-                m_HistoryCollector.AddOpndToHistory(m_numberString, m_currentVal);
+                m_HistoryCollector.AddOpndToHistory(m_numberString, ShownValue());
             }
 
             m_HistoryCollector.AddUnaryOpToHistory((int)wParam, m_bInv, m_angletype);
@@ -324,7 +328,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
         if (wParam == IDC_PERCENT)
         {
             CheckAndAddLastBinOpToHistory();
-            m_HistoryCollector.AddOpndToHistory(m_numberString, m_currentVal, true /* Add to primary and secondary display */);
+            m_HistoryCollector.AddOpndToHistory(m_numberString, ShownValue(), true /* Add to primary and secondary display */);
         }
 
         /* reset the m_bInv flag and indicators if it is set
@@ -382,8 +386,11 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
         if (nullptr != m_pCalcDisplay)
         {
             m_pCalcDisplay->SetParenthesisNumber(0);
-            m_pCalcDisplay->SetExpressionDisplay(
-                make_shared<CalculatorVector<pair<wstring, int>>>(), make_shared<CalculatorVector<shared_ptr<IExpressionCommand>>>());
+            if (!m_fHeadless)
+            {
+                m_pCalcDisplay->SetExpressionDisplay(
+                    make_shared<CalculatorVector<pair<wstring, int>>>(), make_shared<CalculatorVector<shared_ptr<IExpressionCommand>>>());
+            }
         }
 
         m_HistoryCollector.ClearHistoryLine(wstring());
@@ -445,7 +452,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
 
         if (!m_HistoryCollector.FOpndAddedToHistory())
         {
-            m_HistoryCollector.AddOpndToHistory(m_numberString, m_currentVal);
+            m_HistoryCollector.AddOpndToHistory(m_numberString, ShownValue());
         }
 
         // Evaluate the precedence stack.
@@ -470,7 +477,11 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
             ResolveHighestPrecedenceOperation();
         }
 
-        if (!m_bError)
+        if (!m_bError && m_fHeadless)
+        {
+            m_HistoryCollector.DeferHistoryLine(ShownValue());
+        }
+        else if (!m_bError)
         {
             wstring groupedString = GroupDigitsPerRadix(m_numberString, m_radix);
             m_HistoryCollector.CompleteHistoryLine(groupedString);
@@ -547,7 +558,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
 
             if (!m_HistoryCollector.FOpndAddedToHistory())
             {
-                m_HistoryCollector.AddOpndToHistory(m_numberString, m_currentVal);
+                m_HistoryCollector.AddOpndToHistory(m_numberString, ShownValue());
             }
 
             // Get the operation and number and return result.
@@ -603,6 +614,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
     case IDM_OCT:
     case IDM_BIN:
     {
+        CompleteDeferredHistory();
         SetRadixTypeAndNumWidth((RADIX_TYPE)(wParam - IDM_HEX), (NUM_WIDTH)-1);
         m_HistoryCollector.UpdateHistoryExpression(m_radix, m_precision);
         break;
@@ -612,14 +624,20 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
     case IDM_DWORD:
     case IDM_WORD:
     case IDM_BYTE:
+    case IDM_WORD128:
+    case IDM_WORD256:
+    case IDM_WORD512:
+    case IDM_WORD1024:
+        CompleteDeferredHistory();
         if (m_bRecord)
         {
             m_currentVal = m_input.ToRational(m_radix, m_precision);
             m_bRecord = false;
         }
 
-        // Compat. mode BaseX: Qword, Dword, Word, Byte
-        SetRadixTypeAndNumWidth((RADIX_TYPE)-1, (NUM_WIDTH)(wParam - IDM_QWORD));
+        // Compat. mode BaseX: Qword, Dword, Word, Byte, then the wide words
+        SetRadixTypeAndNumWidth(
+            (RADIX_TYPE)-1, IsOpInRange(wParam, IDM_QWORD, IDM_BYTE) ? (NUM_WIDTH)(wParam - IDM_QWORD) : (NUM_WIDTH)(WORD128_WIDTH + wParam - IDM_WORD128));
         break;
 
     case IDM_DEG:
@@ -651,7 +669,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
 
         if (!m_HistoryCollector.FOpndAddedToHistory())
         {
-            m_HistoryCollector.AddOpndToHistory(m_numberString, m_currentVal);
+            m_HistoryCollector.AddOpndToHistory(m_numberString, ShownValue());
         }
 
         m_currentVal = -(m_currentVal);
@@ -704,7 +722,7 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
         if (!m_fIntegerMode)
         {
             CheckAndAddLastBinOpToHistory(); // pi is like entering the number
-            m_currentVal = Rational{ (m_bInv ? two_pi : pi) };
+            m_currentVal = Rational{ (m_bInv ? g_ratpack->two_pi : g_ratpack->pi) };
 
             DisplayNum();
             m_bInv = false;
@@ -714,6 +732,8 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
         break;
 
     case IDC_FE:
+        CompleteDeferredHistory();
+
         // Toggle exponential notation display.
         m_nFE = NUMOBJ_FMT(!(int)m_nFE);
         DisplayNum();
@@ -761,7 +781,7 @@ void CCalcEngine::ResolveHighestPrecedenceOperation()
             m_currentVal = m_holdVal;
             DisplayNum(); // to update the m_numberString
             m_HistoryCollector.AddBinOpToHistory(m_nOpCode, false);
-            m_HistoryCollector.AddOpndToHistory(m_numberString, m_currentVal); // Adding the repeated last op to history
+            m_HistoryCollector.AddOpndToHistory(m_numberString, ShownValue()); // Adding the repeated last op to history
         }
 
         // Do the current or last operation.
@@ -815,7 +835,11 @@ void CCalcEngine::CheckAndAddLastBinOpToHistory(bool addToHistory)
         // MR, SUM etc. All you will get is 5 = 5 kind of no useful equation.
         if ((IsUnaryOpCode(m_nLastCom) || IDC_SIGN == m_nLastCom || IDC_CLOSEP == m_nLastCom) && 0 == m_openParenCount)
         {
-            if (addToHistory)
+            if (addToHistory && m_fHeadless)
+            {
+                m_HistoryCollector.DeferHistoryLine(ShownValue());
+            }
+            else if (addToHistory)
             {
                 m_HistoryCollector.CompleteHistoryLine(GroupDigitsPerRadix(m_numberString, m_radix));
             }
@@ -942,6 +966,7 @@ wstring_view CCalcEngine::OpCodeToUnaryString(int nOpCode, bool fInv, ANGLE_TYPE
 
 bool CCalcEngine::IsCurrentTooBigForTrig()
 {
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
     return m_currentVal >= m_maxTrigonometricNum;
 }
 
@@ -952,6 +977,7 @@ int CCalcEngine::GetCurrentRadix()
 
 wstring CCalcEngine::GetCurrentResultForRadix(uint32_t radix, int32_t precision)
 {
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
     Rational rat = (m_bRecord ? m_input.ToRational(m_radix, m_precision) : m_currentVal);
 
     ChangeConstants(m_radix, precision);
@@ -966,8 +992,74 @@ wstring CCalcEngine::GetCurrentResultForRadix(uint32_t radix, int32_t precision)
     return GroupDigitsPerRadix(numberString, radix);
 }
 
+// Gets the current value in each radix of Programmer mode, indexed by RADIX_TYPE.
+// An integer is cut to the word once and every radix is spelled out from that word.
+array<wstring, 4> CCalcEngine::GetCurrentResultForAllRadixes(int32_t precision)
+{
+    static constexpr uint32_t radixes[] = { 16, 10, 8, 2 };
+    array<wstring, 4> results;
+
+    {
+        RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
+        Rational rat = (m_bRecord ? m_input.ToRational(m_radix, m_precision) : m_currentVal);
+
+        IntegerMath::WideWord word;
+        if (m_fIntegerMode && m_nFE == FMT_FLOAT && IntegerMath::TryToWideWord(rat, m_dwWordBitWidth, word))
+        {
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                results[i] = GroupDigitsPerRadix(IntegerMath::ToRadixString(word, radixes[i], m_dwWordBitWidth), radixes[i]);
+            }
+            return results;
+        }
+    }
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        results[i] = GetCurrentResultForRadix(radixes[i], precision);
+    }
+    return results;
+}
+
+// While headless the engine keeps its values but formats and shows nothing, the lines of history are
+// kept and only made when asked for. Leaving it shows the current state again.
+void CCalcEngine::SetHeadless(bool fHeadless)
+{
+    if (fHeadless == m_fHeadless)
+    {
+        return;
+    }
+
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
+    if (!fHeadless)
+    {
+        m_HistoryCollector.CompleteDeferredLines(*this);
+    }
+
+    m_fHeadless = fHeadless;
+    m_HistoryCollector.SetDeferTokens(fHeadless);
+
+    // An error was shown when it happened
+    if (!fHeadless && !m_bError)
+    {
+        DisplayNum();
+    }
+}
+
+// Adds the lines of history completed while headless, and makes the rest of the current line. It is
+// called before the radix, format or anything else the strings are made with changes.
+void CCalcEngine::CompleteDeferredHistory()
+{
+    if (m_fHeadless)
+    {
+        RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
+        m_HistoryCollector.CompleteDeferredLines(*this);
+    }
+}
+
 wstring CCalcEngine::GetStringForDisplay(Rational const& rat, uint32_t radix)
 {
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
     wstring result{};
     // Check for standard\scientific mode
     if (!m_fIntegerMode)
@@ -982,15 +1074,15 @@ wstring CCalcEngine::GetStringForDisplay(Rational const& rat, uint32_t radix)
 
         try
         {
-            uint64_t w64Bits = tempRat.ToUInt64_t();
-            bool fMsb = ((w64Bits >> (m_dwWordBitWidth - 1)) & 1);
+            bool fMsb = IntegerMath::IsMsbSet(tempRat, m_dwWordBitWidth);
             if ((radix == 10) && fMsb)
             {
                 // If high bit is set, then get the decimal number in negative 2's complement form.
                 tempRat = -((tempRat ^ m_chopNumbers[m_numwidth]) + 1);
             }
 
-            result = tempRat.ToString(radix, m_nFE, m_precision);
+            // Every digit holds at least a bit, the bit width is enough precision for the widest words
+            result = tempRat.ToString(radix, m_nFE, max(m_precision, m_dwWordBitWidth));
         }
         catch (uint32_t)
         {
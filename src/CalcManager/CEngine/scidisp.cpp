@@ -21,6 +21,8 @@ using namespace std;
 using namespace CalcEngine;
 
 constexpr int MAX_EXPONENT = 4;
+// A decimal within 2^33000 (about 10^9934) of 1 has an exponent that fits in MAX_EXPONENT digits
+constexpr int64_t MAX_UNCHECKED_LOG2 = 33000;
 constexpr uint32_t MAX_GROUPING_SIZE = 16;
 constexpr wstring_view c_decPreSepStr = L"[+-]?(\\d*)[";
 constexpr wstring_view c_decPostSepStr = L"]?(\\d*)(?:e[+-]?(\\d*))?$";
@@ -33,23 +35,6 @@ constexpr wstring_view c_decPostSepStr = L"]?(\\d*)(?:e[+-]?(\\d*))?$";
 * Updates the following variables:
 *   m_currentVal, m_numberString
 \****************************************************************************/
-//
-// State of calc last time DisplayNum was called
-//
-typedef struct
-{
-    Rational value;
-    int32_t precision;
-    uint32_t radix;
-    int nFE;
-    NUM_WIDTH numwidth;
-    bool fIntMath;
-    bool bRecord;
-    bool bUseSep;
-} LASTDISP;
-
-LASTDISP gldPrevious = { 0, -1, 0, -1, (NUM_WIDTH)-1, false, false, false };
-
 // Truncates if too big, makes it a non negative - the number in rat. Doesn't do anything if not in INT mode
 CalcEngine::Rational CCalcEngine::TruncateNumForIntMath(CalcEngine::Rational const& rat)
 {
@@ -58,6 +43,19 @@ CalcEngine::Rational CCalcEngine::TruncateNumForIntMath(CalcEngine::Rational con
         return rat;
     }
 
+    if (m_dwWordBitWidth > 64)
+    {
+        IntegerMath::WideWord wideWord;
+        if (IntegerMath::TryToWideWord(rat, m_dwWordBitWidth, wideWord))
+        {
+            return IntegerMath::FromWideWord(wideWord, m_dwWordBitWidth);
+        }
+    }
+    else if (uint64_t word; IntegerMath::TryToWord(rat, m_dwWordBitWidth, word))
+    {
+        return word;
+    }
+
     // Truncate to an integer. Do not round here.
     auto result = RationalMath::Integer(rat);
 
@@ -77,55 +75,100 @@ CalcEngine::Rational CCalcEngine::TruncateNumForIntMath(CalcEngine::Rational con
 
 void CCalcEngine::DisplayNum(void)
 {
-    //
-    // Only change the display if
-    //  we are in record mode                               -OR-
-    //  this is the first time DisplayNum has been called,  -OR-
-    //  something important has changed since the last time DisplayNum was
-    //  called.
-    //
-    if (m_bRecord || gldPrevious.value != m_currentVal || gldPrevious.precision != m_precision || gldPrevious.radix != m_radix || gldPrevious.nFE != (int)m_nFE
-        || gldPrevious.bUseSep != true || gldPrevious.numwidth != m_numwidth || gldPrevious.fIntMath != m_fIntegerMode || gldPrevious.bRecord != m_bRecord)
+    if (m_fHeadless)
     {
-        gldPrevious.precision = m_precision;
-        gldPrevious.radix = m_radix;
-        gldPrevious.nFE = (int)m_nFE;
-        gldPrevious.numwidth = m_numwidth;
-
-        gldPrevious.fIntMath = m_fIntegerMode;
-        gldPrevious.bRecord = m_bRecord;
-        gldPrevious.bUseSep = true;
-
-        if (m_bRecord)
+        // Nothing is shown, so only what making the string would change is done. A decimal is made
+        // into a string to look for an overflow only when its size doesn't rule one out already.
+        m_fShownInput = m_bRecord;
+        if (!m_bRecord)
         {
-            // Display the string and return.
-            m_numberString = m_input.ToString(m_radix);
-        }
-        else
-        {
-            // If we're in Programmer mode, perform integer truncation so e.g. 5 / 2 * 2 results in 4, not 5.
             if (m_fIntegerMode)
             {
                 m_currentVal = TruncateNumForIntMath(m_currentVal);
             }
-            m_numberString = GetStringForDisplay(m_currentVal, m_radix);
+            else if (m_radix == 10 && m_currentVal.Log2Bound() > MAX_UNCHECKED_LOG2)
+            {
+                if (IsNumberInvalid(GetStringForDisplay(m_currentVal, m_radix), MAX_EXPONENT, m_precision, m_radix))
+                {
+                    DisplayError(CALC_E_OVERFLOW);
+                }
+            }
+            m_shownVal = m_currentVal;
         }
+        return;
+    }
 
-        // Displayed number can go through transformation. So copy it after transformation
-        gldPrevious.value = m_currentVal;
+    bool fOverflow;
+    if (m_bRecord)
+    {
+        // Display the string and return.
+        m_numberString = m_input.ToString(m_radix);
 
-        if ((m_radix == 10) && IsNumberInvalid(m_numberString, MAX_EXPONENT, m_precision, m_radix))
+        int32_t maxMantissa = m_fIntegerMode ? max(m_precision, m_dwWordBitWidth) : m_precision;
+        fOverflow = (m_radix == 10) && IsNumberInvalid(m_numberString, MAX_EXPONENT, maxMantissa, m_radix);
+    }
+    else
+    {
+        //
+        // Only format the number again if it or anything the string depends
+        // on has changed since the last time this instance formatted one.
+        //
+        m_displayCache.lookups++;
+        if (m_displayCache.fValid && m_displayCache.value == m_currentVal && m_displayCache.precision == m_precision && m_displayCache.radix == m_radix
+            && m_displayCache.nFE == m_nFE && m_displayCache.numwidth == m_numwidth && m_displayCache.fIntMath == m_fIntegerMode)
         {
-            DisplayError(CALC_E_OVERFLOW);
+            m_displayCache.hits++;
+
+            // An error stays up until it is cleared.
+            if (m_bError)
+            {
+                m_numberString = m_displayCache.numberString;
+                return;
+            }
         }
         else
         {
-            // Display the string and return.
-            SetPrimaryDisplay(GroupDigitsPerRadix(m_numberString, m_radix));
+            // If we're in Programmer mode, perform integer truncation so e.g. 5 / 2 * 2 results in 4, not 5.
+            if (m_fIntegerMode)
+            {
+                m_currentVal = TruncateNumForIntMath(m_currentVal);
+            }
+            m_displayCache.numberString = GetStringForDisplay(m_currentVal, m_radix);
+
+            int32_t maxMantissa = m_fIntegerMode ? max(m_precision, m_dwWordBitWidth) : m_precision;
+            m_displayCache.fOverflow = (m_radix == 10) && IsNumberInvalid(m_displayCache.numberString, MAX_EXPONENT, maxMantissa, m_radix);
+
+            // Displayed number can go through transformation. So copy it after transformation
+            m_displayCache.value = m_currentVal;
+            m_displayCache.precision = m_precision;
+            m_displayCache.radix = m_radix;
+            m_displayCache.nFE = m_nFE;
+            m_displayCache.numwidth = m_numwidth;
+            m_displayCache.fIntMath = m_fIntegerMode;
+            m_displayCache.fValid = true;
         }
+        m_numberString = m_displayCache.numberString;
+        fOverflow = m_displayCache.fOverflow;
+    }
+
+    if (fOverflow)
+    {
+        DisplayError(CALC_E_OVERFLOW);
+    }
+    else
+    {
+        // Display the string and return.
+        SetPrimaryDisplay(GroupDigitsPerRadix(m_numberString, m_radix));
     }
 }
 
+// The value m_numberString was made from. Once the input is shown m_currentVal is set from it
+// before the history wants it, and only headless keeps a value that m_currentVal may have moved on from.
+Rational const& CCalcEngine::ShownValue() const
+{
+    return (m_fHeadless && !m_fShownInput) ? m_shownVal : m_currentVal;
+}
+
 int CCalcEngine::IsNumberInvalid(const wstring& numberString, int iMaxExp, int iMaxMantissa, uint32_t radix) const
 {
     int iError = 0;
@@ -248,18 +291,36 @@ wstring CCalcEngine::GroupDigitsPerRadix(wstring_view numberString, uint32_t rad
         return wstring{};
     }
 
+    // The display string is grouped again for history and the memory list.
+    m_displayCache.lookups++;
+    if (m_displayCache.groupRadix == radix && m_displayCache.groupInput == numberString)
+    {
+        m_displayCache.hits++;
+        return m_displayCache.groupOutput;
+    }
+
+    wstring grouped;
     switch (radix)
     {
     case 10:
-        return GroupDigits(wstring{ m_groupSeparator }, m_decGrouping, numberString, (L'-' == numberString[0]));
+        grouped = GroupDigits(wstring{ m_groupSeparator }, m_decGrouping, numberString, (L'-' == numberString[0]));
+        break;
     case 8:
-        return GroupDigits(L" ", { 3, 0 }, numberString);
+        grouped = GroupDigits(L" ", { 3, 0 }, numberString);
+        break;
     case 2:
     case 16:
-        return GroupDigits(L" ", { 4, 0 }, numberString);
+        grouped = GroupDigits(L" ", { 4, 0 }, numberString);
+        break;
     default:
-        return wstring{ numberString };
+        grouped = numberString;
+        break;
     }
+
+    m_displayCache.groupRadix = radix;
+    m_displayCache.groupInput = numberString;
+    m_displayCache.groupOutput = grouped;
+    return grouped;
 }
 
 /****************************************************************************\
@@ -25,6 +25,8 @@ using namespace CalcEngine::RationalMath;
 /* Routines for more complex mathematical functions/error checking. */
 CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& rat, uint32_t op)
 {
+    // The ratpak temporaries of the whole function come from one arena.
+    RATPACKARENA arena;
     Rational result{};
     try
     {
@@ -40,6 +42,14 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
             {
                 result = -(RationalMath::Integer(rat) + 1);
             }
+            else if (IntegerMath::WideWord wideWord; m_fIntegerMode && m_dwWordBitWidth > 64 && IntegerMath::TryToWideWord(rat, m_dwWordBitWidth, wideWord))
+            {
+                result = IntegerMath::FromWideWord(IntegerMath::Complement(wideWord, m_dwWordBitWidth), m_dwWordBitWidth);
+            }
+            else if (uint64_t w64Bits; m_fIntegerMode && m_dwWordBitWidth <= 64 && IntegerMath::TryToWord(rat, m_dwWordBitWidth, w64Bits))
+            {
+                result = IntegerMath::Complement(w64Bits, m_dwWordBitWidth);
+            }
             else
             {
                 result = rat ^ m_chopNumbers[m_numwidth];
@@ -50,9 +60,26 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
         case IDC_ROL:
             if (m_fIntegerMode)
             {
+                uint64_t w64Bits;
+                if (m_dwWordBitWidth <= 64 && IntegerMath::TryToWord(rat, m_dwWordBitWidth, w64Bits))
+                {
+                    result = IntegerMath::RotateLeft(w64Bits, m_dwWordBitWidth);
+                    break;
+                }
+
                 result = Integer(rat);
 
-                uint64_t w64Bits = result.ToUInt64_t();
+                if (m_dwWordBitWidth > 64)
+                {
+                    IntegerMath::WideWord wideWord;
+                    if (IntegerMath::TryToWideWord(result, m_dwWordBitWidth, wideWord))
+                    {
+                        result = IntegerMath::FromWideWord(IntegerMath::RotateLeft(wideWord, m_dwWordBitWidth), m_dwWordBitWidth);
+                    }
+                    break;
+                }
+
+                w64Bits = result.ToUInt64_t();
                 uint64_t msb = (w64Bits >> (m_dwWordBitWidth - 1)) & 1;
                 w64Bits <<= 1;  // LShift by 1
                 w64Bits |= msb; // Set the prev Msb as the current Lsb
@@ -65,9 +92,26 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
         case IDC_ROR:
             if (m_fIntegerMode)
             {
+                uint64_t w64Bits;
+                if (m_dwWordBitWidth <= 64 && IntegerMath::TryToWord(rat, m_dwWordBitWidth, w64Bits))
+                {
+                    result = IntegerMath::RotateRight(w64Bits, m_dwWordBitWidth);
+                    break;
+                }
+
                 result = Integer(rat);
 
-                uint64_t w64Bits = result.ToUInt64_t();
+                if (m_dwWordBitWidth > 64)
+                {
+                    IntegerMath::WideWord wideWord;
+                    if (IntegerMath::TryToWideWord(result, m_dwWordBitWidth, wideWord))
+                    {
+                        result = IntegerMath::FromWideWord(IntegerMath::RotateRight(wideWord, m_dwWordBitWidth), m_dwWordBitWidth);
+                    }
+                    break;
+                }
+
+                w64Bits = result.ToUInt64_t();
                 uint64_t lsb = ((w64Bits & 0x01) == 1) ? 1 : 0;
                 w64Bits >>= 1; // RShift by 1
                 w64Bits |= (lsb << (m_dwWordBitWidth - 1));
@@ -14,6 +14,25 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
 
     try
     {
+        // Programmer mode integers that fit a word are done natively, the rest
+        // and the powers and roots go through the rationals below.
+        if (m_fIntegerMode && operation != IDC_PWR && operation != IDC_ROOT)
+        {
+            if (m_dwWordBitWidth > 64)
+            {
+                IntegerMath::WideWord lhsWide, rhsWide;
+                if (IntegerMath::TryToWideWord(lhs, m_dwWordBitWidth, lhsWide) && IntegerMath::TryToWideWord(rhs, m_dwWordBitWidth, rhsWide))
+                {
+                    return IntegerMath::FromWideWord(DoWideOperation(operation, lhsWide, rhsWide), m_dwWordBitWidth);
+                }
+            }
+            else if (uint64_t lhsWord, rhsWord;
+                     IntegerMath::TryToWord(lhs, m_dwWordBitWidth, lhsWord) && IntegerMath::TryToWord(rhs, m_dwWordBitWidth, rhsWord))
+            {
+                return Rational{ DoWordOperation(operation, lhsWord, rhsWord) };
+            }
+        }
+
         switch (operation)
         {
         case IDC_AND:
@@ -35,8 +54,7 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
                 throw CALC_E_NORESULT;
             }
 
-            uint64_t w64Bits = rhs.ToUInt64_t();
-            bool fMsb = (w64Bits >> (m_dwWordBitWidth - 1)) & 1;
+            bool fMsb = IntegerMath::IsMsbSet(rhs, m_dwWordBitWidth);
 
             Rational holdVal = result;
             result = rhs >> holdVal;
@@ -83,8 +101,7 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
 
             if (m_fIntegerMode)
             {
-                uint64_t w64Bits = rhs.ToUInt64_t();
-                bool fMsb = (w64Bits >> (m_dwWordBitWidth - 1)) & 1;
+                bool fMsb = IntegerMath::IsMsbSet(rhs, m_dwWordBitWidth);
 
                 if (fMsb)
                 {
@@ -93,8 +110,7 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
                     iNumeratorSign = -1;
                 }
 
-                w64Bits = temp.ToUInt64_t();
-                fMsb = (w64Bits >> (m_dwWordBitWidth - 1)) & 1;
+                fMsb = IntegerMath::IsMsbSet(temp, m_dwWordBitWidth);
 
                 if (fMsb)
                 {
@@ -152,3 +168,82 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
 
     return result;
 }
+
+// The Programmer mode operations on words of m_dwWordBitWidth bits, operands
+// in the same order as DoOperation.
+uint64_t CCalcEngine::DoWordOperation(int operation, uint64_t lhs, uint64_t rhs)
+{
+    switch (operation)
+    {
+    case IDC_AND:
+        return lhs & rhs;
+
+    case IDC_OR:
+        return lhs | rhs;
+
+    case IDC_XOR:
+        return lhs ^ rhs;
+
+    case IDC_RSHF:
+        return IntegerMath::ShiftRight(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_LSHF:
+        return IntegerMath::ShiftLeft(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_ADD:
+        return IntegerMath::Add(lhs, rhs, m_dwWordBitWidth);
+
+    case IDC_SUB:
+        return IntegerMath::Subtract(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_MUL:
+        return IntegerMath::Multiply(lhs, rhs, m_dwWordBitWidth);
+
+    case IDC_DIV:
+        return IntegerMath::Divide(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_MOD:
+        return IntegerMath::Remainder(rhs, lhs, m_dwWordBitWidth);
+    }
+
+    return lhs;
+}
+
+// DoWordOperation for the word sizes past 64 bits.
+IntegerMath::WideWord CCalcEngine::DoWideOperation(int operation, IntegerMath::WideWord const& lhs, IntegerMath::WideWord const& rhs)
+{
+    switch (operation)
+    {
+    case IDC_AND:
+        return IntegerMath::And(lhs, rhs, m_dwWordBitWidth);
+
+    case IDC_OR:
+        return IntegerMath::Or(lhs, rhs, m_dwWordBitWidth);
+
+    case IDC_XOR:
+        return IntegerMath::Xor(lhs, rhs, m_dwWordBitWidth);
+
+    case IDC_RSHF:
+        return IntegerMath::ShiftRight(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_LSHF:
+        return IntegerMath::ShiftLeft(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_ADD:
+        return IntegerMath::Add(lhs, rhs, m_dwWordBitWidth);
+
+    case IDC_SUB:
+        return IntegerMath::Subtract(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_MUL:
+        return IntegerMath::Multiply(lhs, rhs, m_dwWordBitWidth);
+
+    case IDC_DIV:
+        return IntegerMath::Divide(rhs, lhs, m_dwWordBitWidth);
+
+    case IDC_MOD:
+        return IntegerMath::Remainder(rhs, lhs, m_dwWordBitWidth);
+    }
+
+    return lhs;
+}
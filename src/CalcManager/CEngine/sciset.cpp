@@ -18,8 +18,7 @@ void CCalcEngine::SetRadixTypeAndNumWidth(RADIX_TYPE radixtype, NUM_WIDTH numwid
     // back to 1111,1111,1000,0001 when in Word mode.
     if (m_fIntegerMode)
     {
-        uint64_t w64Bits = m_currentVal.ToUInt64_t();
-        bool fMsb = (w64Bits >> (m_dwWordBitWidth - 1)) & 1; // make sure you use the old width
+        bool fMsb = IntegerMath::IsMsbSet(m_currentVal, m_dwWordBitWidth); // make sure you use the old width
 
         if (fMsb)
         {
@@ -36,7 +35,7 @@ void CCalcEngine::SetRadixTypeAndNumWidth(RADIX_TYPE radixtype, NUM_WIDTH numwid
         // radixtype is not even saved
     }
 
-    if (numwidth >= QWORD_WIDTH && numwidth <= BYTE_WIDTH)
+    if (numwidth >= QWORD_WIDTH && numwidth <= WORD1024_WIDTH)
     {
         m_numwidth = numwidth;
         m_dwWordBitWidth = DwWordBitWidthFromeNumWidth(numwidth);
@@ -50,14 +49,14 @@ void CCalcEngine::SetRadixTypeAndNumWidth(RADIX_TYPE radixtype, NUM_WIDTH numwid
     DisplayNum();
 }
 
-int32_t CCalcEngine::DwWordBitWidthFromeNumWidth(NUM_WIDTH /*numwidth*/)
+int32_t CCalcEngine::DwWordBitWidthFromeNumWidth(NUM_WIDTH numwidth)
 {
-    static constexpr int nBitMax[] = { 64, 32, 16, 8 };
+    static constexpr int nBitMax[] = { 64, 32, 16, 8, 128, 256, 512, 1024 };
     int32_t wmax = nBitMax[0];
 
-    if (m_numwidth >= 0 && (size_t)m_numwidth < size(nBitMax))
+    if (numwidth >= 0 && (size_t)numwidth < size(nBitMax))
     {
-        wmax = nBitMax[m_numwidth];
+        wmax = nBitMax[numwidth];
     }
     return wmax;
 }
@@ -136,6 +135,7 @@ int CCalcEngine::QuickLog2(int iNum)
 // Base 10 is a special case and always uses the base 10 precision (m_nPrecisionSav).
 void CCalcEngine::UpdateMaxIntDigits()
 {
+    RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
     if (m_radix == 10)
     {
         // if in integer mode you still have to honor the max digits you can enter based on bit width
@@ -11,6 +11,7 @@ using namespace CalcEngine;
 
 static constexpr size_t MAX_HISTORY_ITEMS = 20;
 static constexpr size_t SERIALIZED_NUMBER_MINSIZE = 3;
+static constexpr size_t SERIALIZED_WORDS_PER_DIGIT = sizeof(MANTTYPE) / sizeof(uint32_t);
 
 // Converts Memory Command enum value to unsigned char,
 // while ignoring Warning C4309: 'conversion' : truncation of constant value
@@ -23,6 +24,7 @@ namespace CalculationManager
         , m_currentCalculatorEngine(nullptr)
         , m_resourceProvider(resourceProvider)
         , m_inHistoryItemLoadMode(false)
+        , m_isHeadless(false)
         , m_persistedPrimaryValue()
         , m_isExponentialFormat(false)
         , m_currentDegreeMode(Command::CommandNULL)
@@ -168,6 +170,7 @@ namespace CalculationManager
         }
 
         m_currentCalculatorEngine = m_standardCalculatorEngine.get();
+        m_currentCalculatorEngine->SetHeadless(m_isHeadless);
         m_currentCalculatorEngine->ProcessCommand(IDC_DEC);
         m_currentCalculatorEngine->ProcessCommand(IDC_CLEAR);
         m_currentCalculatorEngine->ChangePrecision(static_cast<int>(CalculatorPrecision::StandardModePrecision));
@@ -187,6 +190,7 @@ namespace CalculationManager
         }
 
         m_currentCalculatorEngine = m_scientificCalculatorEngine.get();
+        m_currentCalculatorEngine->SetHeadless(m_isHeadless);
         m_currentCalculatorEngine->ProcessCommand(IDC_DEC);
         m_currentCalculatorEngine->ProcessCommand(IDC_CLEAR);
         m_currentCalculatorEngine->ChangePrecision(static_cast<int>(CalculatorPrecision::ScientificModePrecision));
@@ -205,11 +209,58 @@ namespace CalculationManager
         }
 
         m_currentCalculatorEngine = m_programmerCalculatorEngine.get();
+        m_currentCalculatorEngine->SetHeadless(m_isHeadless);
         m_currentCalculatorEngine->ProcessCommand(IDC_DEC);
         m_currentCalculatorEngine->ProcessCommand(IDC_CLEAR);
         m_currentCalculatorEngine->ChangePrecision(static_cast<int>(CalculatorPrecision::ProgrammerModePrecision));
     }
 
+    /// <summary>
+    /// Turn headless mode on or off.
+    /// While headless the engines only keep their values: nothing is formatted or sent to the display
+    /// callback, apart from errors, until a result is asked for with GetResultForRadix. The lines of
+    /// history are made when the history is read. Turning it off brings the displays up to date.
+    /// An engine that isn't current follows when it is switched to.
+    /// </summary>
+    /// <param name="isHeadless">true to stop formatting results</param>
+    void CalculatorManager::SetHeadlessMode(bool isHeadless)
+    {
+        if (m_isHeadless == isHeadless)
+        {
+            return;
+        }
+
+        m_isHeadless = isHeadless;
+        if (!isHeadless)
+        {
+            CompleteDeferredHistory();
+        }
+
+        if (m_currentCalculatorEngine != nullptr)
+        {
+            m_currentCalculatorEngine->SetHeadless(isHeadless);
+            if (!isHeadless)
+            {
+                SetMemorizedNumbersString();
+            }
+        }
+    }
+
+    /// <summary>
+    /// Add the lines of history the engines kept while headless, so the history can be read or changed.
+    /// </summary>
+    void CalculatorManager::CompleteDeferredHistory()
+    {
+        if (m_standardCalculatorEngine)
+        {
+            m_standardCalculatorEngine->CompleteDeferredHistory();
+        }
+        if (m_scientificCalculatorEngine)
+        {
+            m_scientificCalculatorEngine->CompleteDeferredHistory();
+        }
+    }
+
     /// <summary>
     /// Send command to the Calc Engine
     /// Cast Command Enum to OpCode.
@@ -519,16 +570,19 @@ namespace CalculationManager
 
     vector<shared_ptr<HISTORYITEM>> const& CalculatorManager::GetHistoryItems()
     {
+        CompleteDeferredHistory();
         return m_pHistory->GetHistory();
     }
 
     vector<shared_ptr<HISTORYITEM>> const& CalculatorManager::GetHistoryItems(_In_ CALCULATOR_MODE mode)
     {
+        CompleteDeferredHistory();
         return (mode == CM_STD) ? m_pStdHistory->GetHistory() : m_pSciHistory->GetHistory();
     }
 
     shared_ptr<HISTORYITEM> const& CalculatorManager::GetHistoryItem(_In_ unsigned int uIdx)
     {
+        CompleteDeferredHistory();
         return m_pHistory->GetHistoryItem(uIdx);
     }
 
@@ -539,11 +593,13 @@ namespace CalculationManager
 
     bool CalculatorManager::RemoveHistoryItem(_In_ unsigned int uIdx)
     {
+        CompleteDeferredHistory();
         return m_pHistory->RemoveItem(uIdx);
     }
 
     void CalculatorManager::ClearHistory()
     {
+        CompleteDeferredHistory();
         m_pHistory->ClearHistory();
     }
 
@@ -571,6 +627,12 @@ namespace CalculationManager
 
     void CalculatorManager::SetMemorizedNumbersString()
     {
+        // Made when headless mode is turned off
+        if (m_isHeadless)
+        {
+            return;
+        }
+
         vector<wstring> resultVector;
         for (auto const& memoryItem : m_memorizedNumbers)
         {
@@ -596,6 +658,7 @@ namespace CalculationManager
 
     void CalculatorManager::SetHistory(_In_ CALCULATOR_MODE eMode, _In_ vector<shared_ptr<HISTORYITEM>> const& history)
     {
+        CompleteDeferredHistory();
         CalculatorHistory* pHistory = nullptr;
 
         switch (eMode)
@@ -623,6 +686,11 @@ namespace CalculationManager
         return m_currentCalculatorEngine ? m_currentCalculatorEngine->GetCurrentResultForRadix(radix, precision) : L"";
     }
 
+    array<wstring, 4> CalculatorManager::GetResultForAllRadixes(int32_t precision)
+    {
+        return m_currentCalculatorEngine ? m_currentCalculatorEngine->GetCurrentResultForAllRadixes(precision) : array<wstring, 4>{};
+    }
+
     void CalculatorManager::SetPrecision(int32_t precision)
     {
         m_currentCalculatorEngine->ChangePrecision(precision);
@@ -643,6 +711,11 @@ namespace CalculationManager
         return m_currentCalculatorEngine->FInRecordingState() ? true : false;
     }
 
+    bool CalculatorManager::IsEngineInError()
+    {
+        return m_currentCalculatorEngine->FInErrorState();
+    }
+
     void CalculatorManager::SetInHistoryItemLoadMode(_In_ bool isHistoryItemLoadMode)
     {
         m_inHistoryItemLoadMode = isHistoryItemLoadMode;
@@ -683,7 +756,7 @@ namespace CalculationManager
     Rational CalculatorManager::DeSerializeRational(vector<long>::const_iterator itr)
     {
         auto p = DeSerializeNumber(itr);
-        auto q = DeSerializeNumber(itr + SERIALIZED_NUMBER_MINSIZE + p.Mantissa().size());
+        auto q = DeSerializeNumber(itr + SERIALIZED_NUMBER_MINSIZE + p.Mantissa().size() * SERIALIZED_WORDS_PER_DIGIT);
 
         return Rational(p, q);
     }
@@ -698,6 +771,7 @@ namespace CalculationManager
     ///     [4] = Number.Mantissa[1]
     ///       ...
     ///     [2 + Number.Mantissa.size] = Number.Mantissa[size - 1]
+    /// With 64 bit digits each digit takes two entries, low half first.
     /// </summary>
     /// <param name = "num">Number to be serialized</param>
     vector<long> CalculatorManager::SerializeNumber(Number const& num)
@@ -709,7 +783,10 @@ namespace CalculationManager
         serializedNumber.push_back(num.Exp());
         for (auto const& digit : num.Mantissa())
         {
-            serializedNumber.push_back(digit);
+            for (size_t word = 0; word < SERIALIZED_WORDS_PER_DIGIT; word++)
+            {
+                serializedNumber.push_back(static_cast<uint32_t>(digit >> (32 * word)));
+            }
         }
 
         return serializedNumber;
@@ -731,10 +808,15 @@ namespace CalculationManager
         int32_t sign = *itr;
         uint32_t size = *(itr + 1);
         int32_t exp = *(itr + 2);
-        vector<uint32_t> mant{};
+        vector<MANTTYPE> mant{};
         for (size_t i = 0; i < size; ++i)
         {
-            mant.emplace_back(*(itr + 3 + i));
+            MANTTYPE digit = 0;
+            for (size_t word = 0; word < SERIALIZED_WORDS_PER_DIGIT; word++)
+            {
+                digit |= static_cast<MANTTYPE>(static_cast<uint32_t>(*(itr + 3 + i * SERIALIZED_WORDS_PER_DIGIT + word))) << (32 * word);
+            }
+            mant.emplace_back(digit);
         }
 
         return Number{ sign, exp, mant };
@@ -52,6 +52,7 @@ namespace CalculationManager
         std::unique_ptr<CCalcEngine> m_programmerCalculatorEngine;
         IResourceProvider* const m_resourceProvider;
         bool m_inHistoryItemLoadMode;
+        bool m_isHeadless;
 
         std::vector<CalcEngine::Rational> m_memorizedNumbers;
         CalcEngine::Rational m_persistedPrimaryValue;
@@ -75,6 +76,7 @@ namespace CalculationManager
         void MemorizedNumberChanged(_In_ unsigned int);
 
         void LoadPersistedPrimaryValue();
+        void CompleteDeferredHistory();
 
         static std::vector<long> SerializeRational(CalcEngine::Rational const& rat);
         static CalcEngine::Rational DeSerializeRational(std::vector<long>::const_iterator itr);
@@ -109,6 +111,11 @@ namespace CalculationManager
         void SetStandardMode();
         void SetScientificMode();
         void SetProgrammerMode();
+        void SetHeadlessMode(bool isHeadless);
+        bool IsHeadlessMode() const
+        {
+            return m_isHeadless;
+        }
         void SendCommand(_In_ Command command);
 
         void MemorizeNumber();
@@ -119,6 +126,7 @@ namespace CalculationManager
         void MemorizedNumberClearAll();
 
         bool IsEngineRecording();
+        bool IsEngineInError();
         std::vector<unsigned char> GetSavedCommands()
         {
             return m_savedCommands;
@@ -126,6 +134,7 @@ namespace CalculationManager
         void SetRadix(RADIX_TYPE iRadixType);
         void SetMemorizedNumbersString();
         std::wstring GetResultForRadix(uint32_t radix, int32_t precision);
+        std::array<std::wstring, 4> GetResultForAllRadixes(int32_t precision);
         void SetPrecision(int32_t precision);
         void UpdateMaxIntDigits();
         wchar_t DecimalSeparator();
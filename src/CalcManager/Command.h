@@ -175,6 +175,10 @@ namespace CalculationManager
         CommandDword = 318,
         CommandWord = 319,
         CommandByte = 320,
+        CommandWord128 = 330,
+        CommandWord256 = 331,
+        CommandWord512 = 332,
+        CommandWord1024 = 333,
 
         CommandBINEDITSTART = 700,
         CommandBINPOS0 = 700,
@@ -304,6 +304,11 @@ wstring COpndCommand::GetString(uint32_t radix, int32_t precision)
     return result;
 }
 
+Rational const& COpndCommand::GetValue() const
+{
+    return m_value;
+}
+
 void COpndCommand::Accept(_In_ ISerializeCommandVisitor& commandVisitor)
 {
     commandVisitor.Visit(*this);
@@ -64,6 +64,7 @@ public:
     CalculationManager::CommandType GetCommandType() const override;
     void Accept(_In_ ISerializeCommandVisitor& commandVisitor) override;
     std::wstring GetString(uint32_t radix, int32_t precision);
+    CalcEngine::Rational const& GetValue() const;
 
 private:
     std::shared_ptr<CalculatorVector<int>> m_commands;
@@ -29,6 +29,10 @@
 #define IDM_RAD 322
 #define IDM_GRAD 323
 #define IDM_DEGREES 324
+#define IDM_WORD128 330
+#define IDM_WORD256 331
+#define IDM_WORD512 332
+#define IDM_WORD1024 333
 
 #define IDC_HEX IDM_HEX
 #define IDC_DEC IDM_DEC
@@ -44,6 +48,10 @@
 #define IDC_DWORD IDM_DWORD
 #define IDC_WORD IDM_WORD
 #define IDC_BYTE IDM_BYTE
+#define IDC_WORD128 IDM_WORD128
+#define IDC_WORD256 IDM_WORD256
+#define IDC_WORD512 IDM_WORD512
+#define IDC_WORD1024 IDM_WORD1024
 
 // Key IDs:
 // These id's must be consecutive from IDC_FIRSTCONTROL to IDC_LASTCONTROL.
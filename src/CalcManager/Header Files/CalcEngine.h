@@ -26,20 +26,25 @@
 #include "ICalcDisplay.h"
 #include "Rational.h"
 #include "RationalMath.h"
+#include "IntegerMath.h"
 
 // The following are NOT real exports of CalcEngine, but for forward declarations
 // The real exports follows later
 
-// This is expected to be in same order as IDM_QWORD, IDM_DWORD etc.
+// This is expected to be in same order as IDM_QWORD, IDM_DWORD etc. followed by IDM_WORD128 onwards.
 enum eNUM_WIDTH
 {
-    QWORD_WIDTH, // Number width of 64 bits mode (default)
-    DWORD_WIDTH, // Number width of 32 bits mode
-    WORD_WIDTH,  // Number width of 16 bits mode
-    BYTE_WIDTH   // Number width of 16 bits mode
+    QWORD_WIDTH,   // Number width of 64 bits mode (default)
+    DWORD_WIDTH,   // Number width of 32 bits mode
+    WORD_WIDTH,    // Number width of 16 bits mode
+    BYTE_WIDTH,    // Number width of 16 bits mode
+    WORD128_WIDTH, // Number width of 128 bits mode
+    WORD256_WIDTH, // Number width of 256 bits mode
+    WORD512_WIDTH, // Number width of 512 bits mode
+    WORD1024_WIDTH // Number width of 1024 bits mode
 };
 typedef enum eNUM_WIDTH NUM_WIDTH;
-static constexpr size_t NUM_WIDTH_LENGTH = 4;
+static constexpr size_t NUM_WIDTH_LENGTH = 8;
 
 namespace CalculationManager
 {
@@ -72,16 +77,34 @@ public:
     {
         return m_bRecord;
     }
+    void SetHeadless(bool fHeadless);
+    bool IsHeadless() const
+    {
+        return m_fHeadless;
+    }
+    void CompleteDeferredHistory();
     void SettingsChanged();
     bool IsCurrentTooBigForTrig();
     int GetCurrentRadix();
     std::wstring GetCurrentResultForRadix(uint32_t radix, int32_t precision);
+    std::array<std::wstring, 4> GetCurrentResultForAllRadixes(int32_t precision);
     void ChangePrecision(int32_t precision)
     {
+        RATPACKCONTEXTSCOPE scope(*m_ratpackContext);
+        CompleteDeferredHistory();
         m_precision = precision;
         ChangeConstants(m_radix, precision);
     }
     std::wstring GroupDigitsPerRadix(std::wstring_view numberString, uint32_t radix);
+    // Lookups of the display cache, and how many of them found their string already made
+    uint64_t DisplayCacheLookups() const
+    {
+        return m_displayCache.lookups;
+    }
+    uint64_t DisplayCacheHits() const
+    {
+        return m_displayCache.hits;
+    }
     std::wstring GetStringForDisplay(CalcEngine::Rational const& rat, uint32_t radix);
     void UpdateMaxIntDigits();
     wchar_t DecimalSeparator() const;
@@ -115,6 +138,7 @@ private:
     bool m_bChangeOp;              /* Flag for changing operation.       */
     bool m_bRecord;                // Global mode: recording or displaying
     bool m_bSetCalcState;          // Flag for setting the engine result state
+    bool m_fHeadless;              // Nothing is formatted or shown until it is asked for
     CalcEngine::CalcInput m_input; // Global calc input object for decimal strings
     eNUMOBJ_FMT m_nFE;             /* Scientific notation conversion flag.       */
     CalcEngine::Rational m_maxTrigonometricNum;
@@ -136,6 +160,31 @@ private:
     std::vector<uint32_t> m_decGrouping; // Holds the decimal digit grouping number
 
     std::wstring m_numberString;
+    CalcEngine::Rational m_shownVal; // While headless, the value last shown when it wasn't the input
+    bool m_fShownInput;
+
+    // The strings this instance made last, DisplayNum and GroupDigitsPerRadix
+    // give them back while their inputs stay the same
+    struct DISPLAYCACHE
+    {
+        bool fValid = false;        // false until a value has been formatted
+        CalcEngine::Rational value; // the value formatted, after any integer truncation
+        int32_t precision = 0;
+        uint32_t radix = 0;
+        eNUMOBJ_FMT nFE = FMT_FLOAT;
+        NUM_WIDTH numwidth = QWORD_WIDTH;
+        bool fIntMath = false;
+        bool fOverflow = false; // numberString is too long to be displayed
+        std::wstring numberString;
+
+        uint32_t groupRadix = 0;
+        std::wstring groupInput; // the last string grouped, and the grouping of it
+        std::wstring groupOutput;
+
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+    };
+    DISPLAYCACHE m_displayCache;
 
     int m_nTempCom;                          /* Holding place for the last command.          */
     int m_openParenCount;                    // Number of open parentheses.
@@ -154,6 +203,7 @@ private:
     static std::unordered_map<std::wstring, std::wstring> s_engineStrings; // the string table shared across all instances
     wchar_t m_decimalSeparator;
     wchar_t m_groupSeparator;
+    std::unique_ptr<RATPACKCONTEXT> m_ratpackContext; // ratpak radix, precision and constants of this instance
 
 private:
     void ProcessCommandWorker(OpCode wParam);
@@ -161,6 +211,7 @@ private:
     void HandleErrorCommand(OpCode idc);
     void HandleMaxDigitsReached();
     void DisplayNum(void);
+    CalcEngine::Rational const& ShownValue() const;
     int IsNumberInvalid(const std::wstring& numberString, int iMaxExp, int iMaxMantissa, uint32_t radix) const;
     void DisplayAnnounceBinaryOperator();
     void SetPrimaryDisplay(const std::wstring& szText, bool isError = false);
@@ -168,6 +219,9 @@ private:
     CalcEngine::Rational TruncateNumForIntMath(CalcEngine::Rational const& rat);
     CalcEngine::Rational SciCalcFunctions(CalcEngine::Rational const& rat, uint32_t op);
     CalcEngine::Rational DoOperation(int operation, CalcEngine::Rational const& lhs, CalcEngine::Rational const& rhs);
+    uint64_t DoWordOperation(int operation, uint64_t lhs, uint64_t rhs);
+    CalcEngine::IntegerMath::WideWord
+    DoWideOperation(int operation, CalcEngine::IntegerMath::WideWord const& lhs, CalcEngine::IntegerMath::WideWord const& rhs);
     void SetRadixTypeAndNumWidth(RADIX_TYPE radixtype, NUM_WIDTH numwidth);
     int32_t DwWordBitWidthFromeNumWidth(NUM_WIDTH numwidth);
     uint32_t NRadixFromRadixType(RADIX_TYPE radixtype);
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <array>
+#include <list>
 #include "ICalcDisplay.h"
 #include "IHistoryDisplay.h"
 #include "Rational.h"
@@ -11,6 +12,12 @@
 // maximum depth you can get by precedence. It is just an array's size limit.
 static constexpr size_t MAXPRECDEPTH = 25;
 
+// most lines completed while tokens are deferred that are kept for the history, the oldest are dropped past it
+static constexpr size_t MAXDEFERREDLINES = 64;
+
+class CCalcEngine;
+class COpndCommand;
+
 // Helper class really a internal class to CCalcEngine, to accumulate each history line of text by collecting the
 // operands, operator, unary operator etc. Since it is a separate entity, it can be unit tested on its own but does
 // rely on CCalcEngine calling it in appropriate order.
@@ -35,6 +42,9 @@ public:
     int AddCommand(_In_ const std::shared_ptr<IExpressionCommand>& spCommand);
     void UpdateHistoryExpression(uint32_t radix, int32_t precision);
     void SetDecimalSymbol(wchar_t decimalSymbol);
+    void SetDeferTokens(bool fDeferTokens);
+    void DeferHistoryLine(CalcEngine::Rational const& result);
+    void CompleteDeferredLines(CCalcEngine& engine);
 
 private:
     std::shared_ptr<IHistoryDisplay> m_pHistoryDisplay;
@@ -53,6 +63,18 @@ private:
     std::shared_ptr<CalculatorVector<std::pair<std::wstring, int>>> m_spTokens;
     std::shared_ptr<CalculatorVector<std::shared_ptr<IExpressionCommand>>> m_spCommands;
 
+    // While tokens are deferred an operand is added with an empty token and only its value, and
+    // neither the expression nor the history is shown. The strings are made by the engine later.
+    struct DEFERREDLINE
+    {
+        std::shared_ptr<CalculatorVector<std::pair<std::wstring, int>>> spTokens;
+        std::shared_ptr<CalculatorVector<std::shared_ptr<IExpressionCommand>>> spCommands;
+        CalcEngine::Rational result;
+    };
+    bool m_fDeferTokens;
+    unsigned int m_cShownTokens; // how many of m_spTokens the expression display was last given
+    std::list<DEFERREDLINE> m_deferredLines;
+
 private:
     void ReinitHistory();
     int IchAddSzToEquationSz(std::wstring_view str, int icommandIndex);
@@ -60,4 +82,9 @@ private:
     void SetExpressionDisplay();
     void InsertSzInEquationSz(std::wstring_view str, int icommandIndex, int ich);
     std::shared_ptr<CalculatorVector<int>> GetOperandCommandsFromString(std::wstring_view numStr);
+    std::shared_ptr<COpndCommand> CreateOperandCommand(std::wstring_view numStr, CalcEngine::Rational const& rat);
+    void RenderDeferredOperands(
+        CCalcEngine& engine,
+        CalculatorVector<std::pair<std::wstring, int>>& tokens,
+        CalculatorVector<std::shared_ptr<IExpressionCommand>>& commands);
 };
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include "Rational.h"
+
+// Programmer mode integers as native words.  A word is the low bitWidth bits
+// of a uint64_t read as two's complement, every function returns its result
+// cut back to bitWidth bits.
+namespace CalcEngine::IntegerMath
+{
+    uint64_t WordMask(int32_t bitWidth);
+    bool TryToWord(Rational const& rat, int32_t bitWidth, uint64_t& word);
+
+    uint64_t Add(uint64_t a, uint64_t b, int32_t bitWidth);
+    uint64_t Subtract(uint64_t a, uint64_t b, int32_t bitWidth);
+    uint64_t Multiply(uint64_t a, uint64_t b, int32_t bitWidth);
+    uint64_t Divide(uint64_t a, uint64_t b, int32_t bitWidth);
+    uint64_t Remainder(uint64_t a, uint64_t b, int32_t bitWidth);
+    uint64_t Negate(uint64_t a, int32_t bitWidth);
+    uint64_t Complement(uint64_t a, int32_t bitWidth);
+
+    uint64_t ShiftLeft(uint64_t a, uint64_t count, int32_t bitWidth);
+    uint64_t ShiftRight(uint64_t a, uint64_t count, int32_t bitWidth);
+    uint64_t RotateLeft(uint64_t a, int32_t bitWidth);
+    uint64_t RotateRight(uint64_t a, int32_t bitWidth);
+
+    bool IsNegative(uint64_t a, int32_t bitWidth);
+
+    // Word sizes above 64 bits, up to WIDE_WORD_BITS, are kept in 32 bit
+    // limbs, least significant first.  The limbs above bitWidth are zero.
+    inline constexpr int32_t WIDE_WORD_BITS = 1024;
+    inline constexpr int32_t WIDE_WORD_LIMBS = WIDE_WORD_BITS / 32;
+
+    struct WideWord
+    {
+        std::array<uint32_t, WIDE_WORD_LIMBS> limbs{};
+    };
+
+    bool TryToWideWord(Rational const& rat, int32_t bitWidth, WideWord& word);
+    Rational FromWideWord(WideWord const& word, int32_t bitWidth);
+
+    WideWord And(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Or(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Xor(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Add(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Subtract(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Multiply(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Divide(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Remainder(WideWord const& a, WideWord const& b, int32_t bitWidth);
+    WideWord Negate(WideWord const& a, int32_t bitWidth);
+    WideWord Complement(WideWord const& a, int32_t bitWidth);
+
+    WideWord ShiftLeft(WideWord const& a, WideWord const& count, int32_t bitWidth);
+    WideWord ShiftRight(WideWord const& a, WideWord const& count, int32_t bitWidth);
+    WideWord RotateLeft(WideWord const& a, int32_t bitWidth);
+    WideWord RotateRight(WideWord const& a, int32_t bitWidth);
+
+    bool IsNegative(WideWord const& a, int32_t bitWidth);
+
+    // Whether bit bitWidth - 1 of the integer part of rat is set, for any word size.
+    bool IsMsbSet(Rational const& rat, int32_t bitWidth);
+
+    // The word spelled out in radix 2, 8, 10 or 16 the way GetStringForDisplay
+    // writes it, unsigned but for a set top bit in decimal which is a minus.
+    std::wstring ToRadixString(WideWord const& word, uint32_t radix, int32_t bitWidth);
+}
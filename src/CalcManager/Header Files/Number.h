@@ -3,29 +3,72 @@
 
 #pragma once
 
+#include <initializer_list>
 #include <vector>
 #include "Ratpack/ratpak.h"
 
 namespace CalcEngine
 {
+    // Mantissas of up to this many digits are kept inside the Number.
+    inline constexpr uint32_t MANTISSA_INLINE_DIGITS = 4;
+
+    // The digits of a Number, least significant first.  Short mantissas,
+    // which are most of them, are stored inline so copying a Number doesn't
+    // go to the heap; longer ones spill to a heap array.
+    class NumberMantissa
+    {
+    public:
+        NumberMantissa() noexcept;
+        NumberMantissa(std::initializer_list<MANTTYPE> digits);
+        NumberMantissa(std::vector<MANTTYPE> const& digits);
+        NumberMantissa(MANTTYPE const* digits, size_t size);
+        NumberMantissa(NumberMantissa const& other);
+        NumberMantissa(NumberMantissa&& other) noexcept;
+        ~NumberMantissa();
+
+        NumberMantissa& operator=(NumberMantissa const& other);
+        NumberMantissa& operator=(NumberMantissa&& other) noexcept;
+
+        size_t size() const;
+        bool empty() const;
+        MANTTYPE const* data() const;
+        MANTTYPE const* begin() const;
+        MANTTYPE const* end() const;
+        MANTTYPE const& front() const;
+        MANTTYPE const& back() const;
+        MANTTYPE const& operator[](size_t i) const;
+
+    private:
+        void Assign(MANTTYPE const* digits, size_t size);
+        void Release() noexcept;
+        bool IsInline() const;
+
+        uint32_t m_size;
+        union
+        {
+            MANTTYPE m_inline[MANTISSA_INLINE_DIGITS];
+            MANTTYPE* m_heap;
+        };
+    };
+
     class Number
     {
     public:
         Number() noexcept;
-        Number(int32_t sign, int32_t exp, std::vector<uint32_t> const& mantissa) noexcept;
+        Number(int32_t sign, int32_t exp, NumberMantissa mantissa) noexcept;
 
         explicit Number(PNUMBER p) noexcept;
         PNUMBER ToPNUMBER() const;
 
         int32_t const& Sign() const;
         int32_t const& Exp() const;
-        std::vector<uint32_t> const& Mantissa() const;
+        NumberMantissa const& Mantissa() const;
 
         bool IsZero() const;
 
     private:
         int32_t m_sign;
         int32_t m_exp;
-        std::vector<uint32_t> m_mantissa;
+        NumberMantissa m_mantissa;
     };
 }
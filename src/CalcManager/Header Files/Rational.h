@@ -23,6 +23,12 @@ namespace CalcEngine
         Rational(int32_t i);
         Rational(uint32_t ui);
         Rational(uint64_t ui);
+        Rational(Rational const& other);
+        Rational(Rational&& other) noexcept;
+        ~Rational();
+
+        Rational& operator=(Rational const& other);
+        Rational& operator=(Rational&& other) noexcept;
 
         explicit Rational(PRAT prat) noexcept;
         PRAT ToPRAT() const;
@@ -66,9 +72,29 @@ namespace CalcEngine
 
         std::wstring ToString(uint32_t radix, NUMOBJ_FMT format, int32_t precision) const;
         uint64_t ToUInt64_t() const;
+        bool TryToUInt64(uint64_t& value) const;
+
+        // An upper bound on |log2 |value||, from the lengths of P and Q alone. 0 is given 64.
+        int64_t Log2Bound() const;
 
     private:
-        Number m_p;
-        Number m_q;
+        void SetSmall(int64_t p, int64_t q) noexcept;
+        void SetRat(PRAT prat) noexcept;
+        PRAT PeekPRAT() const;
+        Rational& ApplyInPlace(Rational const& rhs, void (*op)(PRAT*, PRAT));
+        Rational& ApplyToCopy(Rational const& rhs, void (*op)(PRAT*, PRAT));
+
+        // Values whose numerator and denominator both fit in an int64_t are
+        // kept in m_smallP and m_smallQ and worked on with checked 64 bit
+        // arithmetic, falling back to ratpack when it overflows.  Anything
+        // bigger is kept in m_rat, which the operators work on in place.
+        // m_p and m_q are only filled in when P() or Q() is asked for.
+        bool m_isSmall = true;
+        int64_t m_smallP = 0;
+        int64_t m_smallQ = 1; // always > 0
+        PRAT m_rat = nullptr;
+        mutable bool m_hasPQ = false;
+        mutable Number m_p{ 1, 0, {} };
+        mutable Number m_q{ 1, 0, {} };
     };
 }
@@ -0,0 +1,191 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           agm.cpp
+//
+//
+//  Description
+//
+//     Contains the natural logarithm by the arithmetic-geometric mean.  For
+//  s large enough ln(s) = pi / (2 AGM(1, 4/s)) to the precision asked for,
+//  and the AGM doubles its correct digits every step, so a log is a few
+//  dozen square roots and multiplies of the full length where the series
+//  need more terms the more digits are asked for.  ln(x) is then
+//  ln(x 2^m) - m ln(2) for an m that makes x 2^m large enough.  pi and ln(2)
+//  are kept in fixed point in the context for the precision last asked for.
+//
+//-----------------------------------------------------------------------------
+#include "ratpak.h"
+
+using namespace std;
+
+// Below this many bits of precision the series in exp.cpp and series.cpp
+// are faster.
+static constexpr int32_t AGM_LOG_MIN_BITS = 1000;
+
+// BASEX digits carried past the series' fixed point digits.  ln(s) is about
+// a third of the bits, the relative error of the AGM is scaled up by it.
+static constexpr int32_t AGM_GUARD_LIMBS = 1;
+
+namespace
+{
+    // *pa -= b.
+    void subfx(PNUMBER* pa, PNUMBER b)
+    {
+        b->sign *= -1;
+        addnum(pa, b, BASEX);
+        b->sign *= -1;
+    }
+
+    // Sets the context's fixed point pi and ln(2) to at least limbs digits
+    // past the point, they are only worked out again for more digits.
+    void fxconstants(int32_t limbs)
+    {
+        if (g_ratpack->fx_pi != nullptr && g_ratpack->fx_limbs >= limbs)
+        {
+            return;
+        }
+
+        // ratio+1 digits of the radix are more than one BASEX digit.
+        int32_t precision = (limbs + 1) * (g_ratpack->ratio + 1);
+        PRAT pi = _bspirat(precision);
+        PRAT ln2 = nullptr;
+        DUPRAT(ln2, g_ratpack->rat_two);
+        _lograt(&ln2, precision);
+
+        destroynum(g_ratpack->fx_pi);
+        destroynum(g_ratpack->fx_ln_two);
+        g_ratpack->fx_pi = _rattofx(pi, limbs);
+        g_ratpack->fx_ln_two = _rattofx(ln2, limbs);
+        g_ratpack->fx_limbs = limbs;
+
+        destroyrat(pi);
+        destroyrat(ln2);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _agmfaster
+//
+//  ARGUMENTS: precision in digits of the current radix
+//
+//  RETURN: true when _agmlograt is faster than the series at precision.
+//
+//-----------------------------------------------------------------------------
+
+bool _agmfaster(int32_t precision)
+
+{
+    return _fxlimbs(precision) * BASEXPWR >= AGM_LOG_MIN_BITS;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _agmlograt
+//
+//  ARGUMENTS: x PRAT representation of number to logarithm, at least one.
+//
+//  RETURN: log of x in PRAT form.
+//
+//  EXPLANATION: Works in fixed point with limbs digits past the point.
+//  With s = x 2^m > 2^(bits/2) the AGM error term 1/s^2 is below the
+//  precision and
+//
+//                    pi
+//    ln(x) = ---------------- - m ln(2)
+//            2 AGM(1, 4 / s)
+//
+//  where a = (a + b) / 2 and b = sqrt(a b) are repeated until a and b agree
+//  to half the digits, then (a + b) / 2 is good to all of them.  b starts
+//  near 2^-(bits/2) and is kept to limbs digits of its own until it
+//  catches up with a.  Close to one the log cancels digits, they are made
+//  up with more limbs, and very close the first terms of the series are
+//  enough.
+//
+//-----------------------------------------------------------------------------
+
+void _agmlograt(PRAT* px, int32_t precision)
+
+{
+    int32_t limbs = _fxlimbs(precision) + AGM_GUARD_LIMBS;
+
+    PRAT pd = nullptr;
+    DUPRAT(pd, *px);
+    subrat(&pd, g_ratpack->rat_one, precision);
+    int32_t lz = zernum(pd->pp) ? limbs : max(0, -LOGRAT2(pd));
+    destroyrat(pd);
+    if (4 * lz >= limbs)
+    {
+        _lograt(px, precision + lz * g_ratpack->ratio);
+        return;
+    }
+    limbs += lz;
+
+    int32_t bits = limbs * BASEXPWR;
+    fxconstants(limbs);
+
+    // x > BASEX^(LOGRAT2(x)-1), so s = x 2^m > 2^(bits/2).
+    int32_t m = bits / 2 - (LOGRAT2(*px) - 1) * BASEXPWR;
+
+    // b = 4/s = 2^(2-m) / x
+    PRAT pb = nullptr;
+    createrat(pb);
+    DUPNUM(pb->pp, (*px)->pq);
+    DUPNUM(pb->pq, (*px)->pp);
+    if (m <= 2)
+    {
+        _shlnum(&pb->pp, 2 - m);
+    }
+    else
+    {
+        _shlnum(&pb->pq, m - 2);
+    }
+    PNUMBER b = _rattofx(pb, limbs + limbs / 2 + 2);
+    destroyrat(pb);
+
+    PNUMBER a = i32tonum(1L, BASEX);
+    PNUMBER diff = nullptr;
+    while (true)
+    {
+        DUPNUM(diff, a);
+        subfx(&diff, b);
+        if (zernum(diff) || LOGNUM2(a) - LOGNUM2(diff) > limbs / 2 + 1)
+        {
+            break;
+        }
+
+        PNUMBER ab = nullptr;
+        DUPNUM(ab, a);
+        mulnumx(&ab, b);
+        int32_t blimbs = limbs + max(0, -LOGNUM2(ab)) / 2 + 1;
+        addnum(&a, b, BASEX);
+        _fxdiv(&a, g_ratpack->num_two, blimbs);
+        _fxsqrt(&ab, blimbs);
+        destroynum(b);
+        b = ab;
+    }
+    destroynum(diff);
+
+    // pi / (2 AGM) = pi / (a + b)
+    addnum(&a, b, BASEX);
+    PNUMBER pret = nullptr;
+    DUPNUM(pret, g_ratpack->fx_pi);
+    _fxtrunc(pret, limbs);
+    _fxdiv(&pret, a, limbs);
+
+    PNUMBER pwr = i32tonum(m, BASEX);
+    mulnumx(&pwr, g_ratpack->fx_ln_two);
+    subfx(&pret, pwr);
+
+    destroynum(pwr);
+    destroynum(a);
+    destroynum(b);
+
+    destroyrat(*px);
+    *px = _fxtorat(pret);
+    destroynum(pret);
+    trimit(px, precision);
+}
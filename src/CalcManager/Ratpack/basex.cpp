@@ -14,9 +14,13 @@
 //  internal base is a power of 2.
 //
 //-----------------------------------------------------------------------------
+#include <algorithm>
+#include <vector>
 #include "ratpak.h"
 #include <cstring> // for memmove
 
+using namespace std;
+
 void _mulnumx(PNUMBER* pa, PNUMBER b);
 
 //----------------------------------------------------------------------------
@@ -70,92 +74,103 @@ void __inline mulnumx(PNUMBER* pa, PNUMBER b)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa *= b.
-//    Assumes the base is BASEX of both numbers.  This algorithm is the
-//    same one you learned in grade school, except the base isn't 10 it's
-//    BASEX.
+//    Assumes the base is BASEX of both numbers.  The digit multiply is done
+//    by _mulmant which picks grade school, Karatsuba or Toom-3 based on the
+//    size of the operands.
 //
 //----------------------------------------------------------------------------
 
 void _mulnumx(PNUMBER* pa, PNUMBER b)
 
 {
-    PNUMBER c = nullptr;  // c will contain the result.
-    PNUMBER a = nullptr;  // a is the dereferenced number pointer from *pa
-    MANTTYPE* ptra;       // ptra is a pointer to the mantissa of a.
-    MANTTYPE* ptrb;       // ptrb is a pointer to the mantissa of b.
-    MANTTYPE* ptrc;       // ptrc is a pointer to the mantissa of c.
-    MANTTYPE* ptrcoffset; // ptrcoffset, is the anchor location of the next
-                          // single digit multiply partial result.
-    int32_t iadigit = 0;  // Index of digit being used in the first number.
-    int32_t ibdigit = 0;  // Index of digit being used in the second number.
-    MANTTYPE da = 0;      // da is the digit from the fist number.
-    TWO_MANTTYPE cy = 0;  // cy is the carry resulting from the addition of
-                          // a multiplied row into the result.
-    TWO_MANTTYPE mcy = 0; // mcy is the resultant from a single
-                          // multiply, AND the carry of that multiply.
-    int32_t icdigit = 0;  // Index of digit being calculated in final result.
+    PNUMBER c = nullptr; // c will contain the result.
+    PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
 
     a = *pa;
 
-    ibdigit = a->cdigit + b->cdigit - 1;
-    createnum(c, ibdigit + 1);
-    c->cdigit = ibdigit;
+    createnum(c, a->cdigit + b->cdigit);
+    c->cdigit = a->cdigit + b->cdigit;
     c->sign = a->sign * b->sign;
-
     c->exp = a->exp + b->exp;
-    ptra = a->mant;
-    ptrcoffset = c->mant;
 
-    for (iadigit = a->cdigit; iadigit > 0; iadigit--)
+    _mulmant(c->mant, a->mant, a->cdigit, b->mant, b->cdigit, BASEX);
+
+    // prevent different kinds of zeros, by stripping leading duplicate zeros.
+    // digits are in order of increasing significance.
+    while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
     {
-        da = *ptra++;
-        ptrb = b->mant;
+        c->cdigit--;
+    }
 
-        // Shift ptrc, and ptrcoffset, one for each digit
-        ptrc = ptrcoffset++;
+    // A zero product doesn't keep the exponents of its factors.
+    if (c->cdigit == 1 && c->mant[0] == 0)
+    {
+        c->exp = 0;
+        c->sign = 1;
+    }
 
-        for (ibdigit = b->cdigit; ibdigit > 0; ibdigit--)
+    destroynum(*pa);
+    *pa = c;
+}
+
+namespace
+{
+    // Shifts the trailing zero bits out of the mantissa of a nonzero a,
+    // leaving it odd, and returns the count of bits shifted out.
+    uint32_t shroddnum(PNUMBER a)
+    {
+        int32_t digits = 0;
+        while (a->mant[digits] == 0)
         {
-            cy = 0;
-            mcy = (uint64_t)da * (*ptrb);
-            if (mcy)
-            {
-                icdigit = 0;
-                if (ibdigit == 1 && iadigit == 1)
-                {
-                    c->cdigit++;
-                }
-            }
+            digits++;
+        }
+        uint32_t shift = 0;
+        for (MANTTYPE d = a->mant[digits]; (d & 1) == 0; d >>= 1)
+        {
+            shift++;
+        }
 
-            // If result is nonzero, or while result of carry is nonzero...
-            while (mcy || cy)
+        int32_t cdigit = a->cdigit - digits;
+        for (int32_t i = 0; i < cdigit; i++)
+        {
+            MANTTYPE d = a->mant[i + digits] >> shift;
+            if (shift != 0 && i + 1 < cdigit)
             {
-                // update carry from addition(s) and multiply.
-                cy += (TWO_MANTTYPE)ptrc[icdigit] + ((uint32_t)mcy & ((uint32_t)~BASEX));
-
-                // update result digit from
-                ptrc[icdigit++] = (MANTTYPE)((uint32_t)cy & ((uint32_t)~BASEX));
-
-                // update carries from
-                mcy >>= BASEXPWR;
-                cy >>= BASEXPWR;
+                d |= (a->mant[i + digits + 1] << (BASEXPWR - shift)) & BASEXMAX;
             }
-
-            ptrb++;
-            ptrc++;
+            a->mant[i] = d;
         }
+        a->cdigit = cdigit;
+        while (a->cdigit > 1 && a->mant[a->cdigit - 1] == 0)
+        {
+            a->cdigit--;
+        }
+        return digits * BASEXPWR + shift;
     }
+}
 
-    // prevent different kinds of zeros, by stripping leading duplicate zeros.
-    // digits are in order of increasing significance.
-    while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _powwindow
+//
+//    ARGUMENTS: power as uint32_t
+//
+//    RETURN: The bits of power taken at a time by the sliding window
+//    powers, which keep the odd powers of the root up to 2^window - 1.
+//
+//-----------------------------------------------------------------------------
+
+int32_t _powwindow(uint32_t power)
+
+{
+    int32_t bits = 0;
+    for (; power != 0; power >>= 1)
     {
-        c->cdigit--;
+        bits++;
     }
-
-    destroynum(*pa);
-    *pa = c;
+    return bits > 16 ? 3 : bits > 6 ? 2 : 1;
 }
+
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: numpowi32x
@@ -167,34 +182,98 @@ void _mulnumx(PNUMBER* pa, PNUMBER b)
 //
 //    DESCRIPTION: changes numeric representation of root to
 //    root ** power. Assumes base BASEX
-//    decomposes the exponent into it's sums of powers of 2, so on average
-//    it will take n+n/2 multiplies where n is the highest on bit.
+//    The root is m 2^shift BASEX^exp for an odd m, only m is raised with
+//    multiplies, the rest of the answer is a shift and an exponent so
+//    powers of two and of BASEX cost no multiplies at all.  m is raised
+//    left to right through a sliding window of the bits of power, squaring
+//    once per bit and multiplying by one of the odd powers of m once per
+//    window.
 //
 //-----------------------------------------------------------------------------
 
 void numpowi32x(_Inout_ PNUMBER* proot, _In_ int32_t power)
 
 {
-    PNUMBER lret = i32tonum(1, BASEX);
+    if (power <= 0)
+    {
+        destroynum(*proot);
+        *proot = i32tonum(1, BASEX);
+        return;
+    }
+    if (zernum(*proot))
+    {
+        return;
+    }
+
+    PNUMBER root = *proot;
+    int32_t sign = (power & 1) ? root->sign : 1;
+    int32_t exp = root->exp;
+    uint32_t shift = shroddnum(root);
+    root->sign = 1;
+    root->exp = 0;
+
+    int32_t window = _powwindow(power);
+    vector<PNUMBER> odd((size_t)1 << (window - 1), nullptr);
+    odd[0] = root;
+    if (odd.size() > 1)
+    {
+        PNUMBER square = nullptr;
+        DUPNUM(square, root);
+        mulnumx(&square, square);
+        for (size_t i = 1; i < odd.size(); i++)
+        {
+            DUPNUM(odd[i], odd[i - 1]);
+            mulnumx(&odd[i], square);
+        }
+        destroynum(square);
+    }
 
-    // Once the power remaining is zero we are done.
-    while (power > 0)
+    int32_t bit = 30;
+    while (((power >> bit) & 1) == 0)
     {
-        // If this bit in the power decomposition is on, multiply the result
-        // by the root number.
-        if (power & 1)
+        bit--;
+    }
+
+    PNUMBER lret = nullptr;
+    while (bit >= 0)
+    {
+        if (((power >> bit) & 1) == 0)
         {
-            mulnumx(&lret, *proot);
+            mulnumx(&lret, lret);
+            bit--;
+            continue;
         }
 
-        // multiply the root number by itself to scale for the next bit (i.e.
-        // square it.
-        mulnumx(proot, *proot);
+        // The window runs from this bit down to the lowest one bit at most
+        // window bits below.
+        int32_t low = max(bit - window + 1, 0);
+        while (((power >> low) & 1) == 0)
+        {
+            low++;
+        }
+        int32_t bits = (power >> low) & ((1 << (bit - low + 1)) - 1);
+        if (lret == nullptr)
+        {
+            DUPNUM(lret, odd[bits / 2]);
+        }
+        else
+        {
+            for (int32_t i = low; i <= bit; i++)
+            {
+                mulnumx(&lret, lret);
+            }
+            mulnumx(&lret, odd[bits / 2]);
+        }
+        bit = low - 1;
+    }
 
-        // move the next bit of the power into place.
-        power >>= 1;
+    for (PNUMBER p : odd)
+    {
+        destroynum(p);
     }
-    destroynum(*proot);
+    lret->exp += exp * power;
+    _shlnum(&lret, shift * power);
+    lret->sign = sign;
     *proot = lret;
 }
 
@@ -250,113 +329,14 @@ void __inline divnumx(PNUMBER* pa, PNUMBER b, int32_t precision)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa /= b.
-//    Assumes radix is the internal radix representation.
+//    Assumes radix is the internal radix representation.  The digits are
+//    produced by the division engine in div.cpp.
 //
 //----------------------------------------------------------------------------
 
 void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision)
 
 {
-    PNUMBER a = nullptr;       // a is the dereferenced number pointer from *pa
-    PNUMBER c = nullptr;       // c will contain the result.
-    PNUMBER lasttmp = nullptr; // lasttmp allows a backup when the algorithm
-                               // guesses one bit too far.
-    PNUMBER tmp = nullptr;     // current guess being worked on for divide.
-    PNUMBER rem = nullptr;     // remainder after applying guess.
-    int32_t cdigits;           // count of digits for answer.
-    MANTTYPE* ptrc;            // ptrc is a pointer to the mantissa of c.
-
-    int32_t thismax = precision + g_ratio; // set a maximum number of internal digits
-                                           // to shoot for in the divide.
-
-    a = *pa;
-    if (thismax < a->cdigit)
-    {
-        // a has more digits than precision specified, bump up digits to shoot
-        // for.
-        thismax = a->cdigit;
-    }
-
-    if (thismax < b->cdigit)
-    {
-        // b has more digits than precision specified, bump up digits to shoot
-        // for.
-        thismax = b->cdigit;
-    }
-
-    // Create c (the divide answer) and set up exponent and sign.
-    createnum(c, thismax + 1);
-    c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
-    c->sign = a->sign * b->sign;
-
-    ptrc = c->mant + thismax;
-    cdigits = 0;
-
-    DUPNUM(rem, a);
-    rem->sign = b->sign;
-    rem->exp = b->cdigit + b->exp - rem->cdigit;
-
-    while (cdigits++ < thismax && !zernum(rem))
-    {
-        int32_t digit = 0;
-        *ptrc = 0;
-        while (!lessnum(rem, b))
-        {
-            digit = 1;
-            DUPNUM(tmp, b);
-            destroynum(lasttmp);
-            lasttmp = i32tonum(0, BASEX);
-            while (lessnum(tmp, rem))
-            {
-                destroynum(lasttmp);
-                DUPNUM(lasttmp, tmp);
-                addnum(&tmp, tmp, BASEX);
-                digit *= 2;
-            }
-            if (lessnum(rem, tmp))
-            {
-                // too far, back up...
-                destroynum(tmp);
-                digit /= 2;
-                tmp = lasttmp;
-                lasttmp = nullptr;
-            }
-
-            tmp->sign *= -1;
-            addnum(&rem, tmp, BASEX);
-            destroynum(tmp);
-            destroynum(lasttmp);
-            *ptrc |= digit;
-        }
-        rem->exp++;
-        ptrc--;
-    }
-    cdigits--;
-    if (c->mant != ++ptrc)
-    {
-        memmove(c->mant, ptrc, (int)(cdigits * sizeof(MANTTYPE)));
-    }
-
-    if (!cdigits)
-    {
-        // A zero, make sure no weird exponents creep in
-        c->exp = 0;
-        c->cdigit = 1;
-    }
-    else
-    {
-        c->cdigit = cdigits;
-        c->exp -= cdigits;
-        // prevent different kinds of zeros, by stripping leading duplicate
-        // zeros. digits are in order of increasing significance.
-        while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
-        {
-            c->cdigit--;
-        }
-    }
-
-    destroynum(rem);
-
-    destroynum(*pa);
-    *pa = c;
+    // set a maximum number of internal digits to shoot for in the divide.
+    _divnumdigits(pa, b, BASEX, precision + g_ratpack->ratio);
 }
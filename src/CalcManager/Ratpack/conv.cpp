@@ -21,7 +21,9 @@
 #include <winerror.h>
 #include <sstream>
 #include <cstring> // for memmove, memcpy
+#include <vector>
 #include "ratpak.h"
+#include "mantissa.h"
 
 using namespace std;
 
@@ -30,12 +32,6 @@ static constexpr int MAX_ZEROS_AFTER_DECIMAL = 2;
 // digits 0..64 used by bases 2 .. 64
 static constexpr wstring_view DIGITS = L"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_@";
 
-// ratio of internal 'digits' to output 'digits'
-// Calculated elsewhere as part of initialization and when base is changed
-int32_t g_ratio; // int(log(2L^BASEXPWR)/log(radix))
-// Default decimal separator
-wchar_t g_decimalSeparator = L'.';
-
 // The following defines and Calc_ULong* functions were taken from
 // https://github.com/dotnet/coreclr/blob/8b1595b74c943b33fa794e63e440e6f4c9679478/src/pal/inc/rt/intsafe.h
 // under MIT License
@@ -105,15 +101,7 @@ bool stripzeroesnum(_Inout_ PNUMBER pnum, int32_t starting);
 
 void SetDecimalSeparator(wchar_t decimalSeparator)
 {
-    g_decimalSeparator = decimalSeparator;
-}
-
-//
-// Windows heap allocation
-//
-void* zmalloc(size_t a)
-{
-    return calloc(a, sizeof(unsigned char));
+    g_ratpack->decimalSeparator = decimalSeparator;
 }
 
 //-----------------------------------------------------------------------------
@@ -133,6 +121,60 @@ void _dupnum(_In_ PNUMBER dest, _In_ const NUMBER* const src)
     memcpy(dest, src, (int)(sizeof(NUMBER) + ((src)->cdigit) * (sizeof(MANTTYPE))));
 }
 
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _copynum
+//
+//    ARGUMENTS: pointer to a number pointer, pointer to a number
+//
+//    RETURN: None
+//
+//    DESCRIPTION: Copies the source to the destination, the destination
+//    allocation is kept when it has room for the source digits and is
+//    replaced otherwise.
+//
+//-----------------------------------------------------------------------------
+
+void _copynum(_Inout_ PNUMBER* pdest, _In_ const NUMBER* const src)
+{
+    PNUMBER dest = *pdest;
+    if (dest != nullptr && zsize(dest) >= sizeof(NUMBER) + (src->cdigit + 1) * sizeof(MANTTYPE))
+    {
+        _poolcounters().dupkept++;
+        _dupnum(dest, src);
+        dest->mant[src->cdigit] = 0;
+    }
+    else
+    {
+        destroynum(*pdest);
+        createnum(*pdest, src->cdigit);
+        _dupnum(*pdest, src);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _copyrat
+//
+//    ARGUMENTS: pointer to a rational pointer, pointer to a rational
+//
+//    RETURN: None
+//
+//    DESCRIPTION: Copies the source to the destination reusing the
+//    destination allocations where they are big enough.
+//
+//-----------------------------------------------------------------------------
+
+void _copyrat(_Inout_ PRAT* pdest, _In_ const RAT* const src)
+{
+    if (*pdest == nullptr)
+    {
+        createrat(*pdest);
+    }
+    _copynum(&(*pdest)->pp, src->pp);
+    _copynum(&(*pdest)->pq, src->pq);
+}
+
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: _destroynum
@@ -148,10 +190,7 @@ void _dupnum(_In_ PNUMBER dest, _In_ const NUMBER* const src)
 void _destroynum(_In_ PNUMBER pnum)
 
 {
-    if (pnum != nullptr)
-    {
-        free(pnum);
-    }
+    zfree(pnum);
 }
 
 //-----------------------------------------------------------------------------
@@ -174,7 +213,7 @@ void _destroyrat(_In_ PRAT prat)
     {
         destroynum(prat->pp);
         destroynum(prat->pq);
-        free(prat);
+        zfree(prat);
     }
 }
 
@@ -303,38 +342,20 @@ PRAT numtorat(_In_ PNUMBER pin, uint32_t radix)
 PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
 
 {
-    uint32_t bitmask;
-    uint32_t cdigits;
-    MANTTYPE* ptr;
-
-    PNUMBER sum = i32tonum(0, radix);
-    PNUMBER powofnRadix = i32tonum(BASEX, radix);
+    // BASEX doesn't fit in an int32_t, convert it as the digits { 0, 1 }.
+    static constexpr MANTTYPE basexdigits[] = { 0, 1 };
+    PNUMBER powofnRadix = _basextoradix(basexdigits, 2, radix);
 
     // A large penalty is paid for conversion of digits no one will see anyway.
     // limit the digits to the minimum of the existing precision or the
     // requested precision.
-    cdigits = precision + 1;
-    if (cdigits > (uint32_t)a->cdigit)
-    {
-        cdigits = (uint32_t)a->cdigit;
-    }
+    int32_t cdigits = min(precision + 1, a->cdigit);
 
     // scale by the internal base to the internal exponent offset of the LSD
     numpowi32(&powofnRadix, a->exp + (a->cdigit - cdigits), radix, precision);
 
-    // Loop over all the relative digits from MSD to LSD
-    for (ptr = &(a->mant[a->cdigit - 1]); cdigits > 0; ptr--, cdigits--)
-    {
-        // Loop over all the bits from MSB to LSB
-        for (bitmask = BASEX / 2; bitmask > 0; bitmask /= 2)
-        {
-            addnum(&sum, sum, radix);
-            if (*ptr & bitmask)
-            {
-                sum->mant[0] |= 1;
-            }
-        }
-    }
+    // Convert the kept digits as an integer
+    PNUMBER sum = _basextoradix(a->mant + (a->cdigit - cdigits), cdigits, radix);
 
     // Scale answer by power of internal exponent.
     mulnum(&sum, powofnRadix, radix);
@@ -360,26 +381,9 @@ PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
 
 PNUMBER numtonRadixx(_In_ PNUMBER a, uint32_t radix)
 {
-    PNUMBER pnumret = i32tonum(0, BASEX); // pnumret is the number in internal form.
+    // pnumret is the number in internal form.
+    PNUMBER pnumret = _radixtobasex(a->mant, a->cdigit, radix);
     PNUMBER num_radix = i32tonum(radix, BASEX);
-    MANTTYPE* ptrdigit = a->mant; // pointer to digit being worked on.
-
-    // Digits are in reverse order, back over them LSD first.
-    ptrdigit += a->cdigit - 1;
-
-    PNUMBER thisdigit = nullptr; // thisdigit holds the current digit of a
-                                 // being summed into result.
-    int32_t idigit;              // idigit is the iterate of digits in a.
-    for (idigit = 0; idigit < a->cdigit; idigit++)
-    {
-        mulnumx(&pnumret, num_radix);
-        // WARNING:
-        // This should just smack in each digit into a 'special' thisdigit.
-        // and not do the overhead of recreating the number type each time.
-        thisdigit = i32tonum(*ptrdigit--, BASEX);
-        addnum(&pnumret, thisdigit, BASEX);
-        destroynum(thisdigit);
-    }
 
     // Calculate the exponent of the external base for scaling.
     numpowi32x(&num_radix, a->exp);
@@ -425,12 +429,12 @@ PRAT StringToRat(bool mantissaIsNegative, wstring_view mantissa, bool exponentIs
         if (exponent.empty())
         {
             // Exponent not specified, preset value to zero
-            DUPRAT(resultRat, rat_zero);
+            DUPRAT(resultRat, g_ratpack->rat_zero);
         }
         else
         {
             // Exponent specified, preset value to one
-            DUPRAT(resultRat, rat_one);
+            DUPRAT(resultRat, g_ratpack->rat_one);
         }
     }
     else
@@ -632,7 +636,7 @@ PNUMBER StringToNumber(wstring_view numberString, uint32_t radix, int32_t precis
     for (const auto& c : numberString)
     {
         // If the character is the decimal separator, use L'.' for the purposes of the state machine.
-        curChar = (c == g_decimalSeparator ? L'.' : c);
+        curChar = (c == g_ratpack->decimalSeparator ? L'.' : c);
 
         // Switch states based on the character we encountered
         switch (curChar)
@@ -817,22 +821,35 @@ PNUMBER i32tonum(int32_t ini32, uint32_t radix)
     pmant = pnumret->mant;
     pnumret->cdigit = 0;
     pnumret->exp = 0;
+    // Negated unsigned, INT32_MIN has no positive int32_t.
+    uint32_t value = (uint32_t)ini32;
     if (ini32 < 0)
     {
         pnumret->sign = -1;
-        ini32 *= -1;
+        value = 0 - value;
     }
     else
     {
         pnumret->sign = 1;
     }
 
+    if constexpr (BASEXPWR > 31)
+    {
+        // With full word digits BASEX wraps to 0, any int32_t is one digit.
+        if (radix == BASEX)
+        {
+            *pmant = (MANTTYPE)value;
+            pnumret->cdigit = 1;
+            return (pnumret);
+        }
+    }
+
     do
     {
-        *pmant++ = (MANTTYPE)(ini32 % radix);
-        ini32 /= radix;
+        *pmant++ = (MANTTYPE)(value % radix);
+        value /= radix;
         pnumret->cdigit++;
-    } while (ini32);
+    } while (value);
 
     return (pnumret);
 }
@@ -862,6 +879,17 @@ PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix)
     pnumret->exp = 0;
     pnumret->sign = 1;
 
+    if constexpr (BASEXPWR > 31)
+    {
+        // With full word digits BASEX wraps to 0, any uint32_t is one digit.
+        if (radix == BASEX)
+        {
+            *pmant = (MANTTYPE)ini32;
+            pnumret->cdigit = 1;
+            return (pnumret);
+        }
+    }
+
     do
     {
         *pmant++ = (MANTTYPE)(ini32 % radix);
@@ -888,7 +916,7 @@ PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix)
 
 int32_t rattoi32(_In_ PRAT prat, uint32_t radix, int32_t precision)
 {
-    if (rat_gt(prat, rat_max_i32, precision) || rat_lt(prat, rat_min_i32, precision))
+    if (rat_gt(prat, g_ratpack->rat_max_i32, precision) || rat_lt(prat, g_ratpack->rat_min_i32, precision))
     {
         // Don't attempt rattoi32 of anything too big or small
         throw(CALC_E_DOMAIN);
@@ -899,7 +927,7 @@ int32_t rattoi32(_In_ PRAT prat, uint32_t radix, int32_t precision)
 
     intrat(&pint, radix, precision);
     divnumx(&(pint->pp), pint->pq, precision);
-    DUPNUM(pint->pq, num_one);
+    DUPNUM(pint->pq, g_ratpack->num_one);
 
     int32_t lret = numtoi32(pint->pp, BASEX);
 
@@ -923,7 +951,7 @@ int32_t rattoi32(_In_ PRAT prat, uint32_t radix, int32_t precision)
 //-----------------------------------------------------------------------------
 uint32_t rattoUi32(_In_ PRAT prat, uint32_t radix, int32_t precision)
 {
-    if (rat_gt(prat, rat_dword, precision) || rat_lt(prat, rat_zero, precision))
+    if (rat_gt(prat, g_ratpack->rat_dword, precision) || rat_lt(prat, g_ratpack->rat_zero, precision))
     {
         // Don't attempt rattoui32 of anything too big or small
         throw(CALC_E_DOMAIN);
@@ -934,7 +962,7 @@ uint32_t rattoUi32(_In_ PRAT prat, uint32_t radix, int32_t precision)
 
     intrat(&pint, radix, precision);
     divnumx(&(pint->pp), pint->pq, precision);
-    DUPNUM(pint->pq, num_one);
+    DUPNUM(pint->pq, g_ratpack->num_one);
 
     uint32_t lret = numtoi32(pint->pp, BASEX); // This happens to work even if it is only signed
 
@@ -964,14 +992,14 @@ uint64_t rattoUi64(_In_ PRAT prat, uint32_t radix, int32_t precision)
 
     // first get the LO 32 bit word
     DUPRAT(pint, prat);
-    andrat(&pint, rat_dword, radix, precision);      // & 0xFFFFFFFF   (2 ^ 32 -1)
-    uint32_t lo = rattoUi32(pint, radix, precision); // wont throw exception because already hi-dword chopped off
+    andrat(&pint, g_ratpack->rat_dword, radix, precision); // & 0xFFFFFFFF   (2 ^ 32 -1)
+    uint32_t lo = rattoUi32(pint, radix, precision);       // wont throw exception because already hi-dword chopped off
 
     DUPRAT(pint, prat); // previous pint will get freed by this as well
     PRAT prat32 = i32torat(32);
     rshrat(&pint, prat32, radix, precision);
     intrat(&pint, radix, precision);
-    andrat(&pint, rat_dword, radix, precision); // & 0xFFFFFFFF   (2 ^ 32 -1)
+    andrat(&pint, g_ratpack->rat_dword, radix, precision); // & 0xFFFFFFFF   (2 ^ 32 -1)
     uint32_t hi = rattoUi32(pint, radix, precision);
 
     destroyrat(prat32);
@@ -1000,6 +1028,8 @@ int32_t numtoi32(_In_ PNUMBER pnum, uint32_t radix)
     MANTTYPE* pmant = pnum->mant;
     pmant += pnum->cdigit - 1;
 
+    // With full word digits BASEX wraps to 0, that is still the right
+    // multiplier modulo 2^32.
     int32_t expt = pnum->exp;
     for (int32_t length = pnum->cdigit; length > 0 && length + expt > 0; length--)
     {
@@ -1108,7 +1138,7 @@ wstring NumberToString(_Inout_ PNUMBER& pnum, int format, uint32_t radix, int32_
     {
         // Otherwise round.
         round = i32tonum(radix, radix);
-        divnum(&round, num_two, radix, precision);
+        divnum(&round, g_ratpack->num_two, radix, precision);
 
         // Make round number exponent one below the LSD for the number.
         if (exponent > 0 || format == FMT_FLOAT)
@@ -1213,7 +1243,7 @@ wstring NumberToString(_Inout_ PNUMBER& pnum, int format, uint32_t radix, int32_
     if (exponent <= 0 && !useSciForm)
     {
         resultStream << L'0';
-        resultStream << g_decimalSeparator;
+        resultStream << g_ratpack->decimalSeparator;
         // Used up a digit unaccounted for.
     }
 
@@ -1232,7 +1262,7 @@ wstring NumberToString(_Inout_ PNUMBER& pnum, int format, uint32_t radix, int32_
         // Be more regular in using a decimal point.
         if (exponent == 0)
         {
-            resultStream << g_decimalSeparator;
+            resultStream << g_ratpack->decimalSeparator;
         }
     }
 
@@ -1243,7 +1273,7 @@ wstring NumberToString(_Inout_ PNUMBER& pnum, int format, uint32_t radix, int32_
         // Be more regular in using a decimal point.
         if (exponent == 0)
         {
-            resultStream << g_decimalSeparator;
+            resultStream << g_ratpack->decimalSeparator;
         }
     }
 
@@ -1268,7 +1298,7 @@ wstring NumberToString(_Inout_ PNUMBER& pnum, int format, uint32_t radix, int32_
 
     // Remove trailing decimal
     auto resultString = resultStream.str();
-    if (!resultString.empty() && resultString.back() == g_decimalSeparator)
+    if (!resultString.empty() && resultString.back() == g_ratpack->decimalSeparator)
     {
         resultString.pop_back();
     }
@@ -1340,6 +1370,114 @@ void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision)
     destroynum(pnum);
 }
 
+// Signed accumulator for a Lehmer update, it holds the sum of two cofactor *
+// digit products.
+#if RATPAK_LIMB_BITS == 64
+typedef __int128 LEHMERTYPE;
+#else
+typedef int64_t LEHMERTYPE;
+#endif
+
+// Cofactor bound for a Lehmer step, keeps cofactor * digit products and their
+// sums well inside a LEHMERTYPE.
+static constexpr int64_t LEHMER_COFACTOR_LIMIT = 1LL << (BASEXPWR == 64 ? 30 : 61 - BASEXPWR);
+
+// Number of leading bits of the larger operand a Lehmer step looks at.
+static constexpr int32_t LEHMER_BITS = 60;
+
+namespace
+{
+    // Number of significant bits in the normalized mantissa a.
+    int32_t bitlength(const vector<MANTTYPE>& a)
+    {
+        if (a.empty())
+        {
+            return 0;
+        }
+        int32_t bits = (int32_t)BASEXPWR * ((int32_t)a.size() - 1);
+        for (MANTTYPE top = a.back(); top != 0; top >>= 1)
+        {
+            bits++;
+        }
+        return bits;
+    }
+
+    // Returns a >> shift bits, the result must fit in 64 bits.
+    uint64_t topbits(const vector<MANTTYPE>& a, int32_t shift)
+    {
+        uint64_t result = 0;
+        for (size_t k = shift / (int32_t)BASEXPWR; k < a.size(); k++)
+        {
+            int32_t bits = (int32_t)(BASEXPWR * k) - shift;
+            if (bits < 0)
+            {
+                result |= (uint64_t)a[k] >> -bits;
+            }
+            else if (bits < 64)
+            {
+                result |= (uint64_t)a[k] << bits;
+            }
+        }
+        return result;
+    }
+
+    uint64_t binarygcd(uint64_t u, uint64_t v)
+    {
+        if (u == 0 || v == 0)
+        {
+            return u | v;
+        }
+
+        int32_t shift = 0;
+        while (((u | v) & 1) == 0)
+        {
+            u >>= 1;
+            v >>= 1;
+            shift++;
+        }
+        while ((u & 1) == 0)
+        {
+            u >>= 1;
+        }
+        do
+        {
+            while ((v & 1) == 0)
+            {
+                v >>= 1;
+            }
+            if (u > v)
+            {
+                swap(u, v);
+            }
+            v -= u;
+        } while (v != 0);
+
+        return u << shift;
+    }
+
+    // (u, v) = (a*u + b*v, c*u + d*v), the cofactors come from a Lehmer step
+    // so both results are non negative and no larger than u.
+    void lehmerupdate(vector<MANTTYPE>& u, vector<MANTTYPE>& v, int64_t a, int64_t b, int64_t c, int64_t d)
+    {
+        size_t n = u.size();
+        v.resize(n, 0);
+        const LEHMERTYPE radix = (LEHMERTYPE)1 << BASEXPWR;
+        LEHMERTYPE cyu = 0;
+        LEHMERTYPE cyv = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            LEHMERTYPE tu = (LEHMERTYPE)a * u[i] + (LEHMERTYPE)b * v[i] + cyu;
+            LEHMERTYPE tv = (LEHMERTYPE)c * u[i] + (LEHMERTYPE)d * v[i] + cyv;
+            u[i] = (MANTTYPE)(tu & BASEXMAX);
+            v[i] = (MANTTYPE)(tv & BASEXMAX);
+            cyu = (tu - u[i]) / radix;
+            cyv = (tv - v[i]) / radix;
+        }
+        u.resize(_mantlen(u.data(), (int32_t)n));
+        v.resize(_mantlen(v.data(), (int32_t)n));
+    }
+}
+
 //-----------------------------------------------------------------------------
 //
 //  FUNCTION: gcd
@@ -1347,56 +1485,111 @@ void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision)
 //  ARGUMENTS:
 //              PNUMBER representation of a number.
 //              PNUMBER representation of a number.
-//              int for Radix
 //
-//  RETURN: Greatest common divisor in internal BASEX PNUMBER form.
+//  RETURN: Greatest common divisor in internal BASEX PNUMBER form, always a
+//          new number.
 //
-//  DESCRIPTION: gcd uses remainders to find the greatest common divisor.
+//  DESCRIPTION: gcd uses Lehmer's algorithm on the BASEX mantissas. Each
+//  step runs Euclid on the leading 60 bits of both operands in single
+//  precision, collecting the cofactors, and then applies them to the full
+//  numbers in one linear pass. When the leading bits can't decide the next
+//  quotient a full remainder step is taken instead, and once both operands
+//  fit in 64 bits a binary gcd finishes the job.
 //
 //  ASSUMPTIONS: gcd assumes inputs are integers.
 //
-//  NOTE: Before it was found that the TRIM macro actually kept the
-//        size down cheaper than GCD, this routine was used extensively.
-//        now it is not used but might be later.
-//
 //-----------------------------------------------------------------------------
 
 PNUMBER gcd(_In_ PNUMBER a, _In_ PNUMBER b)
 {
-    PNUMBER r = nullptr;
-    PNUMBER larger = nullptr;
-    PNUMBER smaller = nullptr;
-
-    if (zernum(a))
+    PNUMBER result = nullptr;
+
+    // Line both numbers up on the smaller exponent.
+    int32_t exp = min(a->exp, b->exp);
+    vector<MANTTYPE> u(a->cdigit + a->exp - exp, 0);
+    vector<MANTTYPE> v(b->cdigit + b->exp - exp, 0);
+    memcpy(u.data() + a->exp - exp, a->mant, a->cdigit * sizeof(MANTTYPE));
+    memcpy(v.data() + b->exp - exp, b->mant, b->cdigit * sizeof(MANTTYPE));
+    u.resize(_mantlen(u.data(), (int32_t)u.size()));
+    v.resize(_mantlen(v.data(), (int32_t)v.size()));
+
+    while (true)
     {
-        return b;
-    }
-    else if (zernum(b))
-    {
-        return a;
-    }
+        if (_mantcmp(u.data(), (int32_t)u.size(), v.data(), (int32_t)v.size()) < 0)
+        {
+            u.swap(v);
+        }
+        if (v.empty())
+        {
+            break;
+        }
 
-    if (lessnum(a, b))
-    {
-        DUPNUM(larger, b);
-        DUPNUM(smaller, a);
-    }
-    else
-    {
-        DUPNUM(larger, a);
-        DUPNUM(smaller, b);
-    }
+        int32_t bits = bitlength(u);
+        if (bits <= 64)
+        {
+            uint64_t g = binarygcd(topbits(u, 0), topbits(v, 0));
+            u.clear();
+            for (; g != 0; g = (uint64_t)((TWO_MANTTYPE)g >> BASEXPWR))
+            {
+                u.push_back((MANTTYPE)(g & BASEXMAX));
+            }
+            break;
+        }
 
-    while (!zernum(smaller))
-    {
-        remnum(&larger, smaller, BASEX);
-        // swap larger and smaller
-        r = larger;
-        larger = smaller;
-        smaller = r;
+        // Run Euclid on the leading bits while the quotients they give are
+        // certain to be the quotients of the full numbers (Knuth's
+        // Algorithm L).
+        int32_t shift = bits - LEHMER_BITS;
+        int64_t uh = (int64_t)topbits(u, shift);
+        int64_t vh = (int64_t)topbits(v, shift);
+        int64_t ca = 1;
+        int64_t cb = 0;
+        int64_t cc = 0;
+        int64_t cd = 1;
+        while (vh + cc > 0 && vh + cd > 0 && uh + ca >= 0 && uh + cb >= 0)
+        {
+            int64_t q = (uh + ca) / (vh + cc);
+            if (q != (uh + cb) / (vh + cd) || q >= LEHMER_COFACTOR_LIMIT)
+            {
+                break;
+            }
+            int64_t nc = ca - q * cc;
+            int64_t nd = cb - q * cd;
+            if (nc <= -LEHMER_COFACTOR_LIMIT || nc >= LEHMER_COFACTOR_LIMIT || nd <= -LEHMER_COFACTOR_LIMIT || nd >= LEHMER_COFACTOR_LIMIT)
+            {
+                break;
+            }
+            ca = cc;
+            cc = nc;
+            cb = cd;
+            cd = nd;
+            int64_t nv = uh - q * vh;
+            uh = vh;
+            vh = nv;
+        }
+
+        if (cb == 0)
+        {
+            // The leading bits couldn't tell, do a full remainder step.
+            vector<MANTTYPE> q(u.size() - v.size() + 1);
+            vector<MANTTYPE> r(v.size());
+            _divmant(q.data(), r.data(), u.data(), (int32_t)u.size(), v.data(), (int32_t)v.size(), BASEX);
+            r.resize(_mantlen(r.data(), (int32_t)r.size()));
+            u.swap(v);
+            v.swap(r);
+        }
+        else
+        {
+            lehmerupdate(u, v, ca, cb, cc, cd);
+        }
     }
-    destroynum(smaller);
-    return larger;
+
+    createnum(result, max((int32_t)u.size(), 1));
+    result->cdigit = max((int32_t)u.size(), 1);
+    result->exp = u.empty() ? 0 : exp;
+    result->sign = 1;
+    memcpy(result->mant, u.data(), u.size() * sizeof(MANTTYPE));
+    return result;
 }
 
 //-----------------------------------------------------------------------------
@@ -1506,7 +1699,10 @@ void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t pr
 //    RETURN: None root is changed.
 //
 //    DESCRIPTION: changes rational representation of root to
-//    root ** power.
+//    root ** power.  A root with a denominator of one is raised exactly
+//    by numpowi32x, any other is raised left to right through a sliding
+//    window of the bits of power like numpowi32x does, trimmed to
+//    precision along the way.
 //
 //-----------------------------------------------------------------------------
 
@@ -1522,25 +1718,74 @@ void ratpowi32(_Inout_ PRAT* proot, int32_t power, int32_t precision)
         (*proot)->pp = (*proot)->pq;
         (*proot)->pq = pnumtemp;
     }
+    else if (power == 0)
+    {
+        destroyrat(*proot);
+        *proot = i32torat(1);
+    }
+    else if ((*proot)->pq->sign == 1 && equnum((*proot)->pq, g_ratpack->num_one))
+    {
+        numpowi32x(&((*proot)->pp), power);
+    }
     else
     {
-        PRAT lret = nullptr;
+        int32_t window = _powwindow(power);
+        vector<PRAT> odd((size_t)1 << (window - 1), nullptr);
+        odd[0] = *proot;
+        if (odd.size() > 1)
+        {
+            PRAT square = nullptr;
+            DUPRAT(square, *proot);
+            mulrat(&square, square, precision);
+            for (size_t i = 1; i < odd.size(); i++)
+            {
+                DUPRAT(odd[i], odd[i - 1]);
+                mulrat(&odd[i], square, precision);
+            }
+            destroyrat(square);
+        }
 
-        lret = i32torat(1);
+        int32_t bit = 30;
+        while (((power >> bit) & 1) == 0)
+        {
+            bit--;
+        }
 
-        while (power > 0)
+        PRAT lret = nullptr;
+        while (bit >= 0)
         {
-            if (power & 1)
+            if (((power >> bit) & 1) == 0)
             {
-                mulnumx(&(lret->pp), (*proot)->pp);
-                mulnumx(&(lret->pq), (*proot)->pq);
+                mulrat(&lret, lret, precision);
+                bit--;
+                continue;
             }
-            mulrat(proot, *proot, precision);
-            trimit(&lret, precision);
-            trimit(proot, precision);
-            power >>= 1;
+
+            int32_t low = max(bit - window + 1, 0);
+            while (((power >> low) & 1) == 0)
+            {
+                low++;
+            }
+            int32_t bits = (power >> low) & ((1 << (bit - low + 1)) - 1);
+            if (lret == nullptr)
+            {
+                DUPRAT(lret, odd[bits / 2]);
+            }
+            else
+            {
+                for (int32_t i = low; i <= bit; i++)
+                {
+                    mulrat(&lret, lret, precision);
+                }
+                mulrat(&lret, odd[bits / 2], precision);
+            }
+            bit = low - 1;
+        }
+
+        for (PRAT p : odd)
+        {
+            destroyrat(p);
         }
-        destroyrat(*proot);
         *proot = lret;
     }
 }
@@ -0,0 +1,402 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           div.cpp
+//
+//
+//  Description
+//
+//     Contains the mantissa division engine used by divnum, divnumx and
+//  remnum.  Single digit divisors use short division, mid sized operands
+//  use Knuth's Algorithm D and large ones multiply by a Newton-Raphson
+//  reciprocal, riding on the fast multiply in mul.cpp.  The quotient is
+//  always corrected against the exact remainder so the result is exact.
+//
+//-----------------------------------------------------------------------------
+#include <vector>
+#include "ratpak.h"
+#include "mantissa.h"
+
+using namespace std;
+
+// Both the quotient and the divisor need at least this many digits before
+// the Newton reciprocal beats Algorithm D.
+static constexpr int32_t NEWTON_THRESHOLD = 200;
+
+// Reciprocals with at most this many digits are computed directly.
+static constexpr int32_t NEWTON_BASE = 64;
+
+// The Newton quotient is at most a couple of units off, if it is ever further
+// out than this something is wrong and we fall back to Algorithm D.
+static constexpr int32_t MAX_QUOTIENT_CORRECTION = 8;
+
+namespace
+{
+    // q = u / d, r = u % d for a single digit d.
+    template <typename T>
+    MANTTYPE divshort(const T& t, MANTTYPE* q, const MANTTYPE* u, int32_t nu, MANTTYPE d)
+    {
+        TWO_MANTTYPE rem = 0;
+        for (int32_t i = nu - 1; i >= 0; i--)
+        {
+            rem = rem * t.radix() + u[i];
+            q[i] = (MANTTYPE)(rem / d);
+            rem %= d;
+        }
+        return (MANTTYPE)rem;
+    }
+
+    // Knuth's Algorithm D, q gets nu - nv + 1 digits and r, if not null,
+    // gets nv digits. v must be at least two digits with a nonzero top digit.
+    template <typename T>
+    void divknuth(const T& t, MANTTYPE* q, MANTTYPE* r, const MANTTYPE* u, int32_t nu, const MANTTYPE* v, int32_t nv)
+    {
+        const TWO_MANTTYPE radix = t.radix();
+
+        // Normalize so the top digit of the divisor is at least radix/2,
+        // that keeps the trial quotient within two of the real digit.
+        MANTTYPE d = (MANTTYPE)(radix / ((TWO_MANTTYPE)v[nv - 1] + 1));
+        vector<MANTTYPE> vn(nv);
+        vector<MANTTYPE> un(nu + 1);
+        TWO_MANTTYPE cy = 0;
+        for (int32_t i = 0; i < nv; i++)
+        {
+            cy += (TWO_MANTTYPE)v[i] * d;
+            vn[i] = t.lo(cy);
+            cy = t.hi(cy);
+        }
+        cy = 0;
+        for (int32_t i = 0; i < nu; i++)
+        {
+            cy += (TWO_MANTTYPE)u[i] * d;
+            un[i] = t.lo(cy);
+            cy = t.hi(cy);
+        }
+        un[nu] = (MANTTYPE)cy;
+
+        const TWO_MANTTYPE vtop = vn[nv - 1];
+        const TWO_MANTTYPE vnext = vn[nv - 2];
+        for (int32_t j = nu - nv; j >= 0; j--)
+        {
+            TWO_MANTTYPE num = (TWO_MANTTYPE)un[j + nv] * radix + un[j + nv - 1];
+            TWO_MANTTYPE qhat = num / vtop;
+            TWO_MANTTYPE rhat = num % vtop;
+            while (qhat >= radix || qhat * vnext > rhat * radix + un[j + nv - 2])
+            {
+                qhat--;
+                rhat += vtop;
+                if (rhat >= radix)
+                {
+                    break;
+                }
+            }
+
+            // un[j..j+nv] -= qhat * vn
+            TWO_MANTTYPE mcy = 0;
+            MANTTYPE borrow = 0;
+            for (int32_t i = 0; i <= nv; i++)
+            {
+                if (i < nv)
+                {
+                    mcy += qhat * vn[i];
+                }
+                TWO_MANTTYPE sub = (TWO_MANTTYPE)t.lo(mcy) + borrow;
+                mcy = t.hi(mcy);
+                if (un[i + j] >= sub)
+                {
+                    un[i + j] = (MANTTYPE)(un[i + j] - sub);
+                    borrow = 0;
+                }
+                else
+                {
+                    un[i + j] = (MANTTYPE)(radix + un[i + j] - sub);
+                    borrow = 1;
+                }
+            }
+
+            if (borrow)
+            {
+                // The trial quotient was one too big, add back.
+                qhat--;
+                _mantaddto(t, &un[j], nv + 1, vn.data(), nv);
+                un[j + nv] = 0;
+            }
+            q[j] = (MANTTYPE)qhat;
+        }
+
+        if (r != nullptr)
+        {
+            divshort(t, r, un.data(), nv, d);
+        }
+    }
+
+    template <typename T>
+    void divdigits(const T& t, MANTTYPE* q, MANTTYPE* r, const MANTTYPE* u, int32_t nu, const MANTTYPE* v, int32_t nv);
+
+    // x ~= radix^(m+p) / w, where w has m digits and a nonzero top digit.
+    // Only the top p+2 digits of w matter at this precision. Each Newton step
+    // doubles the number of correct digits:
+    //     x1 = x0 + x0 * (radix^(m+p) - w * x0) / radix^(m+p)
+    template <typename T>
+    void reciprocal(const T& t, uint32_t radix, vector<MANTTYPE>& x, const MANTTYPE* w, int32_t m, int32_t p)
+    {
+        if (m > p + 2)
+        {
+            w += m - (p + 2);
+            m = p + 2;
+        }
+
+        if (p <= NEWTON_BASE)
+        {
+            vector<MANTTYPE> u(m + p + 1, 0);
+            u[m + p] = 1;
+            x.assign(p + 2, 0);
+            divdigits(t, x.data(), nullptr, u.data(), m + p + 1, w, m);
+            x.resize(_mantlen(x.data(), p + 2));
+            return;
+        }
+
+        int32_t h = p / 2 + 2;
+        vector<MANTTYPE> x0;
+        reciprocal(t, radix, x0, w, m, h);
+        int32_t nx0 = (int32_t)x0.size();
+
+        // e = |radix^(m+h) - w * x0|
+        int32_t ne = max(m + nx0, m + h + 1);
+        vector<MANTTYPE> e(ne, 0);
+        _mulmant(e.data(), w, m, x0.data(), nx0, radix);
+        vector<MANTTYPE> one(m + h + 1, 0);
+        one[m + h] = 1;
+        bool negative = _mantcmp(e.data(), ne, one.data(), m + h + 1) > 0;
+        if (negative)
+        {
+            _mantsubfrom(t, e.data(), ne, one.data(), m + h + 1);
+        }
+        else
+        {
+            one.resize(ne, 0);
+            _mantsubfrom(t, one.data(), ne, e.data(), ne);
+            e.swap(one);
+        }
+        ne = _mantlen(e.data(), ne);
+
+        // x = x0 * radix^(p-h) +/- x0 * e / radix^(m+2h-p)
+        int32_t shift = m + 2 * h - p;
+        int32_t nx = nx0 + p - h + 1;
+        x.assign(nx, 0);
+        memcpy(x.data() + (p - h), x0.data(), nx0 * sizeof(MANTTYPE));
+        if (ne > 0)
+        {
+            vector<MANTTYPE> corr(nx0 + ne, 0);
+            _mulmant(corr.data(), x0.data(), nx0, e.data(), ne, radix);
+            int32_t ncorr = nx0 + ne > shift ? _mantlen(corr.data() + shift, nx0 + ne - shift) : 0;
+            if (negative)
+            {
+                _mantsubfrom(t, x.data(), nx, corr.data() + shift, ncorr);
+            }
+            else
+            {
+                _mantaddto(t, x.data(), nx, corr.data() + shift, ncorr);
+            }
+        }
+        x.resize(_mantlen(x.data(), nx));
+    }
+
+    // Division by multiplying with a Newton reciprocal of v, the estimated
+    // quotient is then fixed up against the exact remainder. Returns false
+    // if the estimate was unexpectedly far off.
+    template <typename T>
+    bool divnewton(const T& t, MANTTYPE* q, MANTTYPE* r, const MANTTYPE* u, int32_t nu, const MANTTYPE* v, int32_t nv)
+    {
+        const uint32_t radix = (uint32_t)t.radix();
+        int32_t nq = nu - nv + 1;
+        int32_t p = nq + 2;
+        int32_t m = min(nv, p + 2);
+
+        // q ~= (u / radix^(nv-m)) * x / radix^(m+p)
+        vector<MANTTYPE> x;
+        reciprocal(t, radix, x, v + nv - m, m, p);
+        int32_t nx = (int32_t)x.size();
+        int32_t nut = nu - (nv - m);
+        vector<MANTTYPE> prod(nut + nx, 0);
+        _mulmant(prod.data(), u + (nv - m), nut, x.data(), nx, radix);
+
+        vector<MANTTYPE> qest(nq + 1, 0);
+        int32_t nqest = min(nq + 1, max(0, nut + nx - (m + p)));
+        memcpy(qest.data(), prod.data() + (m + p), nqest * sizeof(MANTTYPE));
+
+        // rem = u - qest * v, walked into 0 <= rem < v
+        int32_t nrem = nu + 2;
+        vector<MANTTYPE> qv(nq + 1 + nv, 0);
+        _mulmant(qv.data(), qest.data(), nq + 1, v, nv, radix);
+        vector<MANTTYPE> rem(nrem, 0);
+        memcpy(rem.data(), u, nu * sizeof(MANTTYPE));
+        vector<MANTTYPE> unit(1, 1);
+        int32_t steps = 0;
+        while (_mantcmp(qv.data(), nq + 1 + nv, rem.data(), nrem) > 0)
+        {
+            if (++steps > MAX_QUOTIENT_CORRECTION)
+            {
+                return false;
+            }
+            _mantsubfrom(t, qest.data(), nq + 1, unit.data(), 1);
+            _mantsubfrom(t, qv.data(), nq + 1 + nv, v, nv);
+        }
+        _mantsubfrom(t, rem.data(), nrem, qv.data(), _mantlen(qv.data(), nq + 1 + nv));
+        while (_mantcmp(rem.data(), nrem, v, nv) >= 0)
+        {
+            if (++steps > MAX_QUOTIENT_CORRECTION)
+            {
+                return false;
+            }
+            _mantaddto(t, qest.data(), nq + 1, unit.data(), 1);
+            _mantsubfrom(t, rem.data(), nrem, v, nv);
+        }
+
+        memcpy(q, qest.data(), nq * sizeof(MANTTYPE));
+        if (r != nullptr)
+        {
+            memcpy(r, rem.data(), nv * sizeof(MANTTYPE));
+        }
+        return true;
+    }
+
+    template <typename T>
+    void divdigits(const T& t, MANTTYPE* q, MANTTYPE* r, const MANTTYPE* u, int32_t nu, const MANTTYPE* v, int32_t nv)
+    {
+        if (nv == 1)
+        {
+            MANTTYPE rem = divshort(t, q, u, nu, v[0]);
+            if (r != nullptr)
+            {
+                r[0] = rem;
+            }
+        }
+        else if (nv < NEWTON_THRESHOLD || nu - nv + 1 < NEWTON_THRESHOLD || !divnewton(t, q, r, u, nu, v, nv))
+        {
+            divknuth(t, q, r, u, nu, v, nv);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _divmant
+//
+//    ARGUMENTS: pointers to the quotient and remainder mantissas, the
+//               dividend and divisor mantissas with their digit counts, and
+//               the radix.
+//
+//    RETURN: None, fills in the quotient and remainder.
+//
+//    DESCRIPTION: Does q = u / v and r = u % v on raw mantissas. v must not
+//    have leading zero digits.  q must have room for cdigitu - cdigitv + 1
+//    digits (at least one), r may be null, otherwise it must have room for
+//    cdigitv digits.
+//
+//----------------------------------------------------------------------------
+
+void _divmant(
+    _Out_ MANTTYPE* q,
+    _Out_opt_ MANTTYPE* r,
+    _In_ const MANTTYPE* u,
+    int32_t cdigitu,
+    _In_ const MANTTYPE* v,
+    int32_t cdigitv,
+    uint32_t radix)
+
+{
+    if (_mantlen(v, cdigitv) == 0)
+    {
+        throw(CALC_E_DIVIDEBYZERO);
+    }
+
+    if (cdigitu < cdigitv)
+    {
+        q[0] = 0;
+        if (r != nullptr)
+        {
+            memset(r, 0, cdigitv * sizeof(MANTTYPE));
+            memcpy(r, u, cdigitu * sizeof(MANTTYPE));
+        }
+    }
+    else if (radix == BASEX)
+    {
+        divdigits(BASEXDIGITS{}, q, r, u, cdigitu, v, cdigitv);
+    }
+    else
+    {
+        divdigits(RADIXDIGITS{ radix }, q, r, u, cdigitu, v, cdigitv);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _divnumdigits
+//
+//    ARGUMENTS: pointer to a number, a second number, the radix and the
+//               number of quotient digits to shoot for.
+//
+//    RETURN: None, changes first pointer.
+//
+//    DESCRIPTION: Does the number equivalent of *pa /= b.  Quotient digits
+//    are produced from the most significant one down, stopping after
+//    thismax digits (or more if a or b has more digits) or as soon as the
+//    division is exact.
+//
+//----------------------------------------------------------------------------
+
+void _divnumdigits(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t thismax)
+
+{
+    PNUMBER a = *pa;     // a is the dereferenced number pointer from *pa
+    PNUMBER c = nullptr; // c will contain the result.
+
+    thismax = max(thismax, max(a->cdigit, b->cdigit));
+
+    // Create c (the divide answer) and set up exponent and sign.
+    createnum(c, thismax + 1);
+    c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
+    c->sign = a->sign * b->sign;
+
+    if (zernum(a))
+    {
+        // A zero, make sure no weird exponents creep in
+        c->exp = 0;
+        c->cdigit = 1;
+    }
+    else
+    {
+        // Shift a up so the integer quotient has exactly thismax digits.
+        int32_t shift = thismax - a->cdigit + b->cdigit - 1;
+        vector<MANTTYPE> u(a->cdigit + shift, 0);
+        vector<MANTTYPE> rem(b->cdigit, 0);
+        memcpy(u.data() + shift, a->mant, a->cdigit * sizeof(MANTTYPE));
+        _divmant(c->mant, rem.data(), u.data(), a->cdigit + shift, b->mant, b->cdigit, radix);
+
+        // An exact quotient doesn't get trailing zeros.
+        int32_t low = 0;
+        if (_mantlen(rem.data(), b->cdigit) == 0)
+        {
+            while (c->mant[low] == 0)
+            {
+                low++;
+            }
+            memmove(c->mant, c->mant + low, (thismax - low) * sizeof(MANTTYPE));
+        }
+
+        c->cdigit = thismax - low;
+        c->exp -= c->cdigit;
+        // prevent different kinds of zeros, by stripping leading duplicate
+        // zeros. digits are in order of increasing significance.
+        while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
+        {
+            c->cdigit--;
+        }
+    }
+
+    destroynum(*pa);
+    *pa = c;
+}
@@ -14,8 +14,69 @@
 //
 //
 //-----------------------------------------------------------------------------
+#include <cmath>
 #include "ratpak.h"
 
+using namespace std;
+
+// The taylor series of exp is summed for x/2^k and squared k times, with k
+// EXP_SQUARINGS_SCALE * sqrt(bits of precision).  Every squaring saves
+// about as many terms as k gets smaller by and a term costs about what a
+// squaring does, so k goes with the square root.
+static constexpr double EXP_SQUARINGS_SCALE = 1.0;
+
+namespace
+{
+    // The squarings exp takes at precision.
+    int32_t squarings(int32_t precision)
+    {
+        return (int32_t)(EXP_SQUARINGS_SCALE * sqrt((double)_fxlimbs(precision) * BASEXPWR));
+    }
+
+    // precision widened by whole BASEX digits to cover bits more bits.
+    int32_t widenprecision(int32_t precision, int32_t bits)
+    {
+        return precision + (bits / BASEXPWR + 1) * g_ratpack->ratio;
+    }
+
+    // log2(abs(a)) from its top two digits.
+    double log2top(PNUMBER a)
+    {
+        double top = (double)a->mant[a->cdigit - 1];
+        if (a->cdigit > 1)
+        {
+            top += (double)a->mant[a->cdigit - 2] / ldexp(1.0, BASEXPWR);
+        }
+        return (double)(a->cdigit - 1 + a->exp) * BASEXPWR + log2(top);
+    }
+
+    // exp(x 2^-k)^(2^k) by the taylor series, at a precision already
+    // widened for the squarings.
+    void exptaylor(PRAT* px, int32_t k, int32_t precision)
+    {
+        _shlnum(&(*px)->pq, k);
+
+        CREATETAYLOR();
+
+        DUPNUM(pret, g_ratpack->num_one);
+        DUPNUM(thisterm, pret);
+
+        n2 = i32tonum(0L, BASEX);
+
+        do
+        {
+            NEXTTERM(x, INC(n2) DIVNUM(n2), precision);
+        } while (!SMALL_ENOUGH_NUM(thisterm, precision));
+
+        for (int32_t i = 0; i < k; i++)
+        {
+            _fxmul(&pret, pret, limbs);
+        }
+
+        DESTROYTAYLOR();
+    }
+}
+
 //-----------------------------------------------------------------------------
 //
 //  FUNCTION: exprat
@@ -37,25 +98,26 @@
 //   thisterm  = X ;  and stop when thisterm < precision used.
 //           0                              n
 //
+//   The series is summed for X/2^k and squared k times, the terms of X/2^k
+//   fall off k bits a term faster and each squaring doubles the error of
+//   the sum, so it is carried k bits further past the point.
+//
+//   At high precision the series is summed by binary splitting instead.
+//
 //-----------------------------------------------------------------------------
 
 void _exprat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
-
-    addnum(&(pret->pp), num_one, BASEX);
-    addnum(&(pret->pq), num_one, BASEX);
-    DUPRAT(thisterm, pret);
-
-    n2 = i32tonum(0L, BASEX);
-
-    do
+    if (_bsfaster(SERIES_EXP, precision))
     {
-        NEXTTERM(*px, INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+        _bsexprat(px, precision);
+        return;
+    }
 
-    DESTROYTAYLOR();
+    int32_t k = squarings(precision);
+    exptaylor(px, k, widenprecision(precision, k));
+    trimit(px, precision);
 }
 
 void exprat(PRAT* px, uint32_t radix, int32_t precision)
@@ -65,13 +127,13 @@ void exprat(PRAT* px, uint32_t radix, int32_t precision)
     PRAT pint = nullptr;
     int32_t intpwr;
 
-    if (rat_gt(*px, rat_max_exp, precision) || rat_lt(*px, rat_min_exp, precision))
+    if (rat_gt(*px, g_ratpack->rat_max_exp, precision) || rat_lt(*px, g_ratpack->rat_min_exp, precision))
     {
         // Don't attempt exp of anything large.
         throw(CALC_E_DOMAIN);
     }
 
-    DUPRAT(pwr, rat_exp);
+    DUPRAT(pwr, g_ratpack->rat_exp);
     DUPRAT(pint, *px);
 
     intrat(&pint, radix, precision);
@@ -82,7 +144,7 @@ void exprat(PRAT* px, uint32_t radix, int32_t precision)
     subrat(px, pint, precision);
 
     // It just so happens to be an integral power of e.
-    if (rat_gt(*px, rat_negsmallest, precision) && rat_lt(*px, rat_smallest, precision))
+    if (rat_gt(*px, g_ratpack->rat_negsmallest, precision) && rat_lt(*px, g_ratpack->rat_smallest, precision))
     {
         DUPRAT(*px, pwr);
     }
@@ -104,67 +166,77 @@ void exprat(PRAT* px, uint32_t radix, int32_t precision)
 //
 //  RETURN: log  of x in PRAT form.
 //
-//  EXPLANATION: This uses Taylor series
+//  EXPLANATION: This uses log(X) = 2*atanh(Z) for Z = (X-1)/(X+1) and the
+//  Taylor series
 //
 //    n
-//   ___
-//   \  ]                                             j*(1-X)
+//   ___                                                   2
+//   \  ]                                           (2j+1)*Z
 //    \   thisterm  ; where thisterm   = thisterm  * ---------
-//    /           j                 j+1          j      j+1
+//    /           j                 j+1          j   (2j+3)
 //   /__]
 //   j=0
 //
-//   thisterm  = X ;  and stop when thisterm < precision used.
+//   thisterm  = Z ;  and stop when thisterm < precision used.
 //           0                              n
 //
-//   Number is scaled between one and e_to_one_half prior to taking the
-//   log. This is to keep execution time from exploding.
+//   Number is scaled between sqrt(1/2) and sqrt(2) by a power of two prior
+//   to taking the log, abs(Z) is then below 0.18 and the terms fall off
+//   five bits a term.
 //
+//   At high precision the atanh series is summed by binary splitting
+//   instead, and higher still lograt takes the arithmetic-geometric mean in
+//   agm.cpp.
 //
 //-----------------------------------------------------------------------------
 
 void _lograt(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
-
-    createrat(thisterm);
-
-    // sub one from x
-    (*px)->pq->sign *= -1;
-    addnum(&((*px)->pp), (*px)->pq, BASEX);
-    (*px)->pq->sign *= -1;
+    PRAT pdenom = nullptr;
+    DUPRAT(pdenom, *px);
+    addrat(&pdenom, g_ratpack->rat_one, precision);
+    subrat(px, g_ratpack->rat_one, precision);
+    divrat(px, pdenom, precision);
+    destroyrat(pdenom);
+
+    if (_bsfaster(SERIES_LOG, precision))
+    {
+        _bsatanrat(px, true, precision);
+    }
+    else
+    {
+        CREATETAYLOR();
 
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
+        DUPNUM(pret, x);
+        DUPNUM(thisterm, x);
 
-    n2 = i32tonum(1L, BASEX);
-    (*px)->pp->sign *= -1;
+        n2 = i32tonum(1L, BASEX);
 
-    do
-    {
-        NEXTTERM(*px, MULNUM(n2) INC(n2) DIVNUM(n2), precision);
-        TRIMTOP(*px, precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+        do
+        {
+            NEXTTERM(xx, MULNUM(n2) INC(n2) INC(n2) DIVNUM(n2), precision);
+        } while (!SMALL_ENOUGH_NUM(thisterm, precision));
 
-    DESTROYTAYLOR();
+        DESTROYTAYLOR();
+    }
+    mulrat(px, g_ratpack->rat_two, precision);
 }
 
 void lograt(PRAT* px, int32_t precision)
 
 {
     bool fneglog;
-    PRAT pwr = nullptr;    // pwr is the large scaling factor.
-    PRAT offset = nullptr; // offset is the incremental scaling factor.
+    PRAT pwr = nullptr; // pwr is the large scaling factor.
 
     // Check for someone taking the log of zero or a negative number.
-    if (rat_le(*px, rat_zero, precision))
+    if (rat_le(*px, g_ratpack->rat_zero, precision))
     {
         throw(CALC_E_DOMAIN);
     }
 
     // Get number > 1, for scaling
-    fneglog = rat_lt(*px, rat_one, precision);
+    fneglog = rat_lt(*px, g_ratpack->rat_one, precision);
     if (fneglog)
     {
         // WARNING: This is equivalent to doing *px = 1 / *px
@@ -174,43 +246,37 @@ void lograt(PRAT* px, int32_t precision)
         (*px)->pq = pnumtemp;
     }
 
-    // Scale the number within BASEX factor of 1, for the large scale.
-    // log(x*2^(BASEXPWR*k)) = BASEXPWR*k*log(2)+log(x)
-    if (LOGRAT2(*px) > 1)
+    if (_agmfaster(precision))
     {
-        // Take advantage of px's base BASEX to scale quickly down to
-        // a reasonable range.
-        int32_t intpwr;
-        intpwr = LOGRAT2(*px) - 1;
-        (*px)->pq->exp += intpwr;
-        pwr = i32torat(intpwr * BASEXPWR);
-        mulrat(&pwr, ln_two, precision);
-        // ln(x+e)-ln(x) looks close to e when x is close to one using some
-        // expansions.  This means we can trim past precision digits+1.
-        TRIMTOP(*px, precision);
+        _agmlograt(px, precision);
     }
     else
     {
-        DUPRAT(pwr, rat_zero);
-    }
-
-    DUPRAT(offset, rat_zero);
-    // Scale the number between 1 and e_to_one_half, for the small scale.
-    while (rat_gt(*px, e_to_one_half, precision))
-    {
-        divrat(px, e_to_one_half, precision);
-        addrat(&offset, rat_one, precision);
-    }
-
-    _lograt(px, precision);
+        // Scale the number between sqrt(1/2) and sqrt(2) by a power of two,
+        // for the large scale.  log(x*2^k) = k*log(2)+log(x)
+        // Near one there is no power to take out and x goes to the series
+        // untouched, its digits are kept by the series itself.
+        int32_t intpwr = (int32_t)floor(log2top((*px)->pp) - log2top((*px)->pq) + 0.5);
+        if (intpwr > 0)
+        {
+            _shlnum(&((*px)->pq), intpwr);
+            pwr = i32torat(intpwr);
+            mulrat(&pwr, g_ratpack->ln_two, precision);
+            // ln(x+e)-ln(x) looks close to e when x is close to one using
+            // some expansions.  This means we can trim past precision
+            // digits+1.
+            TRIMTOP(*px, precision);
+        }
+        else
+        {
+            DUPRAT(pwr, g_ratpack->rat_zero);
+        }
 
-    // Add the large and small scaling factors, take into account
-    // small scaling was done in e_to_one_half chunks.
-    divrat(&offset, rat_two, precision);
-    addrat(&pwr, offset, precision);
+        _lograt(px, precision);
 
-    // And add the resulting scaling factor to the answer.
-    addrat(px, pwr, precision);
+        // And add the large scaling factor to the answer.
+        addrat(px, pwr, precision);
+    }
 
     trimit(px, precision);
 
@@ -220,7 +286,6 @@ void lograt(PRAT* px, int32_t precision)
         (*px)->pp->sign *= -1;
     }
 
-    destroyrat(offset);
     destroyrat(pwr);
 }
 
@@ -228,7 +293,7 @@ void log10rat(PRAT* px, int32_t precision)
 
 {
     lograt(px, precision);
-    divrat(px, ln_ten, precision);
+    divrat(px, g_ratpack->ln_ten, precision);
 }
 
 //
@@ -240,11 +305,11 @@ bool IsEven(PRAT x, uint32_t radix, int32_t precision)
     bool bRet = false;
 
     DUPRAT(tmp, x);
-    divrat(&tmp, rat_two, precision);
+    divrat(&tmp, g_ratpack->rat_two, precision);
     fracrat(&tmp, radix, precision);
     addrat(&tmp, tmp, precision);
-    subrat(&tmp, rat_one, precision);
-    if (rat_lt(tmp, rat_zero, precision))
+    subrat(&tmp, g_ratpack->rat_one, precision);
+    if (rat_lt(tmp, g_ratpack->rat_zero, precision))
     {
         bRet = true;
     }
@@ -276,7 +341,7 @@ void powrat(PRAT* px, PRAT y, uint32_t radix, int32_t precision)
         return;
     }
     // When y is 1, return px
-    if (rat_equ(y, rat_one, precision))
+    if (rat_equ(y, g_ratpack->rat_one, precision))
     {
         return;
     }
@@ -299,8 +364,8 @@ void powratNumeratorDenominator(PRAT* px, PRAT y, uint32_t radix, int32_t precis
     // Prepare rationals
     PRAT yNumerator = nullptr;
     PRAT yDenominator = nullptr;
-    DUPRAT(yNumerator, rat_zero);   // yNumerator->pq is 1 one
-    DUPRAT(yDenominator, rat_zero); // yDenominator->pq is 1 one
+    DUPRAT(yNumerator, g_ratpack->rat_zero);   // yNumerator->pq is 1 one
+    DUPRAT(yDenominator, g_ratpack->rat_zero); // yDenominator->pq is 1 one
     DUPNUM(yNumerator->pp, y->pp);
     DUPNUM(yDenominator->pp, y->pq);
 
@@ -308,8 +373,8 @@ void powratNumeratorDenominator(PRAT* px, PRAT y, uint32_t radix, int32_t precis
     // px ^ (yNum/yDenom) == px ^ yNum ^ (1/yDenom)
     // 1. For px ^ yNum, we call powratcomp directly which will call ratpowi32
     //    and store the result in pxPowNum
-    // 2. For pxPowNum ^ (1/yDenom), we call powratcomp
-    // 3. Validate the result of 2 by adding/subtracting 0.5, flooring and call powratcomp with yDenom
+    // 2. For pxPowNum ^ (1/yDenom), we call ratrooti32 when yDenom is a small integer, otherwise powratcomp
+    // 3. Validate the result of powratcomp by adding/subtracting 0.5, flooring and call powratcomp with yDenom
     //    on the floored result.
 
     // 1. Initialize result.
@@ -318,18 +383,25 @@ void powratNumeratorDenominator(PRAT* px, PRAT y, uint32_t radix, int32_t precis
 
     // 2. Calculate pxPow = px ^ yNumerator
     // if yNumerator is not 1
-    if (!rat_equ(yNumerator, rat_one, precision))
+    if (!rat_equ(yNumerator, g_ratpack->rat_one, precision))
     {
         powratcomp(&pxPow, yNumerator, radix, precision);
     }
 
     // 2. Calculate pxPowNumDenom = pxPowNum ^ (1/yDenominator),
     // if yDenominator is not 1
-    if (!rat_equ(yDenominator, rat_one, precision))
+    int32_t root = rootdegree(yDenominator);
+    if (root != 0)
+    {
+        // A small root is exact on perfect powers already.
+        ratrooti32(&pxPow, root, precision);
+        DUPRAT(*px, pxPow);
+    }
+    else if (!rat_equ(yDenominator, g_ratpack->rat_one, precision))
     {
         // Calculate 1 over y
         PRAT oneoveryDenom = nullptr;
-        DUPRAT(oneoveryDenom, rat_one);
+        DUPRAT(oneoveryDenom, g_ratpack->rat_one);
         divrat(&oneoveryDenom, yDenominator, precision);
 
         // ##################################
@@ -346,11 +418,11 @@ void powratNumeratorDenominator(PRAT* px, PRAT y, uint32_t radix, int32_t precis
         DUPRAT(roundedResult, originalResult);
         if (roundedResult->pp->sign == -1)
         {
-            subrat(&roundedResult, rat_half, precision);
+            subrat(&roundedResult, g_ratpack->rat_half, precision);
         }
         else
         {
-            addrat(&roundedResult, rat_half, precision);
+            addrat(&roundedResult, g_ratpack->rat_half, precision);
         }
         intrat(&roundedResult, radix, precision);
 
@@ -414,14 +486,14 @@ void powratcomp(PRAT* px, PRAT y, uint32_t radix, int32_t precision)
     if (zerrat(*px))
     {
         // *px is zero.
-        if (rat_lt(y, rat_zero, precision))
+        if (rat_lt(y, g_ratpack->rat_zero, precision))
         {
             throw(CALC_E_DOMAIN);
         }
         else if (zerrat(y))
         {
             // *px and y are both zero, special case a 1 return.
-            DUPRAT(*px, rat_one);
+            DUPRAT(*px, g_ratpack->rat_one);
             // Ensure sign is positive.
             sign = 1;
         }
@@ -430,11 +502,11 @@ void powratcomp(PRAT* px, PRAT y, uint32_t radix, int32_t precision)
     {
         PRAT pxint = nullptr;
         DUPRAT(pxint, *px);
-        subrat(&pxint, rat_one, precision);
-        if (rat_gt(pxint, rat_negsmallest, precision) && rat_lt(pxint, rat_smallest, precision) && (sign == 1))
+        subrat(&pxint, g_ratpack->rat_one, precision);
+        if (rat_gt(pxint, g_ratpack->rat_negsmallest, precision) && rat_lt(pxint, g_ratpack->rat_smallest, precision) && (sign == 1))
         {
             // *px is one, special case a 1 return.
-            DUPRAT(*px, rat_one);
+            DUPRAT(*px, g_ratpack->rat_one);
             // Ensure sign is positive.
             sign = 1;
         }
@@ -444,7 +516,7 @@ void powratcomp(PRAT* px, PRAT y, uint32_t radix, int32_t precision)
             PRAT podd = nullptr;
             DUPRAT(podd, y);
             fracrat(&podd, radix, precision);
-            if (rat_gt(podd, rat_negsmallest, precision) && rat_lt(podd, rat_smallest, precision))
+            if (rat_gt(podd, g_ratpack->rat_negsmallest, precision) && rat_lt(podd, g_ratpack->rat_smallest, precision))
             {
                 // If power is an integer let ratpowi32 deal with it.
                 PRAT iy = nullptr;
@@ -453,20 +525,27 @@ void powratcomp(PRAT* px, PRAT y, uint32_t radix, int32_t precision)
                 subrat(&iy, podd, precision);
                 inty = rattoi32(iy, radix, precision);
 
-                PRAT plnx = nullptr;
-                DUPRAT(plnx, *px);
-                lograt(&plnx, precision);
-                mulrat(&plnx, iy, precision);
-                if (rat_gt(plnx, rat_max_exp, precision) || rat_lt(plnx, rat_min_exp, precision))
+                // |ln(x^y)| is below |y| times the bits of x, the log is only
+                // worked out when that bound doesn't already keep it inside
+                // the limits.
+                int64_t bound = ((int64_t)abs(LOGRAT2(*px)) + 1) * BASEXPWR * abs((int64_t)inty);
+                if (bound >= rattoi32(g_ratpack->rat_max_exp, radix, precision) || -bound <= rattoi32(g_ratpack->rat_min_exp, radix, precision))
                 {
-                    // Don't attempt exp of anything large or small.A
+                    PRAT plnx = nullptr;
+                    DUPRAT(plnx, *px);
+                    lograt(&plnx, precision);
+                    mulrat(&plnx, iy, precision);
+                    if (rat_gt(plnx, g_ratpack->rat_max_exp, precision) || rat_lt(plnx, g_ratpack->rat_min_exp, precision))
+                    {
+                        // Don't attempt exp of anything large or small.A
+                        destroyrat(plnx);
+                        destroyrat(iy);
+                        destroyrat(pxint);
+                        destroyrat(podd);
+                        throw(CALC_E_DOMAIN);
+                    }
                     destroyrat(plnx);
-                    destroyrat(iy);
-                    destroyrat(pxint);
-                    destroyrat(podd);
-                    throw(CALC_E_DOMAIN);
                 }
-                destroyrat(plnx);
                 ratpowi32(px, inty, precision);
                 if ((inty & 1) == 0)
                 {
@@ -488,8 +567,8 @@ void powratcomp(PRAT* px, PRAT y, uint32_t radix, int32_t precision)
                     bool fBadExponent = false;
 
                     // Get the numbers in arbitrary precision rational number format
-                    DUPRAT(pNumerator, rat_zero);   // pNumerator->pq is 1 one
-                    DUPRAT(pDenominator, rat_zero); // pDenominator->pq is 1 one
+                    DUPRAT(pNumerator, g_ratpack->rat_zero);   // pNumerator->pq is 1 one
+                    DUPRAT(pDenominator, g_ratpack->rat_zero); // pDenominator->pq is 1 one
 
                     DUPNUM(pNumerator->pp, y->pp);
                     pNumerator->pp->sign = 1;
@@ -498,8 +577,8 @@ void powratcomp(PRAT* px, PRAT y, uint32_t radix, int32_t precision)
 
                     while (IsEven(pNumerator, radix, precision) && IsEven(pDenominator, radix, precision)) // both Numerator & denominator is even
                     {
-                        divrat(&pNumerator, rat_two, precision);
-                        divrat(&pDenominator, rat_two, precision);
+                        divrat(&pNumerator, g_ratpack->rat_two, precision);
+                        divrat(&pDenominator, g_ratpack->rat_two, precision);
                     }
                     if (IsEven(pDenominator, radix, precision)) // denominator is still even
                     {
@@ -13,240 +13,377 @@
 //     Contains fact(orial) and supporting _gamma functions.
 //
 //-----------------------------------------------------------------------------
+#include <vector>
 #include "ratpak.h"
+#include "mantissa.h"
+
+using namespace std;
 
 #define ABSRAT(x) (((x)->pp->sign = 1), ((x)->pq->sign = 1))
 #define NEGATE(x) ((x)->pp->sign *= -1)
 
+namespace
+{
+    // Product of count odd numbers from *podd up, *podd is left at the next
+    // one.  The halves are multiplied together so the big multiplies are
+    // balanced and get the fast kernels, a run that fits one digit is
+    // multiplied out directly.
+    PNUMBER oddproduct(uint32_t* podd, uint32_t count)
+    {
+        TWO_MANTTYPE top = *podd + 2 * (TWO_MANTTYPE)(count - 1);
+        TWO_MANTTYPE bound = 1;
+        for (uint32_t i = 0; i < count && bound <= BASEXMAX; i++)
+        {
+            bound *= top;
+        }
+
+        if (bound > BASEXMAX)
+        {
+            uint32_t half = count / 2;
+            PNUMBER a = oddproduct(podd, count - half);
+            PNUMBER b = oddproduct(podd, half);
+            mulnumx(&a, b);
+            destroynum(b);
+            return a;
+        }
+
+        TWO_MANTTYPE prod = 1;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            prod *= *podd;
+            *podd += 2;
+        }
+        PNUMBER pnumret = nullptr;
+        createnum(pnumret, 1);
+        pnumret->sign = 1;
+        pnumret->cdigit = 1;
+        pnumret->exp = 0;
+        pnumret->mant[0] = (MANTTYPE)prod;
+        return pnumret;
+    }
+
+    // n! in BASEX, Luschny's split recursive method.  The odd part of n! is
+    // the product over the bits of n of the odd numbers in (n >> (i+1), n >> i],
+    // each taken i+1 times, and the power of two is n - popcount(n).
+    PNUMBER factnumx(uint32_t n)
+    {
+        PNUMBER p = i32tonum(1, BASEX);
+        PNUMBER r = i32tonum(1, BASEX);
+        uint32_t odd = 3;
+        uint32_t h = 0;
+        uint32_t high = 1;
+        uint32_t shift = 0;
+
+        int32_t log2n = 0;
+        while ((n >> log2n) > 1)
+        {
+            log2n++;
+        }
+
+        while (h != n)
+        {
+            shift += h;
+            h = n >> log2n--;
+            uint32_t low = high;
+            high = (h - 1) | 1;
+            uint32_t len = (high - low) / 2;
+            if (len > 0)
+            {
+                PNUMBER q = oddproduct(&odd, len);
+                mulnumx(&p, q);
+                mulnumx(&r, p);
+                destroynum(q);
+            }
+        }
+
+        _shlnum(&r, shift);
+        destroynum(p);
+        return r;
+    }
+
+    // t = a*u + b*t for single digit a and b.
+    void muladddigits(vector<MANTTYPE>& t, const vector<MANTTYPE>& u, MANTTYPE a, MANTTYPE b)
+    {
+        size_t n = max(t.size(), u.size());
+        t.resize(n, 0);
+        TWO_MANTTYPE carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            TWO_MANTTYPE acc = (TWO_MANTTYPE)t[i] * b + carry;
+            if (i < u.size())
+            {
+                acc += (TWO_MANTTYPE)u[i] * a;
+            }
+            t[i] = (MANTTYPE)(acc & BASEXMAX);
+            carry = acc >> BASEXPWR;
+        }
+        while (carry != 0)
+        {
+            t.push_back((MANTTYPE)(carry & BASEXMAX));
+            carry >>= BASEXPWR;
+        }
+    }
+
+    // The tangent numbers T(1) to T(count) in BASEX digits, T(k) is the
+    // 2k-1'th derivative of tan at 0.  They are integers, so they are kept
+    // for any radix and precision and only worked out again, twice as many,
+    // when more are asked for.  Brent and Harvey's in place recurrence.
+    const vector<vector<MANTTYPE>>& tangentnumbers(int32_t count)
+    {
+        // Per thread, like the rest of the ratpack state.
+        static thread_local vector<vector<MANTTYPE>> cache;
+
+        if ((int32_t)cache.size() <= count)
+        {
+            int32_t n = max(count, 2 * (int32_t)cache.size());
+            cache.assign(n + 1, vector<MANTTYPE>{ 0 });
+            cache[1] = { 1 };
+            for (int32_t k = 2; k <= n; k++)
+            {
+                cache[k] = cache[k - 1];
+                muladddigits(cache[k], cache[k - 1], 0, k - 1);
+            }
+            for (int32_t k = 2; k <= n; k++)
+            {
+                for (int32_t j = k; j <= n; j++)
+                {
+                    muladddigits(cache[j], cache[j - 1], j - k, j - k + 2);
+                }
+            }
+        }
+        return cache;
+    }
+
+    // The k'th Stirling series coefficient B(2k)/(2k(2k-1)), which is
+    // (-1)^(k-1) T(k) / ((2k-1) 2^2k (2^2k-1)).
+    PRAT stirlingcoef(int32_t k)
+    {
+        const vector<MANTTYPE>& t = tangentnumbers(k)[k];
+
+        PRAT pret = nullptr;
+        createrat(pret);
+        createnum(pret->pp, (uint32_t)t.size());
+        pret->pp->sign = (k % 2) ? 1 : -1;
+        pret->pp->cdigit = (int32_t)t.size();
+        pret->pp->exp = 0;
+        memcpy(pret->pp->mant, t.data(), t.size() * sizeof(MANTTYPE));
+
+        // 2^2k-1 is 2k one bits.
+        int32_t bits = 2 * k;
+        int32_t cdigit = (bits + BASEXPWR - 1) / BASEXPWR;
+        createnum(pret->pq, cdigit);
+        pret->pq->sign = 1;
+        pret->pq->cdigit = cdigit;
+        pret->pq->exp = 0;
+        for (int32_t i = 0; i < cdigit; i++, bits -= BASEXPWR)
+        {
+            pret->pq->mant[i] = bits >= (int32_t)BASEXPWR ? BASEXMAX : (MANTTYPE)(((MANTTYPE)1 << bits) - 1);
+        }
+        PNUMBER odd = i32tonum(2 * k - 1, BASEX);
+        mulnumx(&pret->pq, odd);
+        destroynum(odd);
+        _shlnum(&pret->pq, 2 * k);
+
+        return pret;
+    }
+}
+
 //-----------------------------------------------------------------------------
 //
-//  FUNCTION: factrat, _gamma, gamma
-//
-//  ARGUMENTS:  x PRAT representation of number to take the sine of
+//  FUNCTION: _gamma
 //
-//  RETURN: factorial of x in PRAT form.
-//
-//  EXPLANATION: This uses Taylor series
+//  ARGUMENTS:  pn PRAT representation of a number >= 1/2
 //
-//      n
-//     ___    2j
-//   n \  ]  A       1          A
-//  A   \   -----[ ---- - ---------------]
-//      /   (2j)!  n+2j   (n+2j+1)(2j+1)
-//     /__]
-//     j=0
+//  RETURN: gamma of n in PRAT form.
 //
-//                        / oo
-//                        |    n-1 -x     __
-//  This was derived from |   x   e  dx = |
-//                        |               | (n) { = (n-1)! for +integers}
-//                        / 0
+//  EXPLANATION: This uses Stirling's series
 //
-//  It can be shown that the above series is within precision if A is chosen
-//  big enough.
-//                          A    n  precision
-//  Based on the relation ne  = A 10            A was chosen as
+//                                                 __
+//                                                 \     B(2k)       1-2k
+//  ln gamma(n) = (n-1/2)ln(n) - n + ln(2 pi)/2 +   \  ---------- * n
+//                                                  /  2k(2k-1)
+//                                                 /__
+//                                                 k=1
 //
-//             precision
-//  A = ln(Base         /n)+1
-//  A += n*ln(A)  This is close enough for precision > base and n < 1.5
+//  which is asymptotic, the terms first get smaller then grow without
+//  bound, the smallest one is about exp(-2 pi n).  So n is first moved up
+//  to at least the precision with gamma(n) = gamma(n+m) / (n(n+1)...(n+m-1))
+//  and the series is summed until its terms drop below the precision.  The
+//  coefficients are exact and made from the cached tangent numbers.
 //
+//  ln gamma(n) is worked out to as many more digits as it has in front of
+//  the point, its exp is then good to precision.
 //
 //-----------------------------------------------------------------------------
 
 void _gamma(PRAT* pn, uint32_t radix, int32_t precision)
 
 {
-    PRAT factorial = nullptr;
-    PNUMBER count = nullptr;
+    PRAT rising = nullptr;
+    PRAT zmin = nullptr;
+    PRAT lnn = nullptr;
+    PRAT sum = nullptr;
     PRAT tmp = nullptr;
-    PRAT one_pt_five = nullptr;
-    PRAT a = nullptr;
-    PRAT a2 = nullptr;
+    PRAT pwr = nullptr;
+    PRAT invn2 = nullptr;
     PRAT term = nullptr;
-    PRAT sum = nullptr;
-    PRAT err = nullptr;
-    PRAT mpy = nullptr;
-    PRAT ratprec = nullptr;
-    PRAT ratRadix = nullptr;
-    int32_t oldprec;
-
-    // Set up constants and initial conditions
-    oldprec = precision;
-    ratprec = i32torat(oldprec);
-
-    // Find the best 'A' for convergence to the required precision.
-    a = i32torat(radix);
-    lograt(&a, precision);
-    mulrat(&a, ratprec, precision);
-
-    // Really is -ln(n)+1, but -ln(n) will be < 1
-    // if we scale n between 0.5 and 1.5
-    addrat(&a, rat_two, precision);
-    DUPRAT(tmp, a);
-    lograt(&tmp, precision);
-    mulrat(&tmp, *pn, precision);
-    addrat(&a, tmp, precision);
-    addrat(&a, rat_one, precision);
-
-    // Calculate the necessary bump in precision and up the precision.
-    // The following code is equivalent to
-    // precision += ln(exp(a)*pow(a,n+1.5))-ln(radix));
-    DUPRAT(tmp, *pn);
-    one_pt_five = i32torat(3L);
-    divrat(&one_pt_five, rat_two, precision);
-    addrat(&tmp, one_pt_five, precision);
-    DUPRAT(term, a);
-    powratcomp(&term, tmp, radix, precision);
-    DUPRAT(tmp, a);
-    exprat(&tmp, radix, precision);
-    mulrat(&term, tmp, precision);
-    lograt(&term, precision);
-    ratRadix = i32torat(radix);
-    DUPRAT(tmp, ratRadix);
-    lograt(&tmp, precision);
-    subrat(&term, tmp, precision);
-    precision += rattoi32(term, radix, precision);
-
-    // Set up initial terms for series, refer to series in above comment block.
-    DUPRAT(factorial, rat_one); // Start factorial out with one
-    count = i32tonum(0L, BASEX);
-
-    DUPRAT(mpy, a);
-    powratcomp(&mpy, *pn, radix, precision);
-    // a2=a^2
-    DUPRAT(a2, a);
-    mulrat(&a2, a, precision);
-
-    // sum=(1/n)-(a/(n+1))
-    DUPRAT(sum, rat_one);
-    divrat(&sum, *pn, precision);
-    DUPRAT(tmp, *pn);
-    addrat(&tmp, rat_one, precision);
-    DUPRAT(term, a);
-    divrat(&term, tmp, precision);
-    subrat(&sum, term, precision);
-
-    DUPRAT(err, ratRadix);
-    NEGATE(ratprec);
-    powratcomp(&err, ratprec, radix, precision);
-    divrat(&err, ratRadix, precision);
-
-    // Just get something not tiny in term
-    DUPRAT(term, rat_two);
-
-    // Loop until precision is reached, or asked to halt.
-    while (!zerrat(term) && rat_gt(term, err, precision))
-    {
-        addrat(pn, rat_two, precision);
+    PRAT last = nullptr;
 
-        // WARNING: mixing numbers and  rationals here.
-        // for speed and efficiency.
-        INC(count);
-        mulnumx(&(factorial->pp), count);
-        INC(count)
-        mulnumx(&(factorial->pp), count);
+    int32_t wprec = precision + 2 * max(LOGRATRADIX(*pn), 0) + g_ratpack->ratio;
 
-        divrat(&factorial, a2, precision);
+    // Move n up to where the series gets small enough.
+    DUPRAT(rising, g_ratpack->rat_one);
+    zmin = i32torat(wprec);
+    while (rat_lt(*pn, zmin, wprec))
+    {
+        mulrat(&rising, *pn, wprec);
+        addrat(pn, g_ratpack->rat_one, wprec);
+    }
 
-        DUPRAT(tmp, *pn);
-        addrat(&tmp, rat_one, precision);
+    // sum = (n-1/2)ln(n) - n + ln(2 pi)/2
+    DUPRAT(lnn, *pn);
+    lograt(&lnn, wprec);
+    DUPRAT(sum, *pn);
+    subrat(&sum, g_ratpack->rat_half, wprec);
+    mulrat(&sum, lnn, wprec);
+    subrat(&sum, *pn, wprec);
+    DUPRAT(tmp, g_ratpack->two_pi);
+    lograt(&tmp, wprec);
+    divrat(&tmp, g_ratpack->rat_two, wprec);
+    addrat(&sum, tmp, wprec);
+
+    DUPRAT(pwr, g_ratpack->rat_one);
+    divrat(&pwr, *pn, wprec);
+    DUPRAT(invn2, pwr);
+    mulrat(&invn2, pwr, wprec);
+
+    for (int32_t k = 1;; k++)
+    {
         destroyrat(term);
-        createrat(term);
-        DUPNUM(term->pp, count);
-        DUPNUM(term->pq, num_one);
-        addrat(&term, rat_one, precision);
-        mulrat(&term, tmp, precision);
-        DUPRAT(tmp, a);
-        divrat(&tmp, term, precision);
-
-        DUPRAT(term, rat_one);
-        divrat(&term, *pn, precision);
-        subrat(&term, tmp, precision);
-
-        divrat(&term, factorial, precision);
-        addrat(&sum, term, precision);
-        ABSRAT(term);
+        term = stirlingcoef(k);
+        mulrat(&term, pwr, wprec);
+
+        // Stop once within precision, or should the terms start to grow.
+        DUPRAT(tmp, term);
+        ABSRAT(tmp);
+        if (zerrat(term) || LOGRATRADIX(term) < -wprec || (last != nullptr && rat_gt(tmp, last, wprec)))
+        {
+            break;
+        }
+        DUPRAT(last, tmp);
+
+        addrat(&sum, term, wprec);
+        mulrat(&pwr, invn2, wprec);
     }
 
-    // Multiply by factor.
-    mulrat(&sum, mpy, precision);
-
-    // And cleanup
-    precision = oldprec;
-    destroyrat(ratprec);
-    destroyrat(err);
-    destroyrat(term);
-    destroyrat(a);
-    destroyrat(a2);
-    destroyrat(tmp);
-    destroyrat(one_pt_five);
-
-    destroynum(count);
+    exprat(&sum, radix, wprec);
+    divrat(&sum, rising, wprec);
+    trimit(&sum, precision);
 
-    destroyrat(factorial);
     destroyrat(*pn);
-    DUPRAT(*pn, sum);
-    destroyrat(sum);
+    *pn = sum;
+
+    destroyrat(rising);
+    destroyrat(zmin);
+    destroyrat(lnn);
+    destroyrat(tmp);
+    destroyrat(pwr);
+    destroyrat(invn2);
+    destroyrat(term);
+    destroyrat(last);
 }
 
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: factrat
+//
+//  ARGUMENTS:  x PRAT representation of number to take the factorial of
+//
+//  RETURN: factorial of x in PRAT form.
+//
+//  EXPLANATION: An integer, or a number within precision of one, gets the
+//  exact n! from factnumx.  Anything else is gamma(z) for z = x+1, from
+//  _gamma when z >= 1/2 and below it from the reflection
+//
+//                     pi
+//  gamma(z) = -------------------
+//             sin(pi z) gamma(1-z)
+//
+//  where sin(pi z) is (-1)^int(z) sin(pi frac(z)).
+//
+//-----------------------------------------------------------------------------
+
 void factrat(PRAT* px, uint32_t radix, int32_t precision)
 
 {
-    PRAT fact = nullptr;
+    PRAT n = nullptr;
     PRAT frac = nullptr;
-    PRAT neg_rat_one = nullptr;
+    PRAT tmp = nullptr;
 
-    if (rat_gt(*px, rat_max_fact, precision) || rat_lt(*px, rat_min_fact, precision))
+    if (rat_gt(*px, g_ratpack->rat_max_fact, precision) || rat_lt(*px, g_ratpack->rat_min_fact, precision))
     {
         // Don't attempt factorial of anything too large or small.
         throw CALC_E_OVERFLOW;
     }
 
-    DUPRAT(fact, rat_one);
-
-    DUPRAT(neg_rat_one, rat_one);
-    neg_rat_one->pp->sign *= -1;
-
+    // n is the integer nearest x, frac what x is off from it.
+    DUPRAT(n, g_ratpack->rat_half);
+    n->pp->sign = SIGN(*px);
+    addrat(&n, *px, precision);
+    intrat(&n, radix, precision);
     DUPRAT(frac, *px);
-    fracrat(&frac, radix, precision);
-
-    // Check for negative integers and throw an error.
-    if ((zerrat(frac) || (LOGRATRADIX(frac) <= -precision)) && (SIGN(*px) == -1))
-    {
-        throw CALC_E_DOMAIN;
-    }
-    while (rat_gt(*px, rat_zero, precision) && (LOGRATRADIX(*px) > -precision))
-    {
-        mulrat(&fact, *px, precision);
-        subrat(px, rat_one, precision);
-    }
+    subrat(&frac, n, precision);
 
-    // Added to make numbers 'close enough' to integers use integer factorial.
-    if (LOGRATRADIX(*px) <= -precision)
+    if (zerrat(frac) || (LOGRATRADIX(frac) <= -precision))
     {
-        DUPRAT((*px), rat_zero);
-        intrat(&fact, radix, precision);
-    }
-
-    while (rat_lt(*px, neg_rat_one, precision))
-    {
-        addrat(px, rat_one, precision);
-        divrat(&fact, *px, precision);
-    }
-
-    if (rat_neq(*px, rat_zero, precision))
-    {
-        addrat(px, rat_one, precision);
-        _gamma(px, radix, precision);
-        mulrat(px, fact, precision);
+        // Added to make numbers 'close enough' to integers use integer factorial.
+        if (SIGN(n) == -1 && !zerrat(n))
+        {
+            destroyrat(n);
+            destroyrat(frac);
+            throw CALC_E_DOMAIN;
+        }
+
+        destroyrat(*px);
+        createrat(*px);
+        (*px)->pp = factnumx((uint32_t)rattoi32(n, radix, precision));
+        DUPNUM((*px)->pq, g_ratpack->num_one);
     }
     else
     {
-        DUPRAT(*px, fact);
+        addrat(px, g_ratpack->rat_one, precision);
+        if (rat_ge(*px, g_ratpack->rat_half, precision))
+        {
+            _gamma(px, radix, precision);
+        }
+        else
+        {
+            // sin(pi z) from frac(z) and the parity of int(z).
+            DUPRAT(frac, *px);
+            fracrat(&frac, radix, precision);
+            DUPRAT(n, *px);
+            subrat(&n, frac, precision);
+            DUPRAT(tmp, g_ratpack->pi);
+            mulrat(&tmp, frac, precision);
+            sinanglerat(&tmp, ANGLE_RAD, radix, precision);
+            if (rattoi32(n, radix, precision) % 2 != 0)
+            {
+                NEGATE(tmp);
+            }
+
+            // gamma(1-z)
+            NEGATE(*px);
+            addrat(px, g_ratpack->rat_one, precision);
+            _gamma(px, radix, precision);
+
+            mulrat(px, tmp, precision);
+            DUPRAT(tmp, g_ratpack->pi);
+            divrat(&tmp, *px, precision);
+            DUPRAT(*px, tmp);
+        }
     }
 
-    destroyrat(fact);
+    destroyrat(n);
     destroyrat(frac);
-    destroyrat(neg_rat_one);
+    destroyrat(tmp);
 }
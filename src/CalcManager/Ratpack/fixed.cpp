@@ -0,0 +1,225 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           fixed.cpp
+//
+//
+//  Description
+//
+//     Contains the fixed point numbers the taylor series are summed in.  A
+//  fixed point number is a NUMBER in BASEX whose digits below BASEX^-limbs
+//  have been dropped, so every term and partial sum stays limbs digits past
+//  the point no matter how many terms are added, where the p/q of a RAT
+//  would keep growing until trimmed.  Dividing by the small integers of a
+//  series is a single digit division instead of a multiply of the
+//  denominator.
+//
+//-----------------------------------------------------------------------------
+#include "ratpak.h"
+#include "mantissa.h"
+
+// BASEX digits carried past the precision asked for, they absorb the
+// truncation error of the terms.
+static constexpr int32_t FIXED_GUARD_LIMBS = 2;
+
+namespace
+{
+    void setzero(PNUMBER a)
+    {
+        a->sign = 1;
+        a->cdigit = 1;
+        a->exp = 0;
+        a->mant[0] = 0;
+    }
+
+    // *pa /= d for a single digit d, truncated below BASEX^low.
+    void divdigit(PNUMBER* pa, MANTTYPE d, int32_t low)
+    {
+        PNUMBER a = *pa;
+        int32_t top = a->cdigit + a->exp;
+        if (top <= low || zernum(a))
+        {
+            setzero(a);
+            return;
+        }
+
+        int32_t cdigit = top - low;
+        PNUMBER c = nullptr;
+        createnum(c, cdigit);
+        TWO_MANTTYPE rem = 0;
+        for (int32_t i = cdigit - 1; i >= 0; i--)
+        {
+            int32_t ia = low + i - a->exp;
+            rem = (rem << BASEXPWR) | (ia >= 0 ? a->mant[ia] : 0);
+            c->mant[i] = (MANTTYPE)(rem / d);
+            rem %= d;
+        }
+        c->cdigit = _mantlen(c->mant, cdigit);
+        c->exp = low;
+        c->sign = a->sign;
+        if (c->cdigit == 0)
+        {
+            setzero(c);
+        }
+
+        destroynum(*pa);
+        *pa = c;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _fxlimbs
+//
+//    ARGUMENTS: precision in digits of the current radix
+//
+//    RETURN: The BASEX digits past the point a series is summed to.
+//
+//----------------------------------------------------------------------------
+
+int32_t _fxlimbs(int32_t precision)
+
+{
+    return precision / g_ratpack->ratio + 1 + FIXED_GUARD_LIMBS;
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _fxtrunc
+//
+//    ARGUMENTS: a number and the BASEX digits past the point to keep
+//
+//    RETURN: None, changes the number.
+//
+//    DESCRIPTION: Drops the digits of a below BASEX^-limbs, rounding
+//    towards zero.
+//
+//----------------------------------------------------------------------------
+
+void _fxtrunc(PNUMBER a, int32_t limbs)
+
+{
+    int32_t drop = -limbs - a->exp;
+    if (drop > 0)
+    {
+        if (drop >= a->cdigit)
+        {
+            setzero(a);
+            return;
+        }
+        memmove(a->mant, a->mant + drop, (a->cdigit - drop) * sizeof(MANTTYPE));
+        a->cdigit -= drop;
+        a->exp = -limbs;
+        a->cdigit = _mantlen(a->mant, a->cdigit);
+        if (a->cdigit == 0)
+        {
+            setzero(a);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _fxmul
+//
+//    ARGUMENTS: pointer to a fixed point number, a second number and the
+//               BASEX digits past the point.
+//
+//    RETURN: None, changes first pointer.
+//
+//    DESCRIPTION: Does *pa *= b truncated to limbs digits past the point.
+//
+//----------------------------------------------------------------------------
+
+void _fxmul(PNUMBER* pa, PNUMBER b, int32_t limbs)
+
+{
+    mulnumx(pa, b);
+    _fxtrunc(*pa, limbs);
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _fxdiv
+//
+//    ARGUMENTS: pointer to a fixed point number, a nonzero number and the
+//               BASEX digits past the point.
+//
+//    RETURN: None, changes first pointer.
+//
+//    DESCRIPTION: Does *pa /= b truncated to limbs digits past the point.
+//    A single digit b, the usual case for a series, is a short division.
+//
+//----------------------------------------------------------------------------
+
+void _fxdiv(PNUMBER* pa, PNUMBER b, int32_t limbs)
+
+{
+    if (b->cdigit == 1)
+    {
+        divdigit(pa, b->mant[0], b->exp - limbs);
+        if (!zernum(*pa))
+        {
+            (*pa)->exp -= b->exp;
+            (*pa)->sign *= b->sign;
+        }
+        return;
+    }
+
+    int32_t cdigit = LOGNUM2(*pa) - LOGNUM2(b) + 1 + limbs;
+    if (cdigit <= 0 || zernum(*pa))
+    {
+        setzero(*pa);
+        return;
+    }
+    _divnumdigits(pa, b, BASEX, cdigit);
+    _fxtrunc(*pa, limbs);
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _rattofx
+//
+//    ARGUMENTS: a rational and the BASEX digits past the point.
+//
+//    RETURN: The rational as a fixed point number.
+//
+//----------------------------------------------------------------------------
+
+PNUMBER _rattofx(_In_ PRAT prat, int32_t limbs)
+
+{
+    PNUMBER pnumret = nullptr;
+    DUPNUM(pnumret, prat->pp);
+    _fxdiv(&pnumret, prat->pq, limbs);
+    return pnumret;
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _fxtorat
+//
+//    ARGUMENTS: a fixed point number
+//
+//    RETURN: The number as a rational over a power of BASEX.
+//
+//----------------------------------------------------------------------------
+
+PRAT _fxtorat(_In_ PNUMBER pnum)
+
+{
+    PRAT pratret = nullptr;
+    createrat(pratret);
+    DUPNUM(pratret->pp, pnum);
+    pratret->pq = i32tonum(1L, BASEX);
+
+    // Move the negative exponent of the number over to the denominator.
+    if (pnum->exp < 0)
+    {
+        pratret->pp->exp = 0;
+        pratret->pq->exp = -pnum->exp;
+    }
+    return pratret;
+}
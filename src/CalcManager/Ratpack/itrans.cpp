@@ -24,12 +24,12 @@ void ascalerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, int32_t precision)
     case ANGLE_RAD:
         break;
     case ANGLE_DEG:
-        divrat(pa, two_pi, precision);
-        mulrat(pa, rat_360, precision);
+        divrat(pa, g_ratpack->two_pi, precision);
+        mulrat(pa, g_ratpack->rat_360, precision);
         break;
     case ANGLE_GRAD:
-        divrat(pa, two_pi, precision);
-        mulrat(pa, rat_400, precision);
+        divrat(pa, g_ratpack->two_pi, precision);
+        mulrat(pa, g_ratpack->rat_400, precision);
         break;
     }
 }
@@ -65,14 +65,14 @@ void _asinrat(PRAT* px, int32_t precision)
 
 {
     CREATETAYLOR();
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
-    DUPNUM(n2, num_one);
+    DUPNUM(pret, x);
+    DUPNUM(thisterm, x);
+    DUPNUM(n2, g_ratpack->num_one);
 
     do
     {
         NEXTTERM(xx, MULNUM(n2) MULNUM(n2) INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+    } while (!SMALL_ENOUGH_NUM(thisterm, precision));
     DESTROYTAYLOR();
 }
 
@@ -95,38 +95,38 @@ void asinrat(PRAT* px, uint32_t radix, int32_t precision)
 
     // Avoid the really bad part of the asin curve near +/-1.
     DUPRAT(phack, *px);
-    subrat(&phack, rat_one, precision);
+    subrat(&phack, g_ratpack->rat_one, precision);
     // Since *px might be epsilon near zero we must set it to zero.
-    if (rat_le(phack, rat_smallest, precision) && rat_ge(phack, rat_negsmallest, precision))
+    if (rat_le(phack, g_ratpack->rat_smallest, precision) && rat_ge(phack, g_ratpack->rat_negsmallest, precision))
     {
         destroyrat(phack);
-        DUPRAT(*px, pi_over_two);
+        DUPRAT(*px, g_ratpack->pi_over_two);
     }
     else
     {
         destroyrat(phack);
-        if (rat_gt(*px, pt_eight_five, precision))
+        if (rat_gt(*px, g_ratpack->pt_eight_five, precision))
         {
-            if (rat_gt(*px, rat_one, precision))
+            if (rat_gt(*px, g_ratpack->rat_one, precision))
             {
-                subrat(px, rat_one, precision);
-                if (rat_gt(*px, rat_smallest, precision))
+                subrat(px, g_ratpack->rat_one, precision);
+                if (rat_gt(*px, g_ratpack->rat_smallest, precision))
                 {
                     throw(CALC_E_DOMAIN);
                 }
                 else
                 {
-                    DUPRAT(*px, rat_one);
+                    DUPRAT(*px, g_ratpack->rat_one);
                 }
             }
             DUPRAT(pret, *px);
             mulrat(px, pret, precision);
             (*px)->pp->sign *= -1;
-            addrat(px, rat_one, precision);
-            rootrat(px, rat_two, radix, precision);
+            addrat(px, g_ratpack->rat_one, precision);
+            rootrat(px, g_ratpack->rat_two, radix, precision);
             _asinrat(px, precision);
             (*px)->pp->sign *= -1;
-            addrat(px, pi_over_two, precision);
+            addrat(px, g_ratpack->pi_over_two, precision);
             destroyrat(pret);
         }
         else
@@ -176,16 +176,14 @@ void _acosrat(PRAT* px, int32_t precision)
 {
     CREATETAYLOR();
 
-    createrat(thisterm);
-    thisterm->pp = i32tonum(1L, BASEX);
-    thisterm->pq = i32tonum(1L, BASEX);
+    DUPNUM(thisterm, g_ratpack->num_one);
 
-    DUPNUM(n2, num_one);
+    DUPNUM(n2, g_ratpack->num_one);
 
     do
     {
         NEXTTERM(xx, MULNUM(n2) MULNUM(n2) INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+    } while (!SMALL_ENOUGH_NUM(thisterm, precision));
 
     DESTROYTAYLOR();
 }
@@ -198,15 +196,15 @@ void acosrat(PRAT* px, uint32_t radix, int32_t precision)
     (*px)->pp->sign = 1;
     (*px)->pq->sign = 1;
 
-    if (rat_equ(*px, rat_one, precision))
+    if (rat_equ(*px, g_ratpack->rat_one, precision))
     {
         if (sgn == -1)
         {
-            DUPRAT(*px, pi);
+            DUPRAT(*px, g_ratpack->pi);
         }
         else
         {
-            DUPRAT(*px, rat_zero);
+            DUPRAT(*px, g_ratpack->rat_zero);
         }
     }
     else
@@ -214,7 +212,7 @@ void acosrat(PRAT* px, uint32_t radix, int32_t precision)
         (*px)->pp->sign = sgn;
         asinrat(px, radix, precision);
         (*px)->pp->sign *= -1;
-        addrat(px, pi_over_two, precision);
+        addrat(px, g_ratpack->pi_over_two, precision);
     }
 }
 
@@ -240,13 +238,16 @@ void acosrat(PRAT* px, uint32_t radix, int32_t precision)
 //   thisterm  = X ;  and stop when thisterm < precision used.
 //           0                              n
 //
-//   If abs(x) > 0.85 then an alternate form is used
-//      asin(x/sqrt(q+x^2))
+//   If abs(x) > 1/2 then this form is used.
+//
+//   pi/4 + atan((x-1)/(x+1))
 //
 //   And if abs(x) > 2.0 then this form is used.
 //
 //   pi/2 - atan(1/x)
 //
+//   At high precision the series is summed by binary splitting instead.
+//
 //-----------------------------------------------------------------------------
 
 void atananglerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_t precision)
@@ -259,24 +260,56 @@ void atananglerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_
 void _atanrat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
-
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
+    PRAT pi_over_four = nullptr;
+    int32_t sgn = SIGN(*px);
 
-    DUPNUM(n2, num_one);
+    (*px)->pp->sign = 1;
+    (*px)->pq->sign = 1;
 
-    xx->pp->sign *= -1;
+    if (rat_gt(*px, g_ratpack->rat_half, precision))
+    {
+        PRAT pdenom = nullptr;
+        DUPRAT(pdenom, *px);
+        addrat(&pdenom, g_ratpack->rat_one, precision);
+        subrat(px, g_ratpack->rat_one, precision);
+        divrat(px, pdenom, precision);
+        destroyrat(pdenom);
+        DUPRAT(pi_over_four, g_ratpack->pi_over_two);
+        divrat(&pi_over_four, g_ratpack->rat_two, precision);
+    }
 
-    do
+    if (_bsfaster(SERIES_ATAN, precision))
+    {
+        _bsatanrat(px, false, precision);
+    }
+    else
     {
-        NEXTTERM(xx, MULNUM(n2) INC(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+        CREATETAYLOR();
 
-    DESTROYTAYLOR();
+        DUPNUM(pret, x);
+        DUPNUM(thisterm, x);
+
+        DUPNUM(n2, g_ratpack->num_one);
+
+        xx->sign *= -1;
+
+        do
+        {
+            NEXTTERM(xx, MULNUM(n2) INC(n2) INC(n2) DIVNUM(n2), precision);
+        } while (!SMALL_ENOUGH_NUM(thisterm, precision));
+
+        DESTROYTAYLOR();
+    }
+
+    if (pi_over_four != nullptr)
+    {
+        addrat(px, pi_over_four, precision);
+        destroyrat(pi_over_four);
+    }
+    (*px)->pp->sign *= sgn;
 }
 
-void atanrat(PRAT* px, uint32_t radix, int32_t precision)
+void atanrat(PRAT* px, uint32_t /*radix*/, int32_t precision)
 
 {
     PRAT tmpx = nullptr;
@@ -285,34 +318,18 @@ void atanrat(PRAT* px, uint32_t radix, int32_t precision)
     (*px)->pp->sign = 1;
     (*px)->pq->sign = 1;
 
-    if (rat_gt((*px), pt_eight_five, precision))
+    if (rat_gt((*px), g_ratpack->rat_two, precision))
     {
-        if (rat_gt((*px), rat_two, precision))
-        {
-            (*px)->pp->sign = sgn;
-            (*px)->pq->sign = 1;
-            DUPRAT(tmpx, rat_one);
-            divrat(&tmpx, (*px), precision);
-            _atanrat(&tmpx, precision);
-            tmpx->pp->sign = sgn;
-            tmpx->pq->sign = 1;
-            DUPRAT(*px, pi_over_two);
-            subrat(px, tmpx, precision);
-            destroyrat(tmpx);
-        }
-        else
-        {
-            (*px)->pp->sign = sgn;
-            DUPRAT(tmpx, *px);
-            mulrat(&tmpx, *px, precision);
-            addrat(&tmpx, rat_one, precision);
-            rootrat(&tmpx, rat_two, radix, precision);
-            divrat(px, tmpx, precision);
-            destroyrat(tmpx);
-            asinrat(px, radix, precision);
-            (*px)->pp->sign = sgn;
-            (*px)->pq->sign = 1;
-        }
+        (*px)->pp->sign = sgn;
+        (*px)->pq->sign = 1;
+        DUPRAT(tmpx, g_ratpack->rat_one);
+        divrat(&tmpx, (*px), precision);
+        _atanrat(&tmpx, precision);
+        tmpx->pp->sign = sgn;
+        tmpx->pq->sign = 1;
+        DUPRAT(*px, g_ratpack->pi_over_two);
+        subrat(px, tmpx, precision);
+        destroyrat(tmpx);
     }
     else
     {
@@ -320,8 +337,8 @@ void atanrat(PRAT* px, uint32_t radix, int32_t precision)
         (*px)->pq->sign = 1;
         _atanrat(px, precision);
     }
-    if (rat_gt(*px, pi_over_two, precision))
+    if (rat_gt(*px, g_ratpack->pi_over_two, precision))
     {
-        subrat(px, pi, precision);
+        subrat(px, g_ratpack->pi, precision);
     }
 }
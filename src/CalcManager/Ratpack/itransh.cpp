@@ -52,15 +52,15 @@ void asinhrat(PRAT* px, uint32_t radix, int32_t precision)
 {
     PRAT neg_pt_eight_five = nullptr;
 
-    DUPRAT(neg_pt_eight_five, pt_eight_five);
+    DUPRAT(neg_pt_eight_five, g_ratpack->pt_eight_five);
     neg_pt_eight_five->pp->sign *= -1;
-    if (rat_gt(*px, pt_eight_five, precision) || rat_lt(*px, neg_pt_eight_five, precision))
+    if (rat_gt(*px, g_ratpack->pt_eight_five, precision) || rat_lt(*px, neg_pt_eight_five, precision))
     {
         PRAT ptmp = nullptr;
         DUPRAT(ptmp, (*px));
         mulrat(&ptmp, *px, precision);
-        addrat(&ptmp, rat_one, precision);
-        rootrat(&ptmp, rat_two, radix, precision);
+        addrat(&ptmp, g_ratpack->rat_one, precision);
+        rootrat(&ptmp, g_ratpack->rat_two, radix, precision);
         addrat(px, ptmp, precision);
         lograt(px, precision);
         destroyrat(ptmp);
@@ -68,17 +68,17 @@ void asinhrat(PRAT* px, uint32_t radix, int32_t precision)
     else
     {
         CREATETAYLOR();
-        xx->pp->sign *= -1;
+        xx->sign *= -1;
 
-        DUPRAT(pret, (*px));
-        DUPRAT(thisterm, (*px));
+        DUPNUM(pret, x);
+        DUPNUM(thisterm, x);
 
-        DUPNUM(n2, num_one);
+        DUPNUM(n2, g_ratpack->num_one);
 
         do
         {
             NEXTTERM(xx, MULNUM(n2) MULNUM(n2) INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-        } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+        } while (!SMALL_ENOUGH_NUM(thisterm, precision));
 
         DESTROYTAYLOR();
     }
@@ -104,7 +104,7 @@ void asinhrat(PRAT* px, uint32_t radix, int32_t precision)
 void acoshrat(PRAT* px, uint32_t radix, int32_t precision)
 
 {
-    if (rat_lt(*px, rat_one, precision))
+    if (rat_lt(*px, g_ratpack->rat_one, precision))
     {
         throw CALC_E_DOMAIN;
     }
@@ -113,8 +113,8 @@ void acoshrat(PRAT* px, uint32_t radix, int32_t precision)
         PRAT ptmp = nullptr;
         DUPRAT(ptmp, (*px));
         mulrat(&ptmp, *px, precision);
-        subrat(&ptmp, rat_one, precision);
-        rootrat(&ptmp, rat_two, radix, precision);
+        subrat(&ptmp, g_ratpack->rat_one, precision);
+        rootrat(&ptmp, g_ratpack->rat_two, radix, precision);
         addrat(px, ptmp, precision);
         lograt(px, precision);
         destroyrat(ptmp);
@@ -143,11 +143,11 @@ void atanhrat(PRAT* px, int32_t precision)
 {
     PRAT ptmp = nullptr;
     DUPRAT(ptmp, (*px));
-    subrat(&ptmp, rat_one, precision);
-    addrat(px, rat_one, precision);
+    subrat(&ptmp, g_ratpack->rat_one, precision);
+    addrat(px, g_ratpack->rat_one, precision);
     divrat(px, ptmp, precision);
     (*px)->pp->sign *= -1;
     lograt(px, precision);
-    divrat(px, rat_two, precision);
+    divrat(px, g_ratpack->rat_two, precision);
     destroyrat(ptmp);
 }
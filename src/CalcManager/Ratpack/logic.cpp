@@ -17,49 +17,117 @@
 
 using namespace std;
 
-void lshrat(PRAT* pa, PRAT b, uint32_t radix, int32_t precision)
+//---------------------------------------------------------------------------
+//
+//    FUNCTION: _shlnum
+//
+//    ARGUMENTS: pointer to a number and a count of bits.
+//
+//    RETURN: None, changes pointer.
+//
+//    DESCRIPTION: Does *pa <<= bits on the magnitude, the whole BASEX
+//    digits of the shift just move the exponent and the rest is a single
+//    pass of bit shifts over the mantissa.
+//
+//---------------------------------------------------------------------------
+
+void _shlnum(PNUMBER* pa, uint32_t bits)
 
 {
-    PRAT pwr = nullptr;
-    int32_t intb;
+    PNUMBER a = *pa;
+    if (zernum(a))
+    {
+        return;
+    }
+
+    const int32_t shift = static_cast<int32_t>(bits % BASEXPWR);
+    if (shift != 0)
+    {
+        MANTTYPE carry = a->mant[a->cdigit - 1] >> (BASEXPWR - shift);
+        if (carry != 0 && zsize(a) < sizeof(NUMBER) + (a->cdigit + 1) * sizeof(MANTTYPE))
+        {
+            PNUMBER c = nullptr;
+            createnum(c, a->cdigit + 1);
+            _dupnum(c, a);
+            destroynum(*pa);
+            *pa = a = c;
+        }
 
+        for (int32_t i = a->cdigit - 1; i > 0; i--)
+        {
+            a->mant[i] = ((a->mant[i] << shift) & BASEXMAX) | (a->mant[i - 1] >> (BASEXPWR - shift));
+        }
+        a->mant[0] = (a->mant[0] << shift) & BASEXMAX;
+        if (carry != 0)
+        {
+            a->mant[a->cdigit++] = carry;
+        }
+    }
+    a->exp += static_cast<int32_t>(bits / BASEXPWR);
+}
+
+//---------------------------------------------------------------------------
+//
+//    FUNCTION: shiftrat
+//
+//    ARGUMENTS: pointer to a rational and a count of bits.
+//
+//    RETURN: None, changes pointer.
+//
+//    DESCRIPTION: Does *pa *= 2^bits, shifting the top of the rational for
+//    a positive count and the bottom for a negative one, trimmed the way
+//    mulrat would.
+//
+//---------------------------------------------------------------------------
+
+void shiftrat(PRAT* pa, int32_t bits, int32_t precision)
+
+{
+    if (bits >= 0)
+    {
+        _shlnum(&((*pa)->pp), static_cast<uint32_t>(bits));
+    }
+    else
+    {
+        _shlnum(&((*pa)->pq), 0u - static_cast<uint32_t>(bits));
+    }
+    trimit(pa, precision);
+}
+
+void lshrat(PRAT* pa, PRAT b, uint32_t radix, int32_t precision)
+
+{
     intrat(pa, radix, precision);
     if (!zernum((*pa)->pp))
     {
         // If input is zero we're done.
-        if (rat_gt(b, rat_max_exp, precision))
+        if (rat_gt(b, g_ratpack->rat_max_exp, precision))
         {
             // Don't attempt lsh of anything big
             throw(CALC_E_DOMAIN);
         }
-        intb = rattoi32(b, radix, precision);
-        DUPRAT(pwr, rat_two);
-        ratpowi32(&pwr, intb, precision);
-        mulrat(pa, pwr, precision);
-        destroyrat(pwr);
+        shiftrat(pa, rattoi32(b, radix, precision), precision);
     }
 }
 
 void rshrat(PRAT* pa, PRAT b, uint32_t radix, int32_t precision)
 
 {
-    PRAT pwr = nullptr;
-    int32_t intb;
-
     intrat(pa, radix, precision);
     if (!zernum((*pa)->pp))
     {
         // If input is zero we're done.
-        if (rat_lt(b, rat_min_exp, precision))
+        if (rat_lt(b, g_ratpack->rat_min_exp, precision))
         {
             // Don't attempt rsh of anything big and negative.
             throw(CALC_E_DOMAIN);
         }
-        intb = rattoi32(b, radix, precision);
-        DUPRAT(pwr, rat_two);
-        ratpowi32(&pwr, intb, precision);
-        divrat(pa, pwr, precision);
-        destroyrat(pwr);
+        int32_t intb = rattoi32(b, radix, precision);
+        if (intb == INT32_MIN)
+        {
+            throw(CALC_E_DOMAIN);
+        }
+        shiftrat(pa, -intb, precision);
     }
 }
 
@@ -123,8 +191,8 @@ void boolrat(PRAT* pa, PRAT b, int func, uint32_t radix, int32_t precision)
 //
 //    RETURN: None, changes first pointer.
 //
-//    DESCRIPTION: Does the number equivalent of *pa &= b.
-//    radix doesn't matter for logicals.
+//    DESCRIPTION: Does the number equivalent of *pa op= b on whole BASEX
+//    digits, radix doesn't matter for logicals.
 //    WARNING: Assumes numbers are unsigned.
 //
 //---------------------------------------------------------------------------
@@ -133,43 +201,53 @@ void boolnum(PNUMBER* pa, PNUMBER b, int func)
 
 {
     PNUMBER c = nullptr;
-    PNUMBER a = nullptr;
-    MANTTYPE* pcha;
-    MANTTYPE* pchb;
-    MANTTYPE* pchc;
-    int32_t cdigits;
-    int32_t mexp;
-    MANTTYPE da;
-    MANTTYPE db;
-
-    a = *pa;
-    cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - min(a->exp, b->exp);
+    PNUMBER a = *pa;
+    int32_t mexp = min(a->exp, b->exp);
+    int32_t cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - mexp;
+
     createnum(c, cdigits);
-    c->exp = min(a->exp, b->exp);
-    mexp = c->exp;
+    c->exp = mexp;
     c->cdigit = cdigits;
-    pcha = a->mant;
-    pchb = b->mant;
-    pchc = c->mant;
-    for (; cdigits > 0; cdigits--, mexp++)
+    c->sign = a->sign;
+
+    // Line both mantissas up against c, then each op is one pass of whole
+    // digits with no per digit range checks.
+    MANTTYPE* pchc = c->mant;
+    const MANTTYPE* pcha = a->mant;
+    const MANTTYPE* pchb = b->mant;
+    int32_t offa = a->exp - mexp;
+    int32_t offb = b->exp - mexp;
+    if (func == FUNC_AND)
     {
-        da = (((mexp >= a->exp) && (cdigits + a->exp - c->exp > (c->cdigit - a->cdigit))) ? *pcha++ : 0);
-        db = (((mexp >= b->exp) && (cdigits + b->exp - c->exp > (c->cdigit - b->cdigit))) ? *pchb++ : 0);
-        switch (func)
+        // Only the digits a and b share can be nonzero, c starts out zeroed.
+        int32_t lo = max(offa, offb);
+        int32_t hi = min(offa + a->cdigit, offb + b->cdigit);
+        for (int32_t i = lo; i < hi; i++)
         {
-        case FUNC_AND:
-            *pchc++ = da & db;
-            break;
-        case FUNC_OR:
-            *pchc++ = da | db;
-            break;
-        case FUNC_XOR:
-            *pchc++ = da ^ db;
-            break;
+            pchc[i] = pcha[i - offa] & pchb[i - offb];
         }
     }
-    c->sign = a->sign;
-    while (c->cdigit > 1 && *(--pchc) == 0)
+    else
+    {
+        memcpy(pchc + offa, pcha, a->cdigit * sizeof(MANTTYPE));
+        pchc += offb;
+        if (func == FUNC_OR)
+        {
+            for (int32_t i = 0; i < b->cdigit; i++)
+            {
+                pchc[i] |= pchb[i];
+            }
+        }
+        else
+        {
+            for (int32_t i = 0; i < b->cdigit; i++)
+            {
+                pchc[i] ^= pchb[i];
+            }
+        }
+    }
+
+    while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
     {
         c->cdigit--;
     }
@@ -177,6 +255,63 @@ void boolnum(PNUMBER* pa, PNUMBER b, int func)
     *pa = c;
 }
 
+//---------------------------------------------------------------------------
+//
+//    FUNCTION: _popcountnum
+//
+//    ARGUMENTS: a number
+//
+//    RETURN: The count of set bits in the magnitude of the number.
+//
+//    DESCRIPTION: Only the integer part of a BASEX number is counted,
+//    digits below the point are ignored.
+//
+//---------------------------------------------------------------------------
+
+int32_t _popcountnum(PNUMBER a)
+
+{
+    int32_t count = 0;
+    for (int32_t i = max(0, -a->exp); i < a->cdigit; i++)
+    {
+        for (MANTTYPE d = a->mant[i]; d != 0; d &= d - 1)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------
+//
+//    FUNCTION: _ctznum
+//
+//    ARGUMENTS: a number
+//
+//    RETURN: The count of trailing zero bits of a nonzero integer number,
+//    0 for zero.
+//
+//---------------------------------------------------------------------------
+
+int32_t _ctznum(PNUMBER a)
+
+{
+    for (int32_t i = 0; i < a->cdigit; i++)
+    {
+        MANTTYPE d = a->mant[i];
+        if (d != 0)
+        {
+            int32_t count = (a->exp + i) * BASEXPWR;
+            for (; (d & 1) == 0; d >>= 1)
+            {
+                count++;
+            }
+            return count;
+        }
+    }
+    return 0;
+}
+
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: remrat
@@ -0,0 +1,158 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           mantissa.h
+//
+//
+//  Description
+//
+//     Digit level helpers shared by the mantissa kernels (mul.cpp, div.cpp).
+//  They work on raw little endian digit arrays, the radix is supplied by a
+//  digit traits object so the power of two internal radix BASEX can use
+//  shifts and masks while the display radices use division.
+//
+//-----------------------------------------------------------------------------
+
+#include "ratpak.h"
+
+// Digit arithmetic for the internal BASEX radix, a power of two that may be
+// a full MANTTYPE word.
+struct BASEXDIGITS
+{
+    MANTTYPE lo(TWO_MANTTYPE v) const
+    {
+        return (MANTTYPE)(v & BASEXMAX);
+    }
+    TWO_MANTTYPE hi(TWO_MANTTYPE v) const
+    {
+        return v >> BASEXPWR;
+    }
+    TWO_MANTTYPE radix() const
+    {
+        return (TWO_MANTTYPE)1 << BASEXPWR;
+    }
+};
+
+// Digit arithmetic for any other radix.
+struct RADIXDIGITS
+{
+    TWO_MANTTYPE r;
+
+    MANTTYPE lo(TWO_MANTTYPE v) const
+    {
+        return (MANTTYPE)(v % r);
+    }
+    TWO_MANTTYPE hi(TWO_MANTTYPE v) const
+    {
+        return v / r;
+    }
+    TWO_MANTTYPE radix() const
+    {
+        return r;
+    }
+};
+
+// Number of digits of a[0..na) without leading zeros.
+inline int32_t _mantlen(const MANTTYPE* a, int32_t na)
+{
+    while (na > 0 && a[na - 1] == 0)
+    {
+        na--;
+    }
+    return na;
+}
+
+// Returns -1, 0 or 1 as a[0..na) is less than, equal to or greater than b[0..nb).
+inline int32_t _mantcmp(const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb)
+{
+    na = _mantlen(a, na);
+    nb = _mantlen(b, nb);
+    if (na != nb)
+    {
+        return na < nb ? -1 : 1;
+    }
+    while (na-- > 0)
+    {
+        if (a[na] != b[na])
+        {
+            return a[na] < b[na] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// c[0..nc) += a[0..na), returns the carry out of c.
+template <typename T>
+MANTTYPE _mantaddto(const T& t, MANTTYPE* c, int32_t nc, const MANTTYPE* a, int32_t na)
+{
+    TWO_MANTTYPE cy = 0;
+    int32_t i = 0;
+    for (; i < na; i++)
+    {
+        cy += (TWO_MANTTYPE)c[i] + a[i];
+        c[i] = t.lo(cy);
+        cy = t.hi(cy);
+    }
+    for (; cy && i < nc; i++)
+    {
+        cy += c[i];
+        c[i] = t.lo(cy);
+        cy = t.hi(cy);
+    }
+    return (MANTTYPE)cy;
+}
+
+// c[0..nc) -= a[0..na), returns the borrow out of c which is zero when c >= a.
+template <typename T>
+MANTTYPE _mantsubfrom(const T& t, MANTTYPE* c, int32_t nc, const MANTTYPE* a, int32_t na)
+{
+    MANTTYPE borrow = 0;
+    int32_t i = 0;
+    for (; i < na; i++)
+    {
+        TWO_MANTTYPE sub = (TWO_MANTTYPE)a[i] + borrow;
+        if (c[i] >= sub)
+        {
+            c[i] = (MANTTYPE)(c[i] - sub);
+            borrow = 0;
+        }
+        else
+        {
+            c[i] = (MANTTYPE)(t.radix() + c[i] - sub);
+            borrow = 1;
+        }
+    }
+    for (; borrow && i < nc; i++)
+    {
+        if (c[i] != 0)
+        {
+            c[i]--;
+            borrow = 0;
+        }
+        else
+        {
+            c[i] = (MANTTYPE)(t.radix() - 1);
+        }
+    }
+    return borrow;
+}
+
+// r = a + b, r must have room for max(na, nb) + 1 digits, returns the
+// number of digits used.
+template <typename T>
+int32_t _mantadd(const T& t, MANTTYPE* r, const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb)
+{
+    if (na < nb)
+    {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    memcpy(r, a, na * sizeof(MANTTYPE));
+    r[na] = 0;
+    _mantaddto(t, r, na + 1, b, nb);
+    return na + 1;
+}
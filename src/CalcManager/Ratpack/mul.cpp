@@ -0,0 +1,406 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           mul.cpp
+//
+//
+//  Description
+//
+//     Contains the size dispatched mantissa multiplication engine used by
+//  mulnum and mulnumx.  Small operands use the grade school algorithm, mid
+//  sized operands use Karatsuba, large operands use Toom-3 and huge ones
+//  the NTT in ntt.cpp.  All the algorithms work on raw little endian digit
+//  arrays in any radix.  A number multiplied by itself takes the squaring
+//  variants, which share the work of the symmetric partial products.
+//
+//-----------------------------------------------------------------------------
+#include <vector>
+#include "ratpak.h"
+#include "mantissa.h"
+
+using namespace std;
+
+// Crossover table for the multiply algorithms, see MULCROSSOVER.  The
+// defaults were measured on x86-64 with BASEX digits: Karatsuba wins from
+// about 32 digits, Toom-3 from about 128 and the NTT from about 3500.
+// Grade school squaring does half the digit products so Karatsuba squaring
+// only wins from about 48 digits.
+MULCROSSOVER g_mulcrossover = { 32, 128, 3500, 48 };
+
+namespace
+{
+    // A signed digit array, used by Toom-3 where evaluating at negative
+    // points gives negative intermediate values.
+    struct SIGNEDDIGITS
+    {
+        vector<MANTTYPE> d;
+        bool neg = false;
+    };
+
+    template <typename T>
+    void mulschool(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb)
+    {
+        memset(c, 0, (na + nb) * sizeof(MANTTYPE));
+        for (int32_t ia = 0; ia < na; ia++)
+        {
+            TWO_MANTTYPE da = a[ia];
+            if (da == 0)
+            {
+                continue;
+            }
+            MANTTYPE* pc = c + ia;
+            TWO_MANTTYPE cy = 0;
+            for (int32_t ib = 0; ib < nb; ib++)
+            {
+                cy += (TWO_MANTTYPE)pc[ib] + da * b[ib];
+                pc[ib] = t.lo(cy);
+                cy = t.hi(cy);
+            }
+            pc[nb] = (MANTTYPE)cy;
+        }
+    }
+
+    template <typename T>
+    void muldigits(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb);
+
+    // Karatsuba, splits both operands at m digits so that
+    // a*b = z2*R^2m + ((a0+a1)(b0+b1) - z0 - z2)*R^m + z0
+    template <typename T>
+    void mulkaratsuba(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb)
+    {
+        int32_t m = na / 2;
+        int32_t nc = na + nb;
+
+        muldigits(t, c, a, m, b, m);
+        muldigits(t, c + 2 * m, a + m, na - m, b + m, nb - m);
+
+        vector<MANTTYPE> scratch((na - m + 1) * 2 + (na - m + 1) * 2, 0);
+        MANTTYPE* sa = scratch.data();
+        MANTTYPE* sb = sa + (na - m + 1);
+        MANTTYPE* z1 = sb + (na - m + 1);
+        int32_t nsa = _mantlen(sa, _mantadd(t, sa, a, m, a + m, na - m));
+        int32_t nsb = _mantlen(sb, _mantadd(t, sb, b, m, b + m, nb - m));
+        muldigits(t, z1, sa, nsa, sb, nsb);
+
+        int32_t nz1 = nsa + nsb;
+        _mantsubfrom(t, z1, nz1, c, _mantlen(c, 2 * m));
+        _mantsubfrom(t, z1, nz1, c + 2 * m, _mantlen(c + 2 * m, nc - 2 * m));
+        _mantaddto(t, c + m, nc - m, z1, _mantlen(z1, nz1));
+    }
+
+    template <typename T>
+    void sqrdigits(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na);
+
+    // Grade school squaring, each product a[i]*a[j] with i < j is worked out
+    // once and doubled, then the squares a[i]*a[i] are added on the diagonal.
+    template <typename T>
+    void sqrschool(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na)
+    {
+        memset(c, 0, 2 * na * sizeof(MANTTYPE));
+        for (int32_t ia = 0; ia < na - 1; ia++)
+        {
+            TWO_MANTTYPE da = a[ia];
+            if (da == 0)
+            {
+                continue;
+            }
+            MANTTYPE* pc = c + 2 * ia + 1;
+            TWO_MANTTYPE cy = 0;
+            for (int32_t ib = ia + 1; ib < na; ib++)
+            {
+                cy += (TWO_MANTTYPE)*pc + da * a[ib];
+                *pc++ = t.lo(cy);
+                cy = t.hi(cy);
+            }
+            *pc = (MANTTYPE)cy;
+        }
+
+        TWO_MANTTYPE cy = 0;
+        for (int32_t ia = 0; ia < na; ia++)
+        {
+            TWO_MANTTYPE sq = (TWO_MANTTYPE)a[ia] * a[ia];
+            cy += 2 * (TWO_MANTTYPE)c[2 * ia] + t.lo(sq);
+            c[2 * ia] = t.lo(cy);
+            cy = t.hi(cy);
+            cy += 2 * (TWO_MANTTYPE)c[2 * ia + 1] + t.hi(sq);
+            c[2 * ia + 1] = t.lo(cy);
+            cy = t.hi(cy);
+        }
+    }
+
+    // Karatsuba squaring, a^2 = z2*R^2m + ((a0+a1)^2 - z0 - z2)*R^m + z0
+    // takes three squares of half the length.
+    template <typename T>
+    void sqrkaratsuba(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na)
+    {
+        int32_t m = na / 2;
+        int32_t nc = 2 * na;
+
+        sqrdigits(t, c, a, m);
+        sqrdigits(t, c + 2 * m, a + m, na - m);
+
+        vector<MANTTYPE> scratch((na - m + 1) * 3, 0);
+        MANTTYPE* sa = scratch.data();
+        MANTTYPE* z1 = sa + (na - m + 1);
+        int32_t nsa = _mantlen(sa, _mantadd(t, sa, a, m, a + m, na - m));
+        sqrdigits(t, z1, sa, nsa);
+
+        int32_t nz1 = 2 * nsa;
+        _mantsubfrom(t, z1, nz1, c, _mantlen(c, 2 * m));
+        _mantsubfrom(t, z1, nz1, c + 2 * m, _mantlen(c + 2 * m, nc - 2 * m));
+        _mantaddto(t, c + m, nc - m, z1, _mantlen(z1, nz1));
+    }
+
+    template <typename T>
+    void sadd(const T& t, SIGNEDDIGITS& r, const SIGNEDDIGITS& a, const SIGNEDDIGITS& b, bool negateb)
+    {
+        bool bneg = b.neg != negateb;
+        int32_t na = (int32_t)a.d.size();
+        int32_t nb = (int32_t)b.d.size();
+        vector<MANTTYPE> d(max(na, nb) + 1, 0);
+        bool neg;
+        if (a.neg == bneg)
+        {
+            _mantadd(t, d.data(), a.d.data(), na, b.d.data(), nb);
+            neg = a.neg;
+        }
+        else if (_mantcmp(a.d.data(), na, b.d.data(), nb) >= 0)
+        {
+            memcpy(d.data(), a.d.data(), na * sizeof(MANTTYPE));
+            _mantsubfrom(t, d.data(), na, b.d.data(), nb);
+            neg = a.neg;
+        }
+        else
+        {
+            memcpy(d.data(), b.d.data(), nb * sizeof(MANTTYPE));
+            _mantsubfrom(t, d.data(), nb, a.d.data(), na);
+            neg = bneg;
+        }
+        d.resize(_mantlen(d.data(), (int32_t)d.size()));
+        r.d.swap(d);
+        r.neg = neg && !r.d.empty();
+    }
+
+    // a *= multiplier, for multipliers well below the radix.
+    template <typename T>
+    void smulsmall(const T& t, SIGNEDDIGITS& a, MANTTYPE multiplier)
+    {
+        TWO_MANTTYPE cy = 0;
+        for (MANTTYPE& digit : a.d)
+        {
+            cy += (TWO_MANTTYPE)digit * multiplier;
+            digit = t.lo(cy);
+            cy = t.hi(cy);
+        }
+        while (cy)
+        {
+            a.d.push_back(t.lo(cy));
+            cy = t.hi(cy);
+        }
+    }
+
+    // a /= divisor, the division must be exact.
+    template <typename T>
+    void sdivexact(const T& t, SIGNEDDIGITS& a, MANTTYPE divisor)
+    {
+        TWO_MANTTYPE rem = 0;
+        for (size_t i = a.d.size(); i-- > 0;)
+        {
+            rem = rem * t.radix() + a.d[i];
+            a.d[i] = (MANTTYPE)(rem / divisor);
+            rem %= divisor;
+        }
+        a.d.resize(_mantlen(a.d.data(), (int32_t)a.d.size()));
+        a.neg = a.neg && !a.d.empty();
+    }
+
+    template <typename T>
+    void smul(const T& t, SIGNEDDIGITS& r, const SIGNEDDIGITS& a, const SIGNEDDIGITS& b)
+    {
+        int32_t na = (int32_t)a.d.size();
+        int32_t nb = (int32_t)b.d.size();
+        r.d.assign(na + nb, 0);
+        if (na > 0 && nb > 0)
+        {
+            muldigits(t, r.d.data(), a.d.data(), na, b.d.data(), nb);
+        }
+        r.d.resize(_mantlen(r.d.data(), na + nb));
+        r.neg = (a.neg != b.neg) && !r.d.empty();
+    }
+
+    void spart(SIGNEDDIGITS& r, const MANTTYPE* a, int32_t na, int32_t start, int32_t len)
+    {
+        len = min(len, na - start);
+        r.d.clear();
+        r.neg = false;
+        if (len > 0)
+        {
+            r.d.assign(a + start, a + start + _mantlen(a + start, len));
+        }
+    }
+
+    // Toom-3, splits both operands into three k digit pieces, evaluates at
+    // 0, 1, -1, -2 and infinity, multiplies pointwise and interpolates back
+    // using Bodrato's sequence.
+    template <typename T>
+    void multoom3(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb)
+    {
+        int32_t k = (na + 2) / 3;
+        int32_t nc = na + nb;
+        SIGNEDDIGITS a0, a1, a2, b0, b1, b2;
+        spart(a0, a, na, 0, k);
+        spart(a1, a, na, k, k);
+        spart(a2, a, na, 2 * k, na);
+        spart(b0, b, nb, 0, k);
+        spart(b1, b, nb, k, k);
+        spart(b2, b, nb, 2 * k, nb);
+
+        SIGNEDDIGITS tmp, p1, pm1, pm2, q1, qm1, qm2;
+
+        // p(1) = a0 + a1 + a2, p(-1) = a0 - a1 + a2, p(-2) = 2*(p(-1) + a2) - a0
+        sadd(t, tmp, a0, a2, false);
+        sadd(t, p1, tmp, a1, false);
+        sadd(t, pm1, tmp, a1, true);
+        sadd(t, pm2, pm1, a2, false);
+        smulsmall(t, pm2, 2);
+        sadd(t, pm2, pm2, a0, true);
+
+        // A square evaluates once and the pointwise products are squares.
+        bool square = a == b && na == nb;
+        if (!square)
+        {
+            sadd(t, tmp, b0, b2, false);
+            sadd(t, q1, tmp, b1, false);
+            sadd(t, qm1, tmp, b1, true);
+            sadd(t, qm2, qm1, b2, false);
+            smulsmall(t, qm2, 2);
+            sadd(t, qm2, qm2, b0, true);
+        }
+
+        SIGNEDDIGITS r0, r1, rm1, rm2, rinf;
+        smul(t, r0, a0, square ? a0 : b0);
+        smul(t, r1, p1, square ? p1 : q1);
+        smul(t, rm1, pm1, square ? pm1 : qm1);
+        smul(t, rm2, pm2, square ? pm2 : qm2);
+        smul(t, rinf, a2, square ? a2 : b2);
+
+        // Interpolation
+        SIGNEDDIGITS c1, c2, c3;
+        sadd(t, c3, rm2, r1, true);
+        sdivexact(t, c3, 3);
+        sadd(t, c1, r1, rm1, true);
+        sdivexact(t, c1, 2);
+        sadd(t, c2, rm1, r0, true);
+        sadd(t, c3, c2, c3, true);
+        sdivexact(t, c3, 2);
+        sadd(t, c3, c3, rinf, false);
+        sadd(t, c3, c3, rinf, false);
+        sadd(t, c2, c2, c1, false);
+        sadd(t, c2, c2, rinf, true);
+        sadd(t, c1, c1, c3, true);
+
+        memset(c, 0, nc * sizeof(MANTTYPE));
+        const SIGNEDDIGITS* coeffs[] = { &r0, &c1, &c2, &c3, &rinf };
+        for (int32_t i = 0; i < 5; i++)
+        {
+            const vector<MANTTYPE>& d = coeffs[i]->d;
+            if (!d.empty())
+            {
+                _mantaddto(t, c + i * k, nc - i * k, d.data(), (int32_t)d.size());
+            }
+        }
+    }
+
+    // c[0..2na) = a[0..na)^2, picks the algorithm by size.
+    template <typename T>
+    void sqrdigits(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na)
+    {
+        if (na < g_mulcrossover.sqrkaratsuba)
+        {
+            sqrschool(t, c, a, na);
+        }
+        else if (na < g_mulcrossover.toom3)
+        {
+            sqrkaratsuba(t, c, a, na);
+        }
+        else if (na < g_mulcrossover.ntt || !_mulmantntt(c, a, na, a, na, (uint32_t)t.radix()))
+        {
+            multoom3(t, c, a, na, a, na);
+        }
+    }
+
+    // c[0..na+nb) = a[0..na) * b[0..nb), picks the algorithm by size.
+    template <typename T>
+    void muldigits(const T& t, MANTTYPE* c, const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb)
+    {
+        if (a == b && na == nb)
+        {
+            sqrdigits(t, c, a, na);
+            return;
+        }
+
+        if (na < nb)
+        {
+            swap(a, b);
+            swap(na, nb);
+        }
+
+        if (nb < g_mulcrossover.karatsuba)
+        {
+            mulschool(t, c, a, na, b, nb);
+        }
+        else if (2 * nb <= na)
+        {
+            // Very unbalanced, multiply b by nb sized slices of a so the
+            // recursive algorithms always see balanced operands.
+            vector<MANTTYPE> slice(2 * nb);
+            memset(c, 0, (na + nb) * sizeof(MANTTYPE));
+            for (int32_t offset = 0; offset < na; offset += nb)
+            {
+                int32_t len = min(nb, na - offset);
+                muldigits(t, slice.data(), a + offset, len, b, nb);
+                _mantaddto(t, c + offset, na + nb - offset, slice.data(), _mantlen(slice.data(), len + nb));
+            }
+        }
+        else if (nb < g_mulcrossover.toom3)
+        {
+            mulkaratsuba(t, c, a, na, b, nb);
+        }
+        else if (nb < g_mulcrossover.ntt || !_mulmantntt(c, a, na, b, nb, (uint32_t)t.radix()))
+        {
+            multoom3(t, c, a, na, b, nb);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _mulmant
+//
+//    ARGUMENTS: pointer to the result mantissa, the two mantissas to
+//               multiply with their digit counts, and the radix.
+//
+//    RETURN: None, fills in the result mantissa.
+//
+//    DESCRIPTION: Does c = a * b on raw mantissas, the algorithm is picked
+//    from the g_mulcrossover table by the size of the shorter operand.
+//    c must have room for
+//    cdigita + cdigitb digits and must not overlap a or b. The digits of c
+//    are not normalized, the top digit may be zero.
+//
+//----------------------------------------------------------------------------
+
+void _mulmant(_Out_ MANTTYPE* c, _In_ const MANTTYPE* a, int32_t cdigita, _In_ const MANTTYPE* b, int32_t cdigitb, uint32_t radix)
+
+{
+    if (radix == BASEX)
+    {
+        muldigits(BASEXDIGITS{}, c, a, cdigita, b, cdigitb);
+    }
+    else
+    {
+        muldigits(RADIXDIGITS{ radix }, c, a, cdigita, b, cdigitb);
+    }
+}
@@ -0,0 +1,284 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           ntt.cpp
+//
+//
+//  Description
+//
+//     Contains the number theoretic transform multiply used by _mulmant for
+//  very large operands.  The digits are convolved modulo three NTT friendly
+//  primes and the exact convolution is rebuilt with the chinese remainder
+//  theorem, so the result is exact and does not depend on floating point.
+//
+//-----------------------------------------------------------------------------
+#include <vector>
+#include "ratpak.h"
+
+using namespace std;
+
+// The primes are all of the form k*2^n+1 with 3 as a primitive root, the
+// first one limits the transform length to 2^23.
+static constexpr uint32_t NTT_PRIMES[] = { 998244353, 167772161, 469762049 };
+static constexpr uint32_t NTT_ROOT = 3;
+static constexpr int32_t NTT_MAX_LENGTH = 1 << 23;
+
+// Full word BASEX digits are too wide for the primes, they are convolved as
+// pieces of this many bits.
+static constexpr uint32_t NTT_PIECE_BITS = 16;
+
+namespace
+{
+    uint32_t mulmod(uint32_t a, uint32_t b, uint32_t p)
+    {
+        return (uint32_t)(((uint64_t)a * b) % p);
+    }
+
+    uint32_t powmod(uint32_t a, uint64_t e, uint32_t p)
+    {
+        uint32_t result = 1;
+        while (e)
+        {
+            if (e & 1)
+            {
+                result = mulmod(result, a, p);
+            }
+            a = mulmod(a, a, p);
+            e >>= 1;
+        }
+        return result;
+    }
+
+    // In place forward or inverse transform of f, f.size() is a power of two.
+    void transform(vector<uint32_t>& f, uint32_t p, bool inverse)
+    {
+        size_t n = f.size();
+
+        for (size_t i = 1, j = 0; i < n; i++)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                swap(f[i], f[j]);
+            }
+        }
+
+        vector<uint32_t> twiddle(n / 2);
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            uint32_t w = powmod(NTT_ROOT, (p - 1) / len, p);
+            if (inverse)
+            {
+                w = powmod(w, p - 2, p);
+            }
+            size_t half = len / 2;
+            twiddle[0] = 1;
+            for (size_t k = 1; k < half; k++)
+            {
+                twiddle[k] = mulmod(twiddle[k - 1], w, p);
+            }
+            for (size_t i = 0; i < n; i += len)
+            {
+                uint32_t* lo = &f[i];
+                uint32_t* hi = &f[i + half];
+                for (size_t k = 0; k < half; k++)
+                {
+                    uint32_t u = lo[k];
+                    uint32_t v = mulmod(hi[k], twiddle[k], p);
+                    lo[k] = (u + v >= p) ? u + v - p : u + v;
+                    hi[k] = (u >= v) ? u - v : u + p - v;
+                }
+            }
+        }
+
+        if (inverse)
+        {
+            uint32_t ninv = powmod((uint32_t)(n % p), p - 2, p);
+            for (uint32_t& x : f)
+            {
+                x = mulmod(x, ninv, p);
+            }
+        }
+    }
+
+    // The cyclic convolution of a and b modulo p, of length n.  A square
+    // needs only the one forward transform.
+    void convolve(vector<uint32_t>& r, const MANTTYPE* a, int32_t na, const MANTTYPE* b, int32_t nb, size_t n, uint32_t p)
+    {
+        r.assign(n, 0);
+        for (int32_t i = 0; i < na; i++)
+        {
+            r[i] = a[i] % p;
+        }
+        transform(r, p, false);
+        if (a == b && na == nb)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                r[i] = mulmod(r[i], r[i], p);
+            }
+        }
+        else
+        {
+            vector<uint32_t> fb(n, 0);
+            for (int32_t i = 0; i < nb; i++)
+            {
+                fb[i] = b[i] % p;
+            }
+            transform(fb, p, false);
+            for (size_t i = 0; i < n; i++)
+            {
+                r[i] = mulmod(r[i], fb[i], p);
+            }
+        }
+        transform(r, p, true);
+    }
+
+    // A 96 bit unsigned accumulator, big enough for a recombined convolution
+    // term plus the running carry.
+    struct WIDE96
+    {
+        uint32_t w[3];
+    };
+
+    void wideadd(WIDE96& acc, const WIDE96& x)
+    {
+        uint64_t cy = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            cy += (uint64_t)acc.w[i] + x.w[i];
+            acc.w[i] = (uint32_t)cy;
+            cy >>= 32;
+        }
+    }
+
+    // acc /= radix, returns the remainder.
+    uint32_t widedivmod(WIDE96& acc, uint32_t radix)
+    {
+        uint64_t rem = 0;
+        for (int i = 2; i >= 0; i--)
+        {
+            uint64_t cur = (rem << 32) | acc.w[i];
+            acc.w[i] = (uint32_t)(cur / radix);
+            rem = cur % radix;
+        }
+        return (uint32_t)rem;
+    }
+
+    // Garner's recombination of the three residues into x < p0*p1*p2.
+    WIDE96 recombine(uint32_t r0, uint32_t r1, uint32_t r2)
+    {
+        const uint32_t p0 = NTT_PRIMES[0];
+        const uint32_t p1 = NTT_PRIMES[1];
+        const uint32_t p2 = NTT_PRIMES[2];
+        static const uint32_t inv_p0_mod_p1 = powmod(p0 % p1, p1 - 2, p1);
+        static const uint32_t inv_p0p1_mod_p2 = powmod(mulmod(p0 % p2, p1 % p2, p2), p2 - 2, p2);
+
+        uint32_t k1 = mulmod((r1 + p1 - r0 % p1) % p1, inv_p0_mod_p1, p1);
+        uint64_t x01 = r0 + (uint64_t)p0 * k1;
+        uint32_t k2 = mulmod((uint32_t)((r2 + p2 - x01 % p2) % p2), inv_p0p1_mod_p2, p2);
+
+        // x = x01 + p0*p1*k2
+        uint64_t p01 = (uint64_t)p0 * p1;
+        uint64_t lo = (p01 & 0xFFFFFFFF) * k2;
+        uint64_t hi = (p01 >> 32) * k2 + (lo >> 32);
+        WIDE96 x = { { (uint32_t)lo, (uint32_t)hi, (uint32_t)(hi >> 32) } };
+        WIDE96 y = { { (uint32_t)x01, (uint32_t)(x01 >> 32), 0 } };
+        wideadd(x, y);
+        return x;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _mulmantntt
+//
+//    ARGUMENTS: pointer to the result mantissa, the two mantissas to
+//               multiply with their digit counts, and the radix.
+//
+//    RETURN: true if the product was computed, false if the operands are
+//            too big for the transform.
+//
+//    DESCRIPTION: Does c = a * b on raw mantissas using three prime number
+//    theoretic transforms.  Each convolution term is below
+//    min(cdigita, cdigitb) * radix^2 which stays below the product of the
+//    primes for every transform length the primes allow.  Full word BASEX
+//    digits are split into NTT_PIECE_BITS pieces to keep that bound.  c must
+//    have room for cdigita + cdigitb digits.
+//
+//----------------------------------------------------------------------------
+
+bool _mulmantntt(_Out_ MANTTYPE* c, _In_ const MANTTYPE* a, int32_t cdigita, _In_ const MANTTYPE* b, int32_t cdigitb, uint32_t radix)
+
+{
+    if constexpr (BASEXPWR > 31)
+    {
+        if (radix == BASEX)
+        {
+            const int32_t pieces = BASEXPWR / NTT_PIECE_BITS;
+            const MANTTYPE piecemask = ((MANTTYPE)1 << NTT_PIECE_BITS) - 1;
+            bool square = a == b && cdigita == cdigitb;
+            vector<MANTTYPE> pa(cdigita * pieces);
+            vector<MANTTYPE> pb(square ? 0 : cdigitb * pieces);
+            vector<MANTTYPE> pc((cdigita + cdigitb) * pieces);
+            for (int32_t i = 0; i < cdigita * pieces; i++)
+            {
+                pa[i] = (a[i / pieces] >> (NTT_PIECE_BITS * (i % pieces))) & piecemask;
+            }
+            for (int32_t i = 0; i < (int32_t)pb.size(); i++)
+            {
+                pb[i] = (b[i / pieces] >> (NTT_PIECE_BITS * (i % pieces))) & piecemask;
+            }
+            const MANTTYPE* pbdigits = square ? pa.data() : pb.data();
+            if (!_mulmantntt(pc.data(), pa.data(), cdigita * pieces, pbdigits, cdigitb * pieces, 1u << NTT_PIECE_BITS))
+            {
+                return false;
+            }
+            for (int32_t i = 0; i < cdigita + cdigitb; i++)
+            {
+                c[i] = 0;
+                for (int32_t k = 0; k < pieces; k++)
+                {
+                    c[i] |= pc[i * pieces + k] << (NTT_PIECE_BITS * k);
+                }
+            }
+            return true;
+        }
+    }
+
+    int32_t cdigitc = cdigita + cdigitb;
+    size_t n = 1;
+    while (n < (size_t)cdigitc - 1)
+    {
+        n <<= 1;
+    }
+    if (n > (size_t)NTT_MAX_LENGTH)
+    {
+        return false;
+    }
+
+    vector<uint32_t> r[3];
+    for (int i = 0; i < 3; i++)
+    {
+        convolve(r[i], a, cdigita, b, cdigitb, n, NTT_PRIMES[i]);
+    }
+
+    WIDE96 cy = { { 0, 0, 0 } };
+    for (int32_t i = 0; i < cdigitc; i++)
+    {
+        if ((size_t)i < n)
+        {
+            wideadd(cy, recombine(r[0][i], r[1][i], r[2][i]));
+        }
+        c[i] = (MANTTYPE)widedivmod(cy, radix);
+    }
+
+    return true;
+}
@@ -17,9 +17,10 @@
 //
 //
 //-----------------------------------------------------------------------------
-#include <list>
+#include <vector>
 #include <cstring> // for memmove
 #include "ratpak.h"
+#include "mantissa.h"
 
 using namespace std;
 
@@ -59,114 +60,139 @@ void __inline addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
     }
 }
 
-void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
-
+namespace
 {
-    PNUMBER c = nullptr; // c will contain the result.
-    PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
-    MANTTYPE* pcha;      // pcha is a pointer to the mantissa of a.
-    MANTTYPE* pchb;      // pchb is a pointer to the mantissa of b.
-    MANTTYPE* pchc;      // pchc is a pointer to the mantissa of c.
-    int32_t cdigits;     // cdigits is the max count of the digits results
-                         // used as a counter.
-    int32_t mexp;        // mexp is the exponent of the result.
-    MANTTYPE da;         // da is a single 'digit' after possible padding.
-    MANTTYPE db;         // db is a single 'digit' after possible padding.
-    MANTTYPE cy = 0;     // cy is the value of a carry after adding two 'digits'
-    int32_t fcompla = 0; // fcompla is a flag to signal a is negative.
-    int32_t fcomplb = 0; // fcomplb is a flag to signal b is negative.
-
-    a = *pa;
-
-    // Calculate the overlap of the numbers after alignment, this includes
-    // necessary padding 0's
-    cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - min(a->exp, b->exp);
-
-    createnum(c, cdigits + 1);
-    c->exp = min(a->exp, b->exp);
-    mexp = c->exp;
-    c->cdigit = cdigits;
-    pcha = a->mant;
-    pchb = b->mant;
-    pchc = c->mant;
-
-    // Figure out the sign of the numbers
-    if (a->sign != b->sign)
+    // The digit loop of _addnum, the digit traits hide the radix.
+    template <typename T>
+    void addnumdigits(const T& t, PNUMBER* pa, PNUMBER b)
     {
-        cy = 1;
-        fcompla = (a->sign == -1);
-        fcomplb = (b->sign == -1);
-    }
+        PNUMBER c = nullptr; // c will contain the result.
+        PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
+        MANTTYPE* pcha;      // pcha is a pointer to the mantissa of a.
+        MANTTYPE* pchb;      // pchb is a pointer to the mantissa of b.
+        MANTTYPE* pchc;      // pchc is a pointer to the mantissa of c.
+        int32_t cdigits;     // cdigits is the max count of the digits results
+                             // used as a counter.
+        int32_t mexp;        // mexp is the exponent of the result.
+        MANTTYPE da;         // da is a single 'digit' after possible padding.
+        MANTTYPE db;         // db is a single 'digit' after possible padding.
+        TWO_MANTTYPE cy = 0; // cy is the value of a carry after adding two 'digits'
+        int32_t fcompla = 0; // fcompla is a flag to signal a is negative.
+        int32_t fcomplb = 0; // fcomplb is a flag to signal b is negative.
+        const MANTTYPE radixmax = (MANTTYPE)(t.radix() - 1);
+
+        a = *pa;
+
+        // Calculate the overlap of the numbers after alignment, this includes
+        // necessary padding 0's
+        cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - min(a->exp, b->exp);
+
+        createnum(c, cdigits + 1);
+        c->exp = min(a->exp, b->exp);
+        mexp = c->exp;
+        c->cdigit = cdigits;
+        pcha = a->mant;
+        pchb = b->mant;
+        pchc = c->mant;
 
-    // Loop over all the digits, real and 0 padded. Here we know a and b are
-    // aligned
-    for (; cdigits > 0; cdigits--, mexp++)
-    {
-        // Get digit from a, taking padding into account.
-        da = (((mexp >= a->exp) && (cdigits + a->exp - c->exp > (c->cdigit - a->cdigit))) ? *pcha++ : 0);
-        // Get digit from b, taking padding into account.
-        db = (((mexp >= b->exp) && (cdigits + b->exp - c->exp > (c->cdigit - b->cdigit))) ? *pchb++ : 0);
-
-        // Handle complementing for a and b digit. Might be a better way, but
-        // haven't found it yet.
-        if (fcompla)
+        // Figure out the sign of the numbers
+        if (a->sign != b->sign)
         {
-            da = (MANTTYPE)(radix)-1 - da;
+            cy = 1;
+            fcompla = (a->sign == -1);
+            fcomplb = (b->sign == -1);
         }
-        if (fcomplb)
+
+        // Loop over all the digits, real and 0 padded. Here we know a and b are
+        // aligned
+        for (; cdigits > 0; cdigits--, mexp++)
         {
-            db = (MANTTYPE)(radix)-1 - db;
-        }
+            // Get digit from a, taking padding into account.
+            da = (((mexp >= a->exp) && (cdigits + a->exp - c->exp > (c->cdigit - a->cdigit))) ? *pcha++ : 0);
+            // Get digit from b, taking padding into account.
+            db = (((mexp >= b->exp) && (cdigits + b->exp - c->exp > (c->cdigit - b->cdigit))) ? *pchb++ : 0);
+
+            // Handle complementing for a and b digit. Might be a better way, but
+            // haven't found it yet.
+            if (fcompla)
+            {
+                da = radixmax - da;
+            }
+            if (fcomplb)
+            {
+                db = radixmax - db;
+            }
 
-        // Update carry as necessary
-        cy = da + db + cy;
-        *pchc++ = (MANTTYPE)(cy % (MANTTYPE)radix);
-        cy /= (MANTTYPE)radix;
-    }
+            // Update carry as necessary
+            cy += (TWO_MANTTYPE)da + db;
+            *pchc++ = t.lo(cy);
+            cy = t.hi(cy);
+        }
 
-    // Handle carry from last sum as extra digit
-    if (cy && !(fcompla || fcomplb))
-    {
-        *pchc++ = cy;
-        c->cdigit++;
-    }
+        // Handle carry from last sum as extra digit
+        if (cy && !(fcompla || fcomplb))
+        {
+            *pchc++ = (MANTTYPE)cy;
+            c->cdigit++;
+        }
 
-    // Compute sign of result
-    if (!(fcompla || fcomplb))
-    {
-        c->sign = a->sign;
-    }
-    else
-    {
-        if (cy)
+        // Compute sign of result
+        if (!(fcompla || fcomplb))
         {
-            c->sign = 1;
+            c->sign = a->sign;
         }
         else
         {
-            // In this particular case an overflow or underflow has occurred
-            // and all the digits need to be complemented, at one time an
-            // attempt to handle this above was made, it turned out to be much
-            // slower on average.
-            c->sign = -1;
-            cy = 1;
-            for ((cdigits = c->cdigit), (pchc = c->mant); cdigits > 0; cdigits--)
+            if (cy)
+            {
+                c->sign = 1;
+            }
+            else
             {
-                cy = (MANTTYPE)radix - (MANTTYPE)1 - *pchc + cy;
-                *pchc++ = (MANTTYPE)(cy % (MANTTYPE)radix);
-                cy /= (MANTTYPE)radix;
+                // In this particular case an overflow or underflow has occurred
+                // and all the digits need to be complemented, at one time an
+                // attempt to handle this above was made, it turned out to be much
+                // slower on average.
+                c->sign = -1;
+                cy = 1;
+                for ((cdigits = c->cdigit), (pchc = c->mant); cdigits > 0; cdigits--)
+                {
+                    cy += (TWO_MANTTYPE)(radixmax - *pchc);
+                    *pchc++ = t.lo(cy);
+                    cy = t.hi(cy);
+                }
             }
         }
+
+        // Remove leading zeros, remember digits are in order of
+        // increasing significance. i.e. 100 would be 0,0,1
+        while (c->cdigit > 1 && *(--pchc) == 0)
+        {
+            c->cdigit--;
+        }
+
+        // Equal numbers cancel to a zero without their exponent.
+        if (c->cdigit == 1 && c->mant[0] == 0)
+        {
+            c->exp = 0;
+            c->sign = 1;
+        }
+        destroynum(*pa);
+        *pa = c;
     }
+}
+
+void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 
-    // Remove leading zeros, remember digits are in order of
-    // increasing significance. i.e. 100 would be 0,0,1
-    while (c->cdigit > 1 && *(--pchc) == 0)
+{
+    if (radix == BASEX)
     {
-        c->cdigit--;
+        addnumdigits(BASEXDIGITS{}, pa, b);
+    }
+    else
+    {
+        addnumdigits(RADIXDIGITS{ radix }, pa, b);
     }
-    destroynum(*pa);
-    *pa = c;
 }
 
 //----------------------------------------------------------------------------
@@ -179,8 +205,8 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa *= b.
-//    Assumes radix is the radix of both numbers.  This algorithm is the
-//    same one you learned in grade school.
+//    Assumes radix is the radix of both numbers.  The digit multiply is done
+//    by _mulmant which picks the algorithm based on the operand sizes.
 //
 //----------------------------------------------------------------------------
 
@@ -211,70 +237,17 @@ void __inline mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 
 {
-    PNUMBER c = nullptr;  // c will contain the result.
-    PNUMBER a = nullptr;  // a is the dereferenced number pointer from *pa
-    MANTTYPE* pcha;       // pcha is a pointer to the mantissa of a.
-    MANTTYPE* pchb;       // pchb is a pointer to the mantissa of b.
-    MANTTYPE* pchc;       // pchc is a pointer to the mantissa of c.
-    MANTTYPE* pchcoffset; // pchcoffset, is the anchor location of the next
-                          // single digit multiply partial result.
-    int32_t iadigit = 0;  // Index of digit being used in the first number.
-    int32_t ibdigit = 0;  // Index of digit being used in the second number.
-    MANTTYPE da = 0;      // da is the digit from the fist number.
-    TWO_MANTTYPE cy = 0;  // cy is the carry resulting from the addition of
-                          // a multiplied row into the result.
-    TWO_MANTTYPE mcy = 0; // mcy is the resultant from a single
-                          // multiply, AND the carry of that multiply.
-    int32_t icdigit = 0;  // Index of digit being calculated in final result.
+    PNUMBER c = nullptr; // c will contain the result.
+    PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
 
     a = *pa;
-    ibdigit = a->cdigit + b->cdigit - 1;
-    createnum(c, ibdigit + 1);
-    c->cdigit = ibdigit;
-    c->sign = a->sign * b->sign;
 
+    createnum(c, a->cdigit + b->cdigit);
+    c->cdigit = a->cdigit + b->cdigit;
+    c->sign = a->sign * b->sign;
     c->exp = a->exp + b->exp;
-    pcha = a->mant;
-    pchcoffset = c->mant;
-
-    for (iadigit = a->cdigit; iadigit > 0; iadigit--)
-    {
-        da = *pcha++;
-        pchb = b->mant;
-
-        // Shift pchc, and pchcoffset, one for each digit
-        pchc = pchcoffset++;
-
-        for (ibdigit = b->cdigit; ibdigit > 0; ibdigit--)
-        {
-            cy = 0;
-            mcy = (TWO_MANTTYPE)da * *pchb;
-            if (mcy)
-            {
-                icdigit = 0;
-                if (ibdigit == 1 && iadigit == 1)
-                {
-                    c->cdigit++;
-                }
-            }
-            // If result is nonzero, or while result of carry is nonzero...
-            while (mcy || cy)
-            {
-                // update carry from addition(s) and multiply.
-                cy += (TWO_MANTTYPE)pchc[icdigit] + (mcy % (TWO_MANTTYPE)radix);
 
-                // update result digit from
-                pchc[icdigit++] = (MANTTYPE)(cy % (TWO_MANTTYPE)radix);
-
-                // update carries from
-                mcy /= (TWO_MANTTYPE)radix;
-                cy /= (TWO_MANTTYPE)radix;
-            }
-
-            pchb++;
-            pchc++;
-        }
-    }
+    _mulmant(c->mant, a->mant, a->cdigit, b->mant, b->cdigit, radix);
 
     // prevent different kinds of zeros, by stripping leading duplicate zeros.
     // digits are in order of increasing significance.
@@ -283,6 +256,13 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
         c->cdigit--;
     }
 
+    // A zero product doesn't keep the exponents of its factors.
+    if (c->cdigit == 1 && c->mant[0] == 0)
+    {
+        c->exp = 0;
+        c->sign = 1;
+    }
+
     destroynum(*pa);
     *pa = c;
 }
@@ -297,7 +277,7 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa %= b.
-//            Repeatedly subtracts off powers of 2 of b until *pa < b.
+//            The remainder comes from the division engine in div.cpp.
 //
 //
 //----------------------------------------------------------------------------
@@ -305,48 +285,35 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 void remnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 
 {
-    PNUMBER tmp = nullptr;     // tmp is the working remainder.
-    PNUMBER lasttmp = nullptr; // lasttmp is the last remainder which worked.
-
     // Once *pa is less than b, *pa is the remainder.
-    while (!lessnum(*pa, b))
+    if (lessnum(*pa, b))
     {
-        DUPNUM(tmp, b);
-        if (lessnum(tmp, *pa))
-        {
-            // Start off close to the right answer for subtraction.
-            tmp->exp = (*pa)->cdigit + (*pa)->exp - tmp->cdigit;
-            if (MSD(*pa) <= MSD(tmp))
-            {
-                // Don't take the chance that the numbers are equal.
-                tmp->exp--;
-            }
-        }
+        return;
+    }
 
-        destroynum(lasttmp);
-        lasttmp = i32tonum(0, radix);
+    PNUMBER a = *pa;     // a is the dereferenced number pointer from *pa
+    PNUMBER c = nullptr; // c will contain the result.
 
-        while (lessnum(tmp, *pa))
-        {
-            DUPNUM(lasttmp, tmp);
-            addnum(&tmp, tmp, radix);
-        }
+    // Line both numbers up on the smaller exponent.
+    int32_t exp = min(a->exp, b->exp);
+    int32_t cdigita = a->cdigit + a->exp - exp;
+    int32_t cdigitb = b->cdigit + b->exp - exp;
+    vector<MANTTYPE> u(cdigita, 0);
+    vector<MANTTYPE> v(cdigitb, 0);
+    memcpy(u.data() + a->exp - exp, a->mant, a->cdigit * sizeof(MANTTYPE));
+    memcpy(v.data() + b->exp - exp, b->mant, b->cdigit * sizeof(MANTTYPE));
+    cdigitb = _mantlen(v.data(), cdigitb);
 
-        if (lessnum(*pa, tmp))
-        {
-            // too far, back up...
-            destroynum(tmp);
-            tmp = lasttmp;
-            lasttmp = nullptr;
-        }
+    createnum(c, cdigitb);
+    vector<MANTTYPE> q(max(cdigita - cdigitb + 1, 1));
+    _divmant(q.data(), c->mant, u.data(), cdigita, v.data(), cdigitb, radix);
 
-        // Subtract the working remainder from the remainder holder.
-        tmp->sign = -1 * (*pa)->sign;
-        addnum(pa, tmp, radix);
+    c->cdigit = max(_mantlen(c->mant, cdigitb), 1);
+    c->exp = zernum(c) ? 0 : exp;
+    c->sign = zernum(c) ? 1 : a->sign;
 
-        destroynum(tmp);
-        destroynum(lasttmp);
-    }
+    destroynum(*pa);
+    *pa = c;
 }
 
 //---------------------------------------------------------------------------
@@ -359,7 +326,8 @@ void remnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa /= b.
-//    Assumes radix is the radix of both numbers.
+//    Assumes radix is the radix of both numbers.  The digits are produced by
+//    the division engine in div.cpp.
 //
 //---------------------------------------------------------------------------
 
@@ -381,99 +349,7 @@ void __inline divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision)
 
 void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision)
 {
-    PNUMBER a = *pa;
-    int32_t thismax = precision + 2;
-    if (thismax < a->cdigit)
-    {
-        thismax = a->cdigit;
-    }
-
-    if (thismax < b->cdigit)
-    {
-        thismax = b->cdigit;
-    }
-
-    PNUMBER c = nullptr;
-    createnum(c, thismax + 1);
-    c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
-    c->sign = a->sign * b->sign;
-
-    MANTTYPE* ptrc = c->mant + thismax;
-    PNUMBER rem = nullptr;
-    PNUMBER tmp = nullptr;
-    DUPNUM(rem, a);
-    DUPNUM(tmp, b);
-    tmp->sign = a->sign;
-    rem->exp = b->cdigit + b->exp - rem->cdigit;
-
-    // Build a table of multiplications of the divisor, this is quicker for
-    // more than radix 'digits'
-    list<PNUMBER> numberList{ i32tonum(0L, radix) };
-    for (uint32_t i = 1; i < radix; i++)
-    {
-        PNUMBER newValue = nullptr;
-        DUPNUM(newValue, numberList.front());
-        addnum(&newValue, tmp, radix);
-
-        numberList.emplace_front(newValue);
-    }
-    destroynum(tmp);
-
-    int32_t digit;
-    int32_t cdigits = 0;
-    while (cdigits++ < thismax && !zernum(rem))
-    {
-        digit = radix - 1;
-        PNUMBER multiple = nullptr;
-        for (const auto& num : numberList)
-        {
-            if (!lessnum(rem, num) || !--digit)
-            {
-                multiple = num;
-                break;
-            }
-        }
-
-        if (digit)
-        {
-            multiple->sign *= -1;
-            addnum(&rem, multiple, radix);
-            multiple->sign *= -1;
-        }
-        rem->exp++;
-        *ptrc-- = (MANTTYPE)digit;
-    }
-    cdigits--;
-
-    if (c->mant != ++ptrc)
-    {
-        memmove(c->mant, ptrc, (int)(cdigits * sizeof(MANTTYPE)));
-    }
-
-    // Cleanup table structure
-    for (auto& num : numberList)
-    {
-        destroynum(num);
-    }
-
-    if (!cdigits)
-    {
-        c->cdigit = 1;
-        c->exp = 0;
-    }
-    else
-    {
-        c->cdigit = cdigits;
-        c->exp -= cdigits;
-        while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
-        {
-            c->cdigit--;
-        }
-    }
-    destroynum(rem);
-
-    destroynum(*pa);
-    *pa = c;
+    _divnumdigits(pa, b, radix, precision + 2);
 }
 
 //---------------------------------------------------------------------------
@@ -590,10 +466,9 @@ bool lessnum(PNUMBER a, PNUMBER b)
             {
                 da = ((cdigits > (ccdigits - a->cdigit)) ? *pa-- : 0);
                 db = ((cdigits > (ccdigits - b->cdigit)) ? *pb-- : 0);
-                diff = da - db;
-                if (diff)
+                if (da != db)
                 {
-                    return (diff < 0);
+                    return (da < db);
                 }
             }
             // In this case, they are equal.
@@ -0,0 +1,331 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           pool.cpp
+//
+//
+//  Description
+//
+//     Contains the allocator behind createnum and createrat.  Blocks are
+//  rounded up to power of two size classes and freed blocks are kept on per
+//  thread free lists for reuse, so the temporaries of a series expansion
+//  stop going to the heap after the first few terms.  A RATPACKARENA scope
+//  carves blocks out of large chunks instead and releases the chunks in one
+//  go when it ends.
+//
+//-----------------------------------------------------------------------------
+#include "ratpak.h"
+
+// Every block starts with this header, the caller gets the memory
+// BLOCK_HEADER_BYTES after it so blocks stay as aligned as the heap's.
+typedef struct _blockheader
+{
+    ARENACHUNK* chunk; // owning arena chunk, nullptr for heap blocks
+    uint32_t cb;       // usable bytes after the header
+    int32_t sizeclass; // free list index, -1 for blocks above the largest class
+} BLOCKHEADER;
+
+static constexpr size_t BLOCK_HEADER_BYTES = 16;
+static_assert(sizeof(BLOCKHEADER) <= BLOCK_HEADER_BYTES, "BLOCKHEADER must fit in BLOCK_HEADER_BYTES");
+
+// Arena memory comes in chunks of this many bytes, each starting with its
+// ARENACHUNK.
+static constexpr size_t ARENA_CHUNK_BYTES = 64 * 1024;
+
+// Freed blocks kept per size class on each thread, the rest go back to the
+// heap.
+static constexpr uint32_t POOL_MAX_FREE = 64;
+
+typedef struct _arenachunk
+{
+    RATPACKARENA* arena; // the arena carving it, nullptr once the arena ended
+    ARENACHUNK* next;    // next older chunk of the same arena
+    size_t live;         // blocks handed out and not yet freed
+} ARENACHUNK;
+
+static constexpr size_t ARENA_CHUNK_HEADER = (sizeof(ARENACHUNK) + BLOCK_HEADER_BYTES - 1) & ~(BLOCK_HEADER_BYTES - 1);
+
+// The per thread state is trivially destructible so it can still be used
+// while other thread locals are torn down.
+static thread_local void* t_free[POOL_CLASSES];    // free lists, linked through the first word of each block
+static thread_local uint32_t t_cfree[POOL_CLASSES]; // length of each free list
+static thread_local RATPACKARENA* t_arena;          // innermost open arena
+static thread_local POOLCOUNTERS t_counters;
+static thread_local bool t_registered; // t_drain has been constructed
+static thread_local bool t_drained;    // the thread is exiting, stop caching blocks
+
+namespace
+{
+    BLOCKHEADER* headerof(const void* block)
+    {
+        return (BLOCKHEADER*)((char*)block - BLOCK_HEADER_BYTES);
+    }
+
+    // Hands the cached blocks back to the heap when the thread exits.
+    struct POOLDRAIN
+    {
+        ~POOLDRAIN()
+        {
+            t_drained = true;
+            for (int32_t c = 0; c < POOL_CLASSES; c++)
+            {
+                while (t_free[c] != nullptr)
+                {
+                    void* block = t_free[c];
+                    t_free[c] = *(void**)block;
+                    free(headerof(block));
+                }
+                t_cfree[c] = 0;
+            }
+        }
+    };
+
+    thread_local POOLDRAIN t_drain;
+
+    // Total bytes, header included, of a size class.
+    size_t classbytes(int32_t sizeclass)
+    {
+        return (size_t)1 << (POOL_MIN_SHIFT + sizeclass);
+    }
+
+    // The smallest size class holding cb bytes after the header, -1 if
+    // none does.
+    int32_t sizeclassof(size_t cb)
+    {
+        size_t total = cb + BLOCK_HEADER_BYTES;
+        for (int32_t c = 0; c < POOL_CLASSES; c++)
+        {
+            if (total <= classbytes(c))
+            {
+                return c;
+            }
+        }
+        return -1;
+    }
+
+    void* blockof(BLOCKHEADER* header, ARENACHUNK* chunk, size_t cb, int32_t sizeclass)
+    {
+        header->chunk = chunk;
+        header->cb = (uint32_t)cb;
+        header->sizeclass = sizeclass;
+        return (char*)header + BLOCK_HEADER_BYTES;
+    }
+
+    void* popfree(void** freelist, size_t cb)
+    {
+        void* block = *freelist;
+        *freelist = *(void**)block;
+        memset(block, 0, cb);
+        t_counters.reused++;
+        return block;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: RATPACKARENA
+//
+//    DESCRIPTION: Opens an arena on this thread, createnum and createrat
+//    carve their blocks from it until it is destroyed.  Arenas nest.
+//
+//-----------------------------------------------------------------------------
+
+RATPACKARENA::RATPACKARENA()
+    : m_previous(t_arena)
+    , m_chunks(nullptr)
+    , m_next(nullptr)
+    , m_left(0)
+    , m_free{}
+{
+    t_arena = this;
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: ~RATPACKARENA
+//
+//    DESCRIPTION: Closes the arena and frees its chunks.  A chunk that still
+//    holds live blocks, say a constant first computed inside the arena, is
+//    freed along with its last block instead.
+//
+//-----------------------------------------------------------------------------
+
+RATPACKARENA::~RATPACKARENA()
+{
+    t_arena = m_previous;
+    ARENACHUNK* chunk = m_chunks;
+    while (chunk != nullptr)
+    {
+        ARENACHUNK* next = chunk->next;
+        chunk->arena = nullptr;
+        if (chunk->live == 0)
+        {
+            free(chunk);
+        }
+        chunk = next;
+    }
+}
+
+void* RATPACKARENA::_alloc(size_t cb, int32_t sizeclass)
+{
+    void* block;
+    if (m_free[sizeclass] != nullptr)
+    {
+        block = popfree(&m_free[sizeclass], cb);
+    }
+    else
+    {
+        size_t total = classbytes(sizeclass);
+        if (m_left < total)
+        {
+            ARENACHUNK* chunk = (ARENACHUNK*)calloc(ARENA_CHUNK_BYTES, 1);
+            if (chunk == nullptr)
+            {
+                throw(CALC_E_OUTOFMEMORY);
+            }
+            chunk->arena = this;
+            chunk->next = m_chunks;
+            chunk->live = 0;
+            m_chunks = chunk;
+            m_next = (char*)chunk + ARENA_CHUNK_HEADER;
+            m_left = ARENA_CHUNK_BYTES - ARENA_CHUNK_HEADER;
+        }
+        block = blockof((BLOCKHEADER*)m_next, m_chunks, total - BLOCK_HEADER_BYTES, sizeclass);
+        m_next += total;
+        m_left -= total;
+        t_counters.carved++;
+    }
+    headerof(block)->chunk->live++;
+    return block;
+}
+
+void RATPACKARENA::_release(void* block, int32_t sizeclass)
+{
+    *(void**)block = m_free[sizeclass];
+    m_free[sizeclass] = block;
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: zmalloc
+//
+//    ARGUMENTS: number of bytes
+//
+//    RETURN: pointer to cb zeroed bytes, free it with zfree.
+//
+//    DESCRIPTION: Allocates from the open arena if there is one, else from
+//    this thread's free list for the size class, else from the heap.
+//
+//-----------------------------------------------------------------------------
+
+void* zmalloc(size_t cb)
+{
+    t_counters.requests++;
+
+    int32_t sizeclass = sizeclassof(cb);
+    if (sizeclass < 0)
+    {
+        t_counters.heap++;
+        BLOCKHEADER* header = (BLOCKHEADER*)calloc(BLOCK_HEADER_BYTES + cb, 1);
+        return header == nullptr ? nullptr : blockof(header, nullptr, cb, -1);
+    }
+
+    if (t_arena != nullptr)
+    {
+        return t_arena->_alloc(cb, sizeclass);
+    }
+
+    if (t_free[sizeclass] != nullptr)
+    {
+        t_cfree[sizeclass]--;
+        return popfree(&t_free[sizeclass], cb);
+    }
+
+    t_counters.heap++;
+    BLOCKHEADER* header = (BLOCKHEADER*)calloc(classbytes(sizeclass), 1);
+    return header == nullptr ? nullptr : blockof(header, nullptr, classbytes(sizeclass) - BLOCK_HEADER_BYTES, sizeclass);
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: zfree
+//
+//    ARGUMENTS: pointer from zmalloc or nullptr
+//
+//    RETURN: None
+//
+//    DESCRIPTION: Returns the block to its arena or to this thread's free
+//    list, the heap gets it when the list is full.  Arena blocks must be
+//    freed on the thread that owns the arena while the arena is open.
+//
+//-----------------------------------------------------------------------------
+
+void zfree(void* block)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    BLOCKHEADER* header = headerof(block);
+    ARENACHUNK* chunk = header->chunk;
+    if (chunk != nullptr)
+    {
+        chunk->live--;
+        if (chunk->arena != nullptr)
+        {
+            chunk->arena->_release(block, header->sizeclass);
+        }
+        else if (chunk->live == 0)
+        {
+            free(chunk);
+        }
+        return;
+    }
+
+    int32_t sizeclass = header->sizeclass;
+    if (sizeclass >= 0 && !t_drained && t_cfree[sizeclass] < POOL_MAX_FREE)
+    {
+        if (!t_registered)
+        {
+            t_registered = true;
+            (void)&t_drain;
+        }
+        *(void**)block = t_free[sizeclass];
+        t_free[sizeclass] = block;
+        t_cfree[sizeclass]++;
+        return;
+    }
+
+    free(header);
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: zsize
+//
+//    ARGUMENTS: pointer from zmalloc
+//
+//    RETURN: The usable size of the block, at least what was asked for.
+//
+//-----------------------------------------------------------------------------
+
+size_t zsize(_In_ const void* block)
+{
+    return headerof(block)->cb;
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _poolcounters
+//
+//    RETURN: This thread's allocation counters.
+//
+//-----------------------------------------------------------------------------
+
+POOLCOUNTERS& _poolcounters()
+{
+    return t_counters;
+}
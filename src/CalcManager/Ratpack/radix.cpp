@@ -0,0 +1,345 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           radix.cpp
+//
+//
+//  Description
+//
+//     Contains the radix conversion kernels used by nRadixxtonum and
+//  numtonRadixx.  Radix digits are packed into chunks, as many digits as
+//  fit in one BASEX digit (9 decimal digits with 31 bit limbs), so the
+//  small case is a single digit multiply or divide per chunk.  Large
+//  operands are split in half around a cached power of the chunk base and
+//  the halves are converted recursively, which rides on the fast multiply
+//  and divide in mul.cpp and div.cpp.
+//     A power of two radix is a plain regrouping of the bits, done in one
+//  linear pass so hex and binary of the widest Programmer mode words stay
+//  cheap.
+//
+//-----------------------------------------------------------------------------
+#include <map>
+#include <vector>
+#include "ratpak.h"
+#include "mantissa.h"
+
+using namespace std;
+
+// Conversions of at most this many chunks are done a chunk at a time, above
+// it the divide and conquer split pays off.
+static constexpr int32_t RADIX_SPLIT_THRESHOLD = 48;
+
+namespace
+{
+    // The chunk base of a radix and its cached powers.
+    struct RADIXPOWERS
+    {
+        int32_t chunk = 0;              // radix digits per chunk
+        MANTTYPE chunkbase = 0;         // radix^chunk
+        vector<vector<MANTTYPE>> basex; // basex[i] = chunkbase^(2^i) in BASEX digits
+    };
+
+    RADIXPOWERS& radixpowers(uint32_t radix)
+    {
+        // Per thread, like the rest of the ratpack state.
+        static thread_local map<uint32_t, RADIXPOWERS> cache;
+
+        RADIXPOWERS& rp = cache[radix];
+        if (rp.chunk == 0)
+        {
+            TWO_MANTTYPE base = radix;
+            rp.chunk = 1;
+            while (base * radix <= BASEXMAX)
+            {
+                base *= radix;
+                rp.chunk++;
+            }
+            rp.chunkbase = (MANTTYPE)base;
+            rp.basex.push_back(vector<MANTTYPE>{ rp.chunkbase });
+        }
+        return rp;
+    }
+
+    // chunkbase^(2^i) in BASEX digits, squared up on first use.
+    const vector<MANTTYPE>& chunkpower(RADIXPOWERS& rp, int32_t i)
+    {
+        while ((int32_t)rp.basex.size() <= i)
+        {
+            const vector<MANTTYPE>& last = rp.basex.back();
+            int32_t n = (int32_t)last.size();
+            vector<MANTTYPE> square(2 * n);
+            _mulmant(square.data(), last.data(), n, last.data(), n, BASEX);
+            square.resize(_mantlen(square.data(), 2 * n));
+            rp.basex.push_back(move(square));
+        }
+        return rp.basex[i];
+    }
+
+    // Largest power of two below n, and its log.
+    int32_t splitpoint(int32_t n, int32_t& log)
+    {
+        int32_t h = 1;
+        log = 0;
+        while (2 * h < n)
+        {
+            h *= 2;
+            log++;
+        }
+        return h;
+    }
+
+    // log2(radix) if radix is a power of two, else 0.
+    int32_t radixbits(uint32_t radix)
+    {
+        if ((radix & (radix - 1)) != 0)
+        {
+            return 0;
+        }
+        int32_t bits = 0;
+        while (((uint32_t)1 << bits) < radix)
+        {
+            bits++;
+        }
+        return bits;
+    }
+
+    // Packs radix digits of bits bits each into BASEX digits.
+    PNUMBER pow2radixtobasex(const MANTTYPE* d, int32_t cdigit, int32_t bits)
+    {
+        int32_t n = max((cdigit * bits + (int32_t)BASEXPWR - 1) / (int32_t)BASEXPWR, 1);
+        PNUMBER pnumret = nullptr;
+        createnum(pnumret, n);
+        for (int32_t i = 0; i < cdigit; i++)
+        {
+            int32_t bit = i * bits;
+            TWO_MANTTYPE v = (TWO_MANTTYPE)d[i] << (bit % BASEXPWR);
+            pnumret->mant[bit / BASEXPWR] |= (MANTTYPE)(v & BASEXMAX);
+            if ((v >> BASEXPWR) != 0)
+            {
+                pnumret->mant[bit / BASEXPWR + 1] |= (MANTTYPE)(v >> BASEXPWR);
+            }
+        }
+        pnumret->cdigit = max(_mantlen(pnumret->mant, n), 1);
+        pnumret->exp = 0;
+        pnumret->sign = 1;
+        return pnumret;
+    }
+
+    // Splits BASEX digits into radix digits of bits bits each.
+    PNUMBER basextopow2radix(const MANTTYPE* a, int32_t cdigit, int32_t bits)
+    {
+        int32_t m = max((cdigit * (int32_t)BASEXPWR + bits - 1) / bits, 1);
+        PNUMBER pnumret = nullptr;
+        createnum(pnumret, m);
+        MANTTYPE mask = (MANTTYPE)((1u << bits) - 1);
+        for (int32_t j = 0; j < m; j++)
+        {
+            int32_t bit = j * bits;
+            int32_t i = bit / BASEXPWR;
+            TWO_MANTTYPE v = a[i] >> (bit % BASEXPWR);
+            if (i + 1 < cdigit)
+            {
+                v |= (TWO_MANTTYPE)a[i + 1] << (BASEXPWR - bit % BASEXPWR);
+            }
+            pnumret->mant[j] = (MANTTYPE)v & mask;
+        }
+        pnumret->cdigit = max(_mantlen(pnumret->mant, m), 1);
+        pnumret->exp = 0;
+        pnumret->sign = 1;
+        return pnumret;
+    }
+
+    // x = c[0..m) read as digits in the chunk base.
+    void chunkstobasex(RADIXPOWERS& rp, vector<MANTTYPE>& x, const MANTTYPE* c, int32_t m)
+    {
+        BASEXDIGITS t;
+        if (m <= RADIX_SPLIT_THRESHOLD)
+        {
+            // Horner, one single digit multiply add per chunk.
+            x.assign(m + 1, 0);
+            int32_t n = 0;
+            for (int32_t j = m - 1; j >= 0; j--)
+            {
+                TWO_MANTTYPE cy = c[j];
+                for (int32_t i = 0; i < n; i++)
+                {
+                    cy += (TWO_MANTTYPE)x[i] * rp.chunkbase;
+                    x[i] = t.lo(cy);
+                    cy = t.hi(cy);
+                }
+                if (cy)
+                {
+                    x[n++] = (MANTTYPE)cy;
+                }
+            }
+            x.resize(n);
+            return;
+        }
+
+        // x = hi * chunkbase^h + lo
+        int32_t log;
+        int32_t h = splitpoint(m, log);
+        vector<MANTTYPE> lo;
+        vector<MANTTYPE> hi;
+        chunkstobasex(rp, lo, c, h);
+        chunkstobasex(rp, hi, c + h, m - h);
+        const vector<MANTTYPE>& p = chunkpower(rp, log);
+        int32_t n = (int32_t)(hi.size() + p.size());
+        x.assign(max(n, (int32_t)lo.size()) + 1, 0);
+        if (!hi.empty())
+        {
+            _mulmant(x.data(), hi.data(), (int32_t)hi.size(), p.data(), (int32_t)p.size(), BASEX);
+        }
+        _mantaddto(t, x.data(), (int32_t)x.size(), lo.data(), (int32_t)lo.size());
+        x.resize(_mantlen(x.data(), (int32_t)x.size()));
+    }
+
+    // c[0..m) = the chunk base digits of x, x must be below chunkbase^m.
+    void basextochunks(RADIXPOWERS& rp, vector<MANTTYPE>& x, MANTTYPE* c, int32_t m)
+    {
+        if (m <= RADIX_SPLIT_THRESHOLD)
+        {
+            // Repeated short division, one chunk per pass.
+            int32_t n = _mantlen(x.data(), (int32_t)x.size());
+            for (int32_t j = 0; j < m; j++)
+            {
+                TWO_MANTTYPE rem = 0;
+                for (int32_t i = n - 1; i >= 0; i--)
+                {
+                    rem = (rem << BASEXPWR) | x[i];
+                    x[i] = (MANTTYPE)(rem / rp.chunkbase);
+                    rem %= rp.chunkbase;
+                }
+                c[j] = (MANTTYPE)rem;
+                n = _mantlen(x.data(), n);
+            }
+            return;
+        }
+
+        // x = q * chunkbase^h + r
+        int32_t log;
+        int32_t h = splitpoint(m, log);
+        const vector<MANTTYPE>& p = chunkpower(rp, log);
+        int32_t nx = _mantlen(x.data(), (int32_t)x.size());
+        int32_t np = (int32_t)p.size();
+        vector<MANTTYPE> q(max(nx - np + 1, 1), 0);
+        vector<MANTTYPE> r(np, 0);
+        _divmant(q.data(), r.data(), x.data(), max(nx, 1), p.data(), np, BASEX);
+        basextochunks(rp, r, c, h);
+        basextochunks(rp, q, c + h, m - h);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _radixtobasex
+//
+//    ARGUMENTS: the radix digits of an integer with their count, and the
+//               radix.
+//
+//    RETURN: The integer in BASEX digits, exp 0 and positive.
+//
+//    DESCRIPTION: Converts from radix digits to BASEX digits.  The digits
+//    are packed into chunks which are then combined by divide and conquer
+//    around cached powers of the chunk base.  A power of two radix just has
+//    its bits regrouped.
+//
+//----------------------------------------------------------------------------
+
+PNUMBER _radixtobasex(_In_ const MANTTYPE* d, int32_t cdigit, uint32_t radix)
+
+{
+    if (int32_t bits = radixbits(radix); bits != 0)
+    {
+        return pow2radixtobasex(d, cdigit, bits);
+    }
+
+    RADIXPOWERS& rp = radixpowers(radix);
+
+    int32_t m = (cdigit + rp.chunk - 1) / rp.chunk;
+    vector<MANTTYPE> c(max(m, 1), 0);
+    for (int32_t j = 0; j < m; j++)
+    {
+        int32_t top = min(cdigit, (j + 1) * rp.chunk);
+        TWO_MANTTYPE chunk = 0;
+        for (int32_t i = top - 1; i >= j * rp.chunk; i--)
+        {
+            chunk = chunk * radix + d[i];
+        }
+        c[j] = (MANTTYPE)chunk;
+    }
+
+    vector<MANTTYPE> x;
+    chunkstobasex(rp, x, c.data(), m);
+
+    PNUMBER pnumret = nullptr;
+    int32_t n = max((int32_t)x.size(), 1);
+    createnum(pnumret, n);
+    pnumret->cdigit = n;
+    pnumret->exp = 0;
+    pnumret->sign = 1;
+    memcpy(pnumret->mant, x.data(), x.size() * sizeof(MANTTYPE));
+    return pnumret;
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _basextoradix
+//
+//    ARGUMENTS: the BASEX digits of an integer with their count, and the
+//               radix.
+//
+//    RETURN: The integer in radix digits, exp 0 and positive.
+//
+//    DESCRIPTION: Converts from BASEX digits to radix digits.  The number
+//    is split into chunk base digits by divide and conquer around cached
+//    powers of the chunk base, and each chunk is then unpacked into radix
+//    digits.  A power of two radix just has its bits regrouped.
+//
+//----------------------------------------------------------------------------
+
+PNUMBER _basextoradix(_In_ const MANTTYPE* a, int32_t cdigit, uint32_t radix)
+
+{
+    if (int32_t bits = radixbits(radix); bits != 0)
+    {
+        return basextopow2radix(a, cdigit, bits);
+    }
+
+    RADIXPOWERS& rp = radixpowers(radix);
+
+    vector<MANTTYPE> x(a, a + cdigit);
+    x.resize(max(_mantlen(x.data(), cdigit), 1));
+
+    // Bound the chunk count from the bit length, every chunk holds at least
+    // floor(log2(chunkbase)) bits.
+    int32_t chunkbits = 0;
+    while (((TWO_MANTTYPE)1 << (chunkbits + 1)) <= rp.chunkbase)
+    {
+        chunkbits++;
+    }
+    int32_t bits = (int32_t)BASEXPWR * (int32_t)x.size();
+    int32_t m = bits / chunkbits + 1;
+
+    vector<MANTTYPE> c(m, 0);
+    basextochunks(rp, x, c.data(), m);
+
+    PNUMBER pnumret = nullptr;
+    createnum(pnumret, m * rp.chunk);
+    MANTTYPE* pmant = pnumret->mant;
+    for (int32_t j = 0; j < m; j++)
+    {
+        MANTTYPE chunk = c[j];
+        for (int32_t i = 0; i < rp.chunk; i++)
+        {
+            *pmant++ = chunk % radix;
+            chunk /= radix;
+        }
+    }
+    pnumret->cdigit = max(_mantlen(pnumret->mant, m * rp.chunk), 1);
+    pnumret->exp = 0;
+    pnumret->sign = 1;
+    return pnumret;
+}
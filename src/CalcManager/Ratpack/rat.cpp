@@ -74,7 +74,7 @@ void fracrat(PRAT* pa, uint32_t radix, int32_t precision)
 {
     // Only do the flatrat operation if number is nonzero.
     // and only if the bottom part is not one.
-    if (!zernum((*pa)->pp) && !equnum((*pa)->pq, num_one))
+    if (!zernum((*pa)->pp) && !equnum((*pa)->pq, g_ratpack->num_one))
     {
         flatrat(*pa, radix, precision);
     }
@@ -111,11 +111,11 @@ void mulrat(PRAT* pa, PRAT b, int32_t precision)
     else
     {
         // If it is zero, blast a one in the denominator.
-        DUPNUM(((*pa)->pq), num_one);
+        DUPNUM(((*pa)->pq), g_ratpack->num_one);
     }
 
 #ifdef MULGCD
-    gcdrat(pa);
+    gcdrat(pa, precision);
 #endif
 }
 
@@ -160,12 +160,12 @@ void divrat(PRAT* pa, PRAT b, int32_t precision)
         else
         {
             // 0/x make a unique 0.
-            DUPNUM(((*pa)->pq), num_one);
+            DUPNUM(((*pa)->pq), g_ratpack->num_one);
         }
     }
 
 #ifdef DIVGCD
-    gcdrat(pa);
+    gcdrat(pa, precision);
 #endif
 }
 
@@ -238,35 +238,10 @@ void addrat(PRAT* pa, PRAT b, int32_t precision)
     }
 
 #ifdef ADDGCD
-    gcdrat(pa);
+    gcdrat(pa, precision);
 #endif
 }
 
-//-----------------------------------------------------------------------------
-//
-//  FUNCTION: rootrat
-//
-//  PARAMETERS: y prat representation of number to take the root of
-//              n prat representation of the root to take.
-//
-//  RETURN: bth root of a in rat form.
-//
-//  EXPLANATION: This is now a stub function to powrat().
-//
-//-----------------------------------------------------------------------------
-
-void rootrat(PRAT* py, PRAT n, uint32_t radix, int32_t precision)
-{
-    // Initialize 1/n
-    PRAT oneovern = nullptr;
-    DUPRAT(oneovern, rat_one);
-    divrat(&oneovern, n, precision);
-
-    powrat(py, oneovern, radix, precision);
-
-    destroyrat(oneovern);
-}
-
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: zerrat
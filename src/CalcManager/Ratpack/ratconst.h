@@ -570,7 +570,7 @@ inline const NUMBER init_p_rat_max_fact = { 1,
                                             1,
                                             0,
                                             {
-                                                3249,
+                                                11923,
                                             } };
 inline const NUMBER init_q_rat_max_fact = { 1,
                                             1,
@@ -584,7 +584,7 @@ inline const NUMBER init_p_rat_min_fact = { -1,
                                             1,
                                             0,
                                             {
-                                                1000,
+                                                11923,
                                             } };
 inline const NUMBER init_q_rat_min_fact = { 1,
                                             1,
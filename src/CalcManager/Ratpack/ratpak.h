@@ -23,13 +23,38 @@
 #include <cstring> // for memmove
 #include <sal.h>   // for SAL
 
-static constexpr uint32_t BASEXPWR = 31L;     // Internal log2(BASEX)
-static constexpr uint32_t BASEX = 0x80000000; // Internal radix used in calculations, hope to raise
-                                              // this to 2^32 after solving scaling problems with
-                                              // overflow detection esp. in mul
+// RATPAK_LIMB_BITS selects the internal radix BASEX = 2^RATPAK_LIMB_BITS.
+//   31  the default, 31 bit digits in 32 bit words, 64 bit accumulators.
+//   32  full 32 bit digits with 64 bit accumulators.
+//   64  full 64 bit digits with unsigned __int128 accumulators, needs a
+//       compiler that provides them.
+// The constants in ratconst.h are in 31 bit digits, other limb sizes
+// compute them the first time ChangeConstants is called.
+#ifndef RATPAK_LIMB_BITS
+#define RATPAK_LIMB_BITS 31
+#endif
 
+#if RATPAK_LIMB_BITS == 31 || RATPAK_LIMB_BITS == 32
 typedef uint32_t MANTTYPE;
 typedef uint64_t TWO_MANTTYPE;
+#elif RATPAK_LIMB_BITS == 64
+#if !defined(__SIZEOF_INT128__)
+#error RATPAK_LIMB_BITS 64 needs a compiler with unsigned __int128
+#endif
+typedef uint64_t MANTTYPE;
+typedef unsigned __int128 TWO_MANTTYPE;
+#else
+#error RATPAK_LIMB_BITS must be 31, 32 or 64
+#endif
+
+static constexpr uint32_t BASEXPWR = RATPAK_LIMB_BITS; // Internal log2(BASEX)
+
+// Internal radix used in calculations.  Radices are passed around as
+// uint32_t so with full word digits BASEX wraps to 0, which is never a
+// display radix, kernels that need the value use the digit traits in
+// mantissa.h or BASEXMAX.
+static constexpr uint32_t BASEX = (uint32_t)((TWO_MANTTYPE)1 << BASEXPWR);
+static constexpr MANTTYPE BASEXMAX = (MANTTYPE)(((TWO_MANTTYPE)1 << BASEXPWR) - 1); // Largest digit in BASEX
 
 enum eNUMOBJ_FMT
 {
@@ -47,8 +72,17 @@ enum eANGLE_TYPE
 
 };
 
+enum eSERIES_TYPE
+{
+    SERIES_EXP, // the exp series
+    SERIES_LOG, // log as 2*atanh((x-1)/(x+1))
+    SERIES_ATAN // the atan series
+
+};
+
 typedef enum eNUMOBJ_FMT NUMOBJ_FMT;
 typedef enum eANGLE_TYPE ANGLE_TYPE;
+typedef enum eSERIES_TYPE SERIES_TYPE;
 
 //-----------------------------------------------------------------------------
 //
@@ -88,70 +122,121 @@ static constexpr uint32_t MAX_LONG_SIZE = 33; // Base 2 requires 32 'digits'
 
 //-----------------------------------------------------------------------------
 //
-// List of useful constants for evaluation, note this list needs to be
-// initialized.
+// RATPACKCONTEXT holds the state ChangeConstants maintains: the ratio of the
+// radix to BASEX, the precision flags and the list of useful constants for
+// evaluation.  Ratpack works in the context g_ratpack points at, which is
+// per thread and starts out as the process default.  A RATPACKCONTEXTSCOPE
+// switches the thread to another context, so engines owning their own
+// contexts can run in parallel with different radix and precision.
 //
 //-----------------------------------------------------------------------------
 
-extern PNUMBER num_one;
-extern PNUMBER num_two;
-extern PNUMBER num_five;
-extern PNUMBER num_six;
-extern PNUMBER num_ten;
-
-extern PRAT ln_ten;
-extern PRAT ln_two;
-extern PRAT rat_zero;
-extern PRAT rat_neg_one;
-extern PRAT rat_one;
-extern PRAT rat_two;
-extern PRAT rat_six;
-extern PRAT rat_half;
-extern PRAT rat_ten;
-extern PRAT pt_eight_five;
-extern PRAT pi;
-extern PRAT pi_over_two;
-extern PRAT two_pi;
-extern PRAT one_pt_five_pi;
-extern PRAT e_to_one_half;
-extern PRAT rat_exp;
-extern PRAT rad_to_deg;
-extern PRAT rad_to_grad;
-extern PRAT rat_qword;
-extern PRAT rat_dword;
-extern PRAT rat_word;
-extern PRAT rat_byte;
-extern PRAT rat_360;
-extern PRAT rat_400;
-extern PRAT rat_180;
-extern PRAT rat_200;
-extern PRAT rat_nRadix;
-extern PRAT rat_smallest;
-extern PRAT rat_negsmallest;
-extern PRAT rat_max_exp;
-extern PRAT rat_min_exp;
-extern PRAT rat_max_fact;
-extern PRAT rat_min_fact;
-extern PRAT rat_max_i32;
-extern PRAT rat_min_i32;
-
-// DUPNUM Duplicates a number taking care of allocation and internals
-#define DUPNUM(a, b)                                                                                                                                           \
-    destroynum(a);                                                                                                                                             \
-    createnum(a, (b)->cdigit);                                                                                                                                 \
-    _dupnum(a, b);
+class RATPACKCONTEXT
+{
+public:
+    RATPACKCONTEXT();
+    RATPACKCONTEXT(const RATPACKCONTEXT& src); // deep copy of the constants
+    RATPACKCONTEXT& operator=(const RATPACKCONTEXT& src);
+    ~RATPACKCONTEXT();
+
+    uint32_t radix;           // radix and precision of the last ChangeConstants
+    int32_t precision;
+    int32_t ratio;            // int(log(2L^BASEXPWR)/log(radix))
+    int32_t cbitsofprecision; // precision the constants are good for
+    bool ftrueinfinite;       // set to true to allow infinite precision
+                              // don't use unless you know what you are doing
+                              // used to help decide when to stop calculating.
+    wchar_t decimalSeparator;
+
+    PNUMBER num_one;
+    PNUMBER num_two;
+    PNUMBER num_five;
+    PNUMBER num_six;
+    PNUMBER num_ten;
+
+    PRAT ln_ten;
+    PRAT ln_two;
+    PRAT rat_zero;
+    PRAT rat_neg_one;
+    PRAT rat_one;
+    PRAT rat_two;
+    PRAT rat_six;
+    PRAT rat_half;
+    PRAT rat_ten;
+    PRAT pt_eight_five;
+    PRAT pi;
+    PRAT pi_over_two;
+    PRAT two_pi;
+    PRAT one_pt_five_pi;
+    PRAT e_to_one_half;
+    PRAT rat_exp;
+    PRAT rad_to_deg;
+    PRAT rad_to_grad;
+    PRAT rat_qword;
+    PRAT rat_dword;
+    PRAT rat_word;
+    PRAT rat_byte;
+    PRAT rat_360;
+    PRAT rat_400;
+    PRAT rat_180;
+    PRAT rat_200;
+    PRAT rat_nRadix;
+    PRAT rat_smallest;
+    PRAT rat_negsmallest;
+    PRAT rat_max_exp;
+    PRAT rat_min_exp;
+    PRAT rat_max_fact;
+    PRAT rat_min_fact;
+    PRAT rat_max_i32;
+    PRAT rat_min_i32;
+
+    int32_t fx_limbs;   // BASEX digits past the point of fx_pi and fx_ln_two
+    PNUMBER fx_pi;      // pi and ln(2) in fixed point for the AGM log
+    PNUMBER fx_ln_two;
+};
+
+extern RATPACKCONTEXT g_ratpackdefault;        // the context of threads that did not pick one
+extern thread_local RATPACKCONTEXT* g_ratpack; // this thread's context
+
+// Makes ctx the context of this thread for the lifetime of the scope.
+class RATPACKCONTEXTSCOPE
+{
+public:
+    explicit RATPACKCONTEXTSCOPE(RATPACKCONTEXT& ctx)
+        : m_previous(g_ratpack)
+    {
+        g_ratpack = &ctx;
+    }
+    ~RATPACKCONTEXTSCOPE()
+    {
+        g_ratpack = m_previous;
+    }
+    RATPACKCONTEXTSCOPE(const RATPACKCONTEXTSCOPE&) = delete;
+    RATPACKCONTEXTSCOPE& operator=(const RATPACKCONTEXTSCOPE&) = delete;
+
+private:
+    RATPACKCONTEXT* m_previous;
+};
+
+// Per thread counters of the constant sets ChangeConstants keeps for the
+// radix and precision pairs used last.
+typedef struct _constantcachecounters
+{
+    uint64_t hits;   // sets copied from the cache
+    uint64_t misses; // sets that had to be built
+} CONSTANTCACHECOUNTERS;
+
+// DUPNUM Duplicates a number taking care of allocation and internals, the
+// destination allocation is reused when it is big enough.
+#define DUPNUM(a, b) _copynum(&(a), b);
 
 // DUPRAT Duplicates a rational taking care of allocation and internals
-#define DUPRAT(a, b)                                                                                                                                           \
-    destroyrat(a);                                                                                                                                             \
-    createrat(a);                                                                                                                                              \
-    DUPNUM((a)->pp, (b)->pp);                                                                                                                                  \
-    DUPNUM((a)->pq, (b)->pq);
+#define DUPRAT(a, b) _copyrat(&(a), b);
 
 // LOG*RADIX calculates the integral portion of the log of a number in
 // the base currently being used, only accurate to within g_ratio
 
-#define LOGNUMRADIX(pnum) (((pnum)->cdigit + (pnum)->exp) * g_ratio)
+#define LOGNUMRADIX(pnum) (((pnum)->cdigit + (pnum)->exp) * g_ratpack->ratio)
 #define LOGRATRADIX(prat) (LOGNUMRADIX((prat)->pp) - LOGNUMRADIX((prat)->pq))
 
 // LOG*2 calculates the integral portion of the log of a number in
@@ -228,9 +313,9 @@ extern PRAT rat_min_i32;
 
 // TRIMNUM ASSUMES the number is in radix form NOT INTERNAL BASEX!!!
 #define TRIMNUM(x, precision)                                                                                                                                  \
-    if (!g_ftrueinfinite)                                                                                                                                      \
+    if (!g_ratpack->ftrueinfinite)                                                                                                                             \
     {                                                                                                                                                          \
-        int32_t trim = (x)->cdigit - precision - g_ratio;                                                                                                      \
+        int32_t trim = (x)->cdigit - precision - g_ratpack->ratio;                                                                                             \
         if (trim > 1)                                                                                                                                          \
         {                                                                                                                                                      \
             memmove((x)->mant, &((x)->mant[trim]), sizeof(MANTTYPE) * ((x)->cdigit - trim));                                                                   \
@@ -240,9 +325,9 @@ extern PRAT rat_min_i32;
     }
 // TRIMTOP ASSUMES the number is in INTERNAL BASEX!!!
 #define TRIMTOP(x, precision)                                                                                                                                  \
-    if (!g_ftrueinfinite)                                                                                                                                      \
+    if (!g_ratpack->ftrueinfinite)                                                                                                                             \
     {                                                                                                                                                          \
-        int32_t trim = (x)->pp->cdigit - (precision / g_ratio) - 2;                                                                                            \
+        int32_t trim = (x)->pp->cdigit - (precision / g_ratpack->ratio) - 2;                                                                                   \
         if (trim > 1)                                                                                                                                          \
         {                                                                                                                                                      \
             memmove((x)->pp->mant, &((x)->pp->mant[trim]), sizeof(MANTTYPE) * ((x)->pp->cdigit - trim));                                                       \
@@ -254,64 +339,67 @@ extern PRAT rat_min_i32;
         (x)->pq->exp -= trim;                                                                                                                                  \
     }
 
-#define SMALL_ENOUGH_RAT(a, precision) (zernum((a)->pp) || ((((a)->pq->cdigit + (a)->pq->exp) - ((a)->pp->cdigit + (a)->pp->exp) - 1) * g_ratio > precision))
+#define SMALL_ENOUGH_NUM(a, precision)                                                                                                                         \
+    (zernum(a) || ((-LOGNUM2(a) - 1) * g_ratpack->ratio > precision))
 
 //-----------------------------------------------------------------------------
 //
 //   Defines for setting up taylor series expansions for infinite precision
-//   functions.
+//   functions.  The terms and the sum are fixed point numbers, see fixed.cpp,
+//   with x and xx holding *px and its square, the sum goes back to a
+//   rational in DESTROYTAYLOR.  The digits past the point grow with the
+//   leading zeros of a small *px, the odd series start at x and have to
+//   keep precision digits of it.
 //
 //-----------------------------------------------------------------------------
 
 #define CREATETAYLOR()                                                                                                                                         \
-    PRAT xx = nullptr;                                                                                                                                         \
+    int32_t limbs = _fxlimbs(precision) + std::max(0, -LOGRAT2(*px));                                                                                          \
+    PNUMBER x = _rattofx(*px, limbs);                                                                                                                          \
+    PNUMBER xx = nullptr;                                                                                                                                      \
     PNUMBER n2 = nullptr;                                                                                                                                      \
-    PRAT pret = nullptr;                                                                                                                                       \
-    PRAT thisterm = nullptr;                                                                                                                                   \
-    DUPRAT(xx, *px);                                                                                                                                           \
-    mulrat(&xx, *px, precision);                                                                                                                               \
-    createrat(pret);                                                                                                                                           \
-    pret->pp = i32tonum(0L, BASEX);                                                                                                                            \
-    pret->pq = i32tonum(0L, BASEX);
+    PNUMBER pret = i32tonum(0L, BASEX);                                                                                                                        \
+    PNUMBER thisterm = nullptr;                                                                                                                                \
+    DUPNUM(xx, x);                                                                                                                                             \
+    _fxmul(&xx, x, limbs);
 
 #define DESTROYTAYLOR()                                                                                                                                        \
     destroynum(n2);                                                                                                                                            \
-    destroyrat(xx);                                                                                                                                            \
-    destroyrat(thisterm);                                                                                                                                      \
+    destroynum(x);                                                                                                                                             \
+    destroynum(xx);                                                                                                                                            \
+    destroynum(thisterm);                                                                                                                                      \
     destroyrat(*px);                                                                                                                                           \
-    trimit(&pret, precision);                                                                                                                                  \
-    *px = pret;
+    *px = _fxtorat(pret);                                                                                                                                      \
+    destroynum(pret);                                                                                                                                          \
+    trimit(px, precision);
 
 // INC(a) is the rational equivalent of a++
 // Check to see if we can avoid doing this the hard way.
 #define INC(a)                                                                                                                                                 \
-    if ((a)->mant[0] < BASEX - 1)                                                                                                                              \
+    if ((a)->mant[0] < BASEXMAX)                                                                                                                               \
     {                                                                                                                                                          \
         (a)->mant[0]++;                                                                                                                                        \
     }                                                                                                                                                          \
     else                                                                                                                                                       \
     {                                                                                                                                                          \
-        addnum(&(a), num_one, BASEX);                                                                                                                          \
+        addnum(&(a), g_ratpack->num_one, BASEX);                                                                                                               \
     }
 
 #define MSD(x) ((x)->mant[(x)->cdigit - 1])
-// MULNUM(b) is the rational equivalent of thisterm *= b where thisterm is
-// a rational and b is a number, NOTE this is a mixed type operation for
-// efficiency reasons.
-#define MULNUM(b) mulnumx(&(thisterm->pp), b);
+// MULNUM(b) is thisterm *= b where b is an integer, it is exact.
+#define MULNUM(b) mulnumx(&thisterm, b);
 
-// DIVNUM(b) is the rational equivalent of thisterm /= b where thisterm is
-// a rational and b is a number, NOTE this is a mixed type operation for
-// efficiency reasons.
-#define DIVNUM(b) mulnumx(&(thisterm->pq), b);
+// DIVNUM(b) is thisterm /= b where b is an integer, usually a single digit
+// division.
+#define DIVNUM(b) _fxdiv(&thisterm, b, limbs);
 
-// NEXTTERM(p,d) is the rational equivalent of
+// NEXTTERM(p,d) is the fixed point equivalent of
 // thisterm *= p
 // d    <d is usually an expansion of operations to get thisterm updated.>
 // pret += thisterm
 #define NEXTTERM(p, d, precision)                                                                                                                              \
-    mulrat(&thisterm, p, precision);                                                                                                                           \
-    d addrat(&pret, thisterm, precision)
+    _fxmul(&thisterm, p, limbs);                                                                                                                               \
+    d addnum(&pret, thisterm, BASEX)
 
 //-----------------------------------------------------------------------------
 //
@@ -319,11 +407,58 @@ extern PRAT rat_min_i32;
 //
 //-----------------------------------------------------------------------------
 
-extern bool g_ftrueinfinite; // set to true to allow infinite precision
-                             // don't use unless you know what you are doing
-                             // used to help decide when to stop calculating.
+// Operand sizes, in digits of the shorter operand, at which each multiply
+// algorithm takes over from the previous one.  Tunable, the defaults live in
+// mul.cpp.
+typedef struct _mulcrossover
+{
+    int32_t karatsuba;    // grade school below this
+    int32_t toom3;        // Karatsuba below this
+    int32_t ntt;          // Toom-3 below this, three prime NTT above
+    int32_t sqrkaratsuba; // grade school squaring below this, squares follow toom3 and ntt above it
+} MULCROSSOVER;
 
-extern int32_t g_ratio; // Internally calculated ratio of internal radix
+extern MULCROSSOVER g_mulcrossover;
+
+// Per thread counters of the NUMBER and RAT allocator in pool.cpp.  The
+// allocations avoided are requests - heap + dupkept.
+typedef struct _poolcounters
+{
+    uint64_t requests; // blocks asked for
+    uint64_t heap;     // requests that went to the heap
+    uint64_t reused;   // requests served from a free list
+    uint64_t carved;   // requests carved from an arena chunk
+    uint64_t dupkept;  // DUPNUM copies that kept the destination allocation
+} POOLCOUNTERS;
+
+// Size classes of the allocator are powers of two from 2^POOL_MIN_SHIFT
+// bytes, bigger blocks come straight from the heap.
+#define POOL_MIN_SHIFT 6
+#define POOL_CLASSES 9
+
+typedef struct _arenachunk ARENACHUNK;
+
+// While a RATPACKARENA is alive the NUMBER and RAT blocks of its thread are
+// carved from large chunks that are all released when it goes out of
+// scope, wrap a self contained calculation in one.
+class RATPACKARENA
+{
+public:
+    RATPACKARENA();
+    ~RATPACKARENA();
+    RATPACKARENA(const RATPACKARENA&) = delete;
+    RATPACKARENA& operator=(const RATPACKARENA&) = delete;
+
+    void* _alloc(size_t cb, int32_t sizeclass);
+    void _release(void* block, int32_t sizeclass);
+
+private:
+    RATPACKARENA* m_previous; // arena this one is nested in
+    ARENACHUNK* m_chunks;     // chunks carved so far, newest first
+    char* m_next;             // unused space in the newest chunk
+    size_t m_left;
+    void* m_free[POOL_CLASSES]; // blocks freed back to the arena
+};
 
 //-----------------------------------------------------------------------------
 //
@@ -336,6 +471,7 @@ extern void SetDecimalSeparator(wchar_t decimalSeparator);
 
 // Call whenever either radix or precision changes, is smarter about recalculating constants.
 extern void ChangeConstants(uint32_t radix, int32_t precision);
+extern CONSTANTCACHECOUNTERS& _constantcachecounters(); // this thread's ChangeConstants cache counters
 
 extern bool equnum(_In_ PNUMBER a, _In_ PNUMBER b);  // returns true of a == b
 extern bool lessnum(_In_ PNUMBER a, _In_ PNUMBER b); // returns true of a < b
@@ -370,10 +506,17 @@ extern PNUMBER i32prodnum(int32_t start, int32_t stop, uint32_t radix);
 extern PNUMBER i32tonum(int32_t ini32, uint32_t radix);
 extern PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix);
 extern PNUMBER numtonRadixx(PNUMBER a, uint32_t radix);
+extern PNUMBER _radixtobasex(_In_ const MANTTYPE* d, int32_t cdigit, uint32_t radix); // integer digits in radix to BASEX
+extern PNUMBER _basextoradix(_In_ const MANTTYPE* a, int32_t cdigit, uint32_t radix); // integer BASEX digits to radix
 
 // creates a empty/undefined rational representation (p/q)
 extern PRAT _createrat(void);
 
+extern void* zmalloc(size_t cb); // zeroed block from the pool allocator
+extern void zfree(void* block); // returns a zmalloc block
+extern size_t zsize(_In_ const void* block); // usable bytes of a zmalloc block
+extern POOLCOUNTERS& _poolcounters(); // this thread's allocator counters
+
 // returns a new rat structure with the acos of x->p/x->q taking into account
 // angle type
 extern void acosanglerat(_Inout_ PRAT* px, ANGLE_TYPE angletype, uint32_t radix, int32_t precision);
@@ -420,9 +563,31 @@ extern void _exprat(_Inout_ PRAT* px, int32_t precision);
 // returns a new rat structure with the exp of x->p/x->q
 extern void exprat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 
+// binary splitting series in series.cpp, these should not be called explicitly.
+extern bool _bsfaster(SERIES_TYPE series, int32_t precision);                  // true when they beat the taylor series
+extern void _bsexprat(_Inout_ PRAT* px, int32_t precision);                    // exp of x->p/x->q
+extern void _bsatanrat(_Inout_ PRAT* px, bool fhyperbolic, int32_t precision); // atan or atanh of x->p/x->q, abs(x) <= 1/2
+extern PRAT _bspirat(int32_t precision);                                       // pi
+
+// fixed point numbers for the taylor series in fixed.cpp, these should not be called explicitly.
+extern int32_t _fxlimbs(int32_t precision);                             // BASEX digits past the point for precision
+extern void _fxtrunc(_Inout_ PNUMBER a, int32_t limbs);                 // drops the digits below BASEX^-limbs
+extern void _fxmul(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t limbs); // *pa *= b truncated
+extern void _fxdiv(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t limbs); // *pa /= b truncated
+extern PNUMBER _rattofx(_In_ PRAT prat, int32_t limbs);                 // prat truncated to a fixed point number
+extern PRAT _fxtorat(_In_ PNUMBER pnum);                                // the rational of a fixed point number
+extern void _fxsqrt(_Inout_ PNUMBER* pa, int32_t limbs);                // *pa = sqrt(*pa) truncated, in root.cpp
+
 // returns a new rat structure with the log base 10 of x->p/x->q
 extern void log10rat(_Inout_ PRAT* px, int32_t precision);
 
+// returns a new rat structure with the natural log of x->p/x->q this should not be called explicitly.
+extern void _lograt(_Inout_ PRAT* px, int32_t precision);
+
+// natural log by the arithmetic-geometric mean in agm.cpp, these should not be called explicitly.
+extern bool _agmfaster(int32_t precision); // true when it beats the series
+extern void _agmlograt(_Inout_ PRAT* px, int32_t precision);
+
 // returns a new rat structure with the natural log of x->p/x->q
 extern void lograt(_Inout_ PRAT* px, int32_t precision);
 
@@ -445,6 +610,8 @@ extern void tanrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 extern void tananglerat(_Inout_ PRAT* px, ANGLE_TYPE angletype, uint32_t radix, int32_t precision);
 
 extern void _dupnum(_In_ PNUMBER dest, _In_ const NUMBER* const src);
+extern void _copynum(_Inout_ PNUMBER* pdest, _In_ const NUMBER* const src);
+extern void _copyrat(_Inout_ PRAT* pdest, _In_ const RAT* const src);
 
 extern void _destroynum(_In_ PNUMBER pnum);
 extern void _destroyrat(_In_ PRAT prat);
@@ -453,6 +620,15 @@ extern void addrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void andrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t precision);
 extern void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision);
+extern void _divnumdigits(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t thismax);
+extern void _divmant(
+    _Out_ MANTTYPE* q,
+    _Out_opt_ MANTTYPE* r,
+    _In_ const MANTTYPE* u,
+    int32_t cdigitu,
+    _In_ const MANTTYPE* v,
+    int32_t cdigitv,
+    uint32_t radix);
 extern void divrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void fracrat(_Inout_ PRAT* pa, uint32_t radix, int32_t precision);
 extern void factrat(_Inout_ PRAT* pa, uint32_t radix, int32_t precision);
@@ -462,9 +638,12 @@ extern void gcdrat(_Inout_ PRAT* pa, int32_t precision);
 extern void intrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 extern void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
 extern void mulnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b);
+extern void _mulmant(_Out_ MANTTYPE* c, _In_ const MANTTYPE* a, int32_t cdigita, _In_ const MANTTYPE* b, int32_t cdigitb, uint32_t radix);
+extern bool _mulmantntt(_Out_ MANTTYPE* c, _In_ const MANTTYPE* a, int32_t cdigita, _In_ const MANTTYPE* b, int32_t cdigitb, uint32_t radix);
 extern void mulrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t precision);
 extern void numpowi32x(_Inout_ PNUMBER* proot, int32_t power);
+extern int32_t _powwindow(uint32_t power); // bits per window of the sliding window powers
 extern void orrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powratNumeratorDenominator(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
@@ -472,12 +651,18 @@ extern void powratcomp(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t pr
 extern void ratpowi32(_Inout_ PRAT* proot, int32_t power, int32_t precision);
 extern void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
 extern void rootrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
+extern void ratrooti32(_Inout_ PRAT* proot, int32_t root, int32_t precision); // *proot = *proot^(1/root) for the roots rootdegree picks
+extern int32_t rootdegree(_In_ PRAT n);                                        // n when ratrooti32 takes the n'th root, else 0
 extern void scale2pi(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 extern void scale(_Inout_ PRAT* px, _In_ PRAT scalefact, uint32_t radix, int32_t precision);
 extern void subrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void xorrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void lshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void rshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
+extern void shiftrat(_Inout_ PRAT* pa, int32_t bits, int32_t precision); // *pa *= 2^bits
+extern void _shlnum(_Inout_ PNUMBER* pa, uint32_t bits);                // *pa <<= bits on the magnitude
+extern int32_t _popcountnum(_In_ PNUMBER a);                            // set bits of the integer part of a
+extern int32_t _ctznum(_In_ PNUMBER a);                                 // trailing zero bits of an integer a
 extern bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_neq(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t precision);
@@ -0,0 +1,472 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           root.cpp
+//
+//
+//  Description
+//
+//     Contains the roots of small integer degree.  The root of a rational is
+//  the integer root of its numerator times a power of its denominator, found
+//  with Newton's iteration on BASEX digits.  The iteration is started from
+//  the root of the top half of the digits, so it costs a few multiplies and
+//  divides of the full length, where exp(ln(x)/n) sums two series, and a
+//  perfect power comes out as its exact root.
+//
+//-----------------------------------------------------------------------------
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "ratpak.h"
+#include "mantissa.h"
+
+using namespace std;
+
+// BASEX digits worked out past the precision asked for.
+static constexpr int32_t ROOT_GUARD_LIMBS = 2;
+
+// Fixed point roots with fewer BASEX digits than this are taken as integer
+// roots, longer ones from the reciprocal root, which only multiplies.
+static constexpr int32_t ROOT_RECIPROCAL_LIMBS = 8;
+
+// BASEX digits of the integer root the reciprocal root starts from.
+static constexpr int32_t ROOT_SEED_LIMBS = 3;
+
+// The largest degree taken with Newton's iteration.  The integer the root is
+// taken of grows with the degree and every step raises to the degree less
+// one, past this exp(ln(x)/n) is cheaper.
+static constexpr int32_t ROOT_MAX_DEGREE = 32;
+
+namespace
+{
+    void trim(vector<MANTTYPE>& a)
+    {
+        a.resize(_mantlen(a.data(), (int32_t)a.size()));
+    }
+
+    vector<MANTTYPE> mul(const vector<MANTTYPE>& a, const vector<MANTTYPE>& b)
+    {
+        vector<MANTTYPE> c(a.size() + b.size(), 0);
+        if (!a.empty() && !b.empty())
+        {
+            _mulmant(c.data(), a.data(), (int32_t)a.size(), b.data(), (int32_t)b.size(), BASEX);
+        }
+        trim(c);
+        return c;
+    }
+
+    // a^k for k >= 1, highest bit of k first.
+    vector<MANTTYPE> power(const vector<MANTTYPE>& a, uint32_t k)
+    {
+        uint32_t bit = 1;
+        while (bit <= k / 2)
+        {
+            bit <<= 1;
+        }
+
+        vector<MANTTYPE> c = a;
+        for (bit >>= 1; bit != 0; bit >>= 1)
+        {
+            c = mul(c, c);
+            if (k & bit)
+            {
+                c = mul(c, a);
+            }
+        }
+        return c;
+    }
+
+    // a = a * m + d for single digits m and d.
+    void muladddigit(vector<MANTTYPE>& a, MANTTYPE m, MANTTYPE d)
+    {
+        TWO_MANTTYPE carry = d;
+        for (MANTTYPE& digit : a)
+        {
+            carry += (TWO_MANTTYPE)digit * m;
+            digit = (MANTTYPE)(carry & BASEXMAX);
+            carry >>= BASEXPWR;
+        }
+        if (carry != 0)
+        {
+            a.push_back((MANTTYPE)carry);
+        }
+        trim(a);
+    }
+
+    // a /= d for a single digit d, truncated.
+    void divdigit(vector<MANTTYPE>& a, MANTTYPE d)
+    {
+        TWO_MANTTYPE rem = 0;
+        for (size_t i = a.size(); i-- > 0;)
+        {
+            rem = (rem << BASEXPWR) | a[i];
+            a[i] = (MANTTYPE)(rem / d);
+            rem %= d;
+        }
+        trim(a);
+    }
+
+    // Returns floor(n^(1/k)) of the integer n for k >= 2 and sets *pexact
+    // when that is the root exactly.
+    vector<MANTTYPE> introot(const vector<MANTTYPE>& n, uint32_t k, bool* pexact)
+    {
+        *pexact = true;
+        if (n.empty())
+        {
+            return n;
+        }
+
+        // x must start at or above the root.  A short root starts at the
+        // power of two past it, a long one one past the root of the top
+        // digits, shifted back up, which is already right to half its
+        // digits.
+        vector<MANTTYPE> x;
+        uint32_t rootdigits = ((uint32_t)n.size() + k - 1) / k;
+        if (rootdigits <= 2)
+        {
+            uint32_t bits = (uint32_t)(n.size() - 1) * BASEXPWR;
+            for (MANTTYPE top = n.back(); top != 0; top >>= 1)
+            {
+                bits++;
+            }
+            bits = (bits + k - 1) / k;
+            x.assign(bits / BASEXPWR + 1, 0);
+            x.back() = (MANTTYPE)1 << (bits % BASEXPWR);
+        }
+        else
+        {
+            uint32_t shift = rootdigits / 2;
+            vector<MANTTYPE> top(n.begin() + shift * k, n.end());
+            bool exact;
+            x = introot(top, k, &exact);
+            muladddigit(x, 1, 1);
+            x.insert(x.begin(), shift, 0);
+        }
+
+        // From above the Newton step x = ((k-1) x + n / x^(k-1)) / k goes
+        // down to the root and stops there, where the quotient is no longer
+        // below x.
+        vector<MANTTYPE> q;
+        vector<MANTTYPE> r;
+        while (true)
+        {
+            vector<MANTTYPE> p = power(x, k - 1);
+            q.assign(n.size() + 1, 0);
+            r.assign(max(n.size(), p.size()), 0);
+            _divmant(q.data(), r.data(), n.data(), (int32_t)n.size(), p.data(), (int32_t)p.size(), BASEX);
+            trim(q);
+            int32_t cmp = _mantcmp(q.data(), (int32_t)q.size(), x.data(), (int32_t)x.size());
+            if (cmp >= 0)
+            {
+                *pexact = cmp == 0 && _mantlen(r.data(), (int32_t)p.size()) == 0;
+                return x;
+            }
+
+            muladddigit(x, k - 1, 0);
+            MANTTYPE carry = _mantaddto(BASEXDIGITS{}, x.data(), (int32_t)x.size(), q.data(), (int32_t)q.size());
+            if (carry != 0)
+            {
+                x.push_back(carry);
+            }
+            divdigit(x, k);
+        }
+    }
+
+    // The fixed point number of the digits a BASEX^exp.
+    PNUMBER vectonum(const vector<MANTTYPE>& a, int32_t exp)
+    {
+        PNUMBER pnumret = nullptr;
+        createnum(pnumret, max((uint32_t)a.size(), 1u));
+        if (a.empty())
+        {
+            pnumret->cdigit = 1;
+            pnumret->exp = 0;
+            pnumret->mant[0] = 0;
+        }
+        else
+        {
+            memcpy(pnumret->mant, a.data(), a.size() * sizeof(MANTTYPE));
+            pnumret->cdigit = (int32_t)a.size();
+            pnumret->exp = exp;
+        }
+        pnumret->sign = 1;
+        return pnumret;
+    }
+
+    // The digits of the fixed point number a BASEX^(2 limbs), truncated.
+    vector<MANTTYPE> fxtovec(PNUMBER a, int32_t limbs)
+    {
+        vector<MANTTYPE> n;
+        int32_t shift = a->exp + 2 * limbs;
+        if (shift >= 0)
+        {
+            n.assign(shift, 0);
+            n.insert(n.end(), a->mant, a->mant + a->cdigit);
+        }
+        else if (-shift < a->cdigit)
+        {
+            n.assign(a->mant - shift, a->mant + a->cdigit);
+        }
+        trim(n);
+        return n;
+    }
+
+    // sqrt(n) for n in [BASEX^-2, 1) to limbs digits past the point.  y =
+    // 1/sqrt(n) is taken to half the digits by the Newton step
+    //
+    //     y = y + y (1 - n y^2) / 2
+    //
+    // at doubling precision from the root of the top digits, then the root
+    // r = n y is corrected once by r = r + y (n - r^2) / 2, which doubles its
+    // digits again.  Nothing but the first few digits is divided.
+    PNUMBER sqrtreciprocal(PNUMBER n, int32_t limbs)
+    {
+        // The integer root of the top digits is good to all but its last.
+        bool exact;
+        PNUMBER r = vectonum(introot(fxtovec(n, ROOT_SEED_LIMBS), 2, &exact), -ROOT_SEED_LIMBS);
+        PNUMBER y = nullptr;
+        DUPNUM(y, g_ratpack->num_one);
+        _fxdiv(&y, r, ROOT_SEED_LIMBS + 1);
+        destroynum(r);
+
+        // The numbers run from BASEX^-2 to BASEX^2, truncating two digits
+        // further past the point than they need keeps the relative error.
+        int32_t half = limbs / 2 + ROOT_GUARD_LIMBS;
+        PNUMBER e = nullptr;
+        PNUMBER nt = nullptr;
+        for (int32_t good = ROOT_SEED_LIMBS - 1; good < half;)
+        {
+            int32_t l = min(2 * good, half) + ROOT_GUARD_LIMBS;
+            DUPNUM(nt, n);
+            _fxtrunc(nt, l + 2);
+            DUPNUM(e, y);
+            _fxmul(&e, y, l + 2);
+            _fxmul(&e, nt, l + 2);
+            e->sign *= -1;
+            addnum(&e, g_ratpack->num_one, BASEX);
+            _fxmul(&e, y, l + 2);
+            _fxdiv(&e, g_ratpack->num_two, l + 2);
+            addnum(&y, e, BASEX);
+            _fxtrunc(y, l + 2);
+            good = min(2 * good, l) - 1;
+        }
+
+        DUPNUM(r, n);
+        _fxtrunc(r, half + 2);
+        _fxmul(&r, y, half + 2);
+        DUPNUM(e, r);
+        mulnumx(&e, r);
+        e->sign *= -1;
+        addnum(&e, n, BASEX);
+        _fxtrunc(e, limbs + 2);
+        _fxmul(&e, y, limbs + 2);
+        _fxdiv(&e, g_ratpack->num_two, limbs + 2);
+        addnum(&r, e, BASEX);
+        _fxtrunc(r, limbs);
+
+        destroynum(e);
+        destroynum(nt);
+        destroynum(y);
+        return r;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: rootdegree
+//
+//  ARGUMENTS: a rational number.
+//
+//  RETURN: The integer n is, when ratrooti32 takes its root, 0 otherwise.
+//
+//-----------------------------------------------------------------------------
+
+int32_t rootdegree(PRAT n)
+
+{
+    PNUMBER p = n->pp;
+    PNUMBER q = n->pq;
+    if (p->cdigit != 1 || p->exp != 0 || q->cdigit != 1 || q->exp != 0 || q->mant[0] != 1 || p->mant[0] < 2 || p->mant[0] > ROOT_MAX_DEGREE)
+    {
+        return 0;
+    }
+    return (int32_t)p->mant[0] * p->sign * q->sign;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: ratrooti32
+//
+//  ARGUMENTS: number as rational, root as int32_t and precision as int32_t.
+//
+//  RETURN: None, number is changed.
+//
+//  DESCRIPTION: changes the rational to its root'th root, a negative root
+//  gives the inverse.  The root of p/q is the root of the integer p q^(root-1)
+//  over q, the integer is shifted up by whole BASEX digits until its root
+//  is long enough for precision.  Exact when the rational is a perfect power.
+//  Only roots up to ROOT_MAX_DEGREE, as picked by rootdegree.
+//
+//-----------------------------------------------------------------------------
+
+void ratrooti32(PRAT* px, int32_t root, int32_t precision)
+
+{
+    PNUMBER p = (*px)->pp;
+    PNUMBER q = (*px)->pq;
+    int32_t sign = p->sign * q->sign;
+    int32_t k = root < 0 ? -root : root;
+
+    if (sign == -1 && (k & 1) == 0)
+    {
+        throw(CALC_E_DOMAIN);
+    }
+    if (zernum(p))
+    {
+        if (root < 0)
+        {
+            throw(CALC_E_DOMAIN);
+        }
+        return;
+    }
+
+    // p/q is n BASEX^(k f) / q^k for n = p q^(k-1) shifted up by enough
+    // BASEX digits that its root has at least limbs digits, so the root is
+    // root(n) BASEX^f / q.
+    vector<MANTTYPE> qmant(q->mant, q->mant + q->cdigit);
+    vector<MANTTYPE> n = mul(vector<MANTTYPE>(p->mant, p->mant + p->cdigit), power(qmant, k - 1));
+    int32_t limbs = precision / g_ratpack->ratio + ROOT_GUARD_LIMBS;
+    int32_t e = p->exp - q->exp;
+    int32_t j = max(k * limbs - (int32_t)n.size(), 0);
+    int32_t f = (e - j) / k;
+    if (f * k > e - j)
+    {
+        f--;
+    }
+    n.insert(n.begin(), e - f * k, 0);
+
+    bool exact;
+    vector<MANTTYPE> r = introot(n, k, &exact);
+
+    int32_t low = 0;
+    while (r[low] == 0)
+    {
+        low++;
+    }
+
+    PRAT pret = nullptr;
+    createrat(pret);
+    createnum(pret->pp, (uint32_t)r.size() - low);
+    memcpy(pret->pp->mant, r.data() + low, (r.size() - low) * sizeof(MANTTYPE));
+    pret->pp->cdigit = (int32_t)r.size() - low;
+    pret->pp->exp = f + low;
+    pret->pp->sign = sign;
+    createnum(pret->pq, q->cdigit);
+    memcpy(pret->pq->mant, q->mant, q->cdigit * sizeof(MANTTYPE));
+    pret->pq->cdigit = q->cdigit;
+    pret->pq->exp = 0;
+    pret->pq->sign = 1;
+
+    // A root below one moves its negative exponent to the denominator, the
+    // numerator of a rational is never given one.
+    if (pret->pp->exp < 0)
+    {
+        pret->pq->exp = -pret->pp->exp;
+        pret->pp->exp = 0;
+    }
+    if (root < 0)
+    {
+        swap(pret->pp, pret->pq);
+        pret->pp->sign = sign;
+        pret->pq->sign = 1;
+    }
+
+    destroyrat(*px);
+    *px = pret;
+    if (!exact)
+    {
+        trimit(px, precision);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _fxsqrt
+//
+//  ARGUMENTS: pointer to a fixed point number and the BASEX digits past the
+//             point.
+//
+//  RETURN: None, changes the number.
+//
+//  DESCRIPTION: Does *pa = sqrt(*pa) to limbs digits past the point.  A
+//  short root is the integer root of *pa BASEX^(2 limbs), truncated, a long
+//  one comes from the reciprocal root and can be a unit of its last digit
+//  off.
+//
+//-----------------------------------------------------------------------------
+
+void _fxsqrt(PNUMBER* pa, int32_t limbs)
+
+{
+    PNUMBER a = *pa;
+    if (a->sign == -1 && !zernum(a))
+    {
+        throw(CALC_E_DOMAIN);
+    }
+
+    // a is n BASEX^(2h) for n in [BASEX^-2, 1), the root of n needs
+    // limbs+h digits past the point.
+    int32_t top = LOGNUM2(a);
+    int32_t h = top >= 0 ? (top + 1) / 2 : -(-top / 2);
+    PNUMBER pret = nullptr;
+    if (zernum(a) || limbs + h < ROOT_RECIPROCAL_LIMBS)
+    {
+        bool exact;
+        pret = vectonum(introot(fxtovec(a, limbs), 2, &exact), -limbs);
+    }
+    else
+    {
+        a->exp -= 2 * h;
+        pret = sqrtreciprocal(a, limbs + h);
+        pret->exp += h;
+        _fxtrunc(pret, limbs);
+    }
+
+    destroynum(*pa);
+    *pa = pret;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: rootrat
+//
+//  PARAMETERS: y prat representation of number to take the root of
+//              n prat representation of the root to take.
+//
+//  RETURN: bth root of a in rat form.
+//
+//  EXPLANATION: Small integer roots go to ratrooti32, anything else is
+//  y^(1/n) from powrat().
+//
+//-----------------------------------------------------------------------------
+
+void rootrat(PRAT* py, PRAT n, uint32_t radix, int32_t precision)
+{
+    int32_t root = rootdegree(n);
+    if (root != 0)
+    {
+        ratrooti32(py, root, precision);
+        return;
+    }
+
+    // Initialize 1/n
+    PRAT oneovern = nullptr;
+    DUPRAT(oneovern, g_ratpack->rat_one);
+    divrat(&oneovern, n, precision);
+
+    powrat(py, oneovern, radix, precision);
+
+    destroyrat(oneovern);
+}
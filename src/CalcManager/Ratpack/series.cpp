@@ -0,0 +1,481 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           series.cpp
+//
+//
+//  Description
+//
+//     Contains the binary splitting evaluation of the exp, atan and atanh
+//  series.  A series whose term ratios are small integers is summed as a
+//  balanced product tree of integers (P, Q, B, T) instead of one rational
+//  term at a time, so the big multiplies are few and large and ride on the
+//  fast multiply in mul.cpp.  An argument with a long mantissa is split into
+//  pieces of doubling bit length (the bit burst method) so each piece is a
+//  series with a short numerator.
+//
+//-----------------------------------------------------------------------------
+#include <cmath>
+#include "ratpak.h"
+
+using namespace std;
+
+// Extra bits a series is summed to on top of the precision asked for.
+static constexpr int32_t SERIES_GUARD_BITS = 8;
+
+// Numerator bits of the first bit burst piece, the following pieces double.
+static constexpr int32_t SERIES_FIRST_PIECE_BITS = 2;
+
+// Below this many bits of precision the fixed point taylor series in exp.cpp
+// and itrans.cpp are faster, indexed by SERIES_TYPE.  The argument
+// reductions in exp.cpp keep the taylor series of exp and log short, so
+// they cross over later than atan.
+static constexpr int32_t SERIES_SPLIT_MIN_BITS[] = { 3200, 2100, 1400 };
+
+// Sums
+//
+//      N-1
+//      ___       1     p(0) p(1) ... p(n)
+//      \  ]    ----- * ------------------
+//      /__]     b(n)   q(0) q(1) ... q(n)
+//      n=0
+//
+// where p(n) and q(n) are p0 and q0 for n = 0 and pn and qn for n > 0.  q(n)
+// is also multiplied by n for n > 0 when factorial is set, b(n) is 2n+1 when
+// oddterms is set and 1 otherwise.
+typedef struct _splitseries
+{
+    PNUMBER p0;
+    PNUMBER q0;
+    PNUMBER pn;
+    PNUMBER qn;
+    bool factorial; // the exp series
+    bool oddterms;  // the atan and atanh series
+} SPLITSERIES;
+
+// The products of p(n), q(n) and b(n) over a range of terms, and the sum
+// over the range times B*Q.
+typedef struct _splitsum
+{
+    PNUMBER P;
+    PNUMBER Q;
+    PNUMBER B;
+    PNUMBER T;
+} SPLITSUM;
+
+namespace
+{
+    // Moves the low zero digits of a into its exponent, the powers of two
+    // in the series then stay in the exponents instead of the mantissas.
+    void stripzeros(PNUMBER a)
+    {
+        int32_t low = 0;
+        while (low < a->cdigit - 1 && a->mant[low] == 0)
+        {
+            low++;
+        }
+        if (low > 0)
+        {
+            memmove(a->mant, a->mant + low, (a->cdigit - low) * sizeof(MANTTYPE));
+            a->cdigit -= low;
+            a->exp += low;
+        }
+    }
+
+    // *pa *= b for integers.
+    void mulint(PNUMBER* pa, PNUMBER b)
+    {
+        mulnumx(pa, b);
+        stripzeros(*pa);
+    }
+
+    // 2^k for k >= 0.
+    PNUMBER pow2num(int32_t k)
+    {
+        PNUMBER pnumret = nullptr;
+        createnum(pnumret, 1);
+        pnumret->cdigit = 1;
+        pnumret->sign = 1;
+        pnumret->exp = k / BASEXPWR;
+        pnumret->mant[0] = (MANTTYPE)1 << (k % BASEXPWR);
+        return pnumret;
+    }
+
+    // *pa = trunc(*pa / b) for nonnegative integers.
+    void divint(PNUMBER* pa, PNUMBER b)
+    {
+        int32_t cdigit = LOGNUM2(*pa) - LOGNUM2(b) + 1;
+        if (cdigit <= 0 || zernum(*pa))
+        {
+            destroynum(*pa);
+            *pa = i32tonum(0L, BASEX);
+            return;
+        }
+        _divnumdigits(pa, b, BASEX, cdigit);
+
+        // Drop the fraction.
+        PNUMBER a = *pa;
+        if (a->exp < 0)
+        {
+            int32_t drop = -a->exp;
+            if (drop >= a->cdigit)
+            {
+                destroynum(*pa);
+                *pa = i32tonum(0L, BASEX);
+                return;
+            }
+            memmove(a->mant, a->mant + drop, (a->cdigit - drop) * sizeof(MANTTYPE));
+            a->cdigit -= drop;
+            a->exp = 0;
+        }
+    }
+
+    // An upper bound on log2(abs(a)).
+    double log2num(PNUMBER a)
+    {
+        return (double)(a->cdigit - 1 + a->exp) * BASEXPWR + log2((double)a->mant[a->cdigit - 1] + 1.0);
+    }
+
+    void destroysum(SPLITSUM& s)
+    {
+        destroynum(s.P);
+        destroynum(s.Q);
+        destroynum(s.B);
+        destroynum(s.T);
+    }
+
+    // s = the products and sum over terms [a, b).
+    void splitsum(const SPLITSERIES& series, int32_t a, int32_t b, SPLITSUM& s)
+    {
+        if (b - a == 1)
+        {
+            DUPNUM(s.P, a == 0 ? series.p0 : series.pn);
+            DUPNUM(s.Q, a == 0 ? series.q0 : series.qn);
+            if (series.factorial && a > 0)
+            {
+                PNUMBER n = i32tonum(a, BASEX);
+                mulint(&s.Q, n);
+                destroynum(n);
+            }
+            s.B = i32tonum(series.oddterms ? 2 * a + 1 : 1, BASEX);
+            DUPNUM(s.T, s.P);
+            return;
+        }
+
+        int32_t mid = a + (b - a) / 2;
+        SPLITSUM r = { nullptr, nullptr, nullptr, nullptr };
+        splitsum(series, a, mid, s);
+        splitsum(series, mid, b, r);
+
+        // T = Br*Qr*Tl + Bl*Pl*Tr
+        mulint(&s.T, r.Q);
+        mulint(&r.T, s.P);
+        if (series.oddterms)
+        {
+            mulint(&s.T, r.B);
+            mulint(&r.T, s.B);
+            mulint(&s.B, r.B);
+        }
+        addnum(&s.T, r.T, BASEX);
+        stripzeros(s.T);
+        mulint(&s.P, r.P);
+        mulint(&s.Q, r.Q);
+
+        destroysum(r);
+    }
+
+    // The sum of the first terms terms of series as a rational.
+    PRAT sumseries(const SPLITSERIES& series, int32_t terms)
+    {
+        SPLITSUM s = { nullptr, nullptr, nullptr, nullptr };
+        splitsum(series, 0, terms, s);
+
+        PRAT pret = nullptr;
+        createrat(pret);
+        pret->pp = s.T;
+        pret->pq = s.Q;
+        mulint(&pret->pq, s.B);
+        s.T = nullptr;
+        s.Q = nullptr;
+        destroysum(s);
+        return pret;
+    }
+
+    // Fractional bits the argument is carried with for precision.
+    int32_t precisionbits(int32_t precision)
+    {
+        return (precision / g_ratpack->ratio + 2) * BASEXPWR;
+    }
+
+    // trunc(abs(x) * 2^w) as an integer.
+    PNUMBER fixedpoint(PRAT x, int32_t w)
+    {
+        PNUMBER z = nullptr;
+        PNUMBER q = nullptr;
+        DUPNUM(z, x->pp);
+        DUPNUM(q, x->pq);
+        z->sign = 1;
+        q->sign = 1;
+        PNUMBER scale = pow2num(w);
+        mulint(&z, scale);
+        divint(&z, q);
+        destroynum(scale);
+        destroynum(q);
+        return z;
+    }
+
+    // Splits the next piece off the fixed point argument r with w fractional
+    // bits: m = the bits of r above 2^-k, r keeps the rest.
+    PNUMBER nextpiece(PNUMBER* pr, int32_t k, int32_t w)
+    {
+        PNUMBER m = nullptr;
+        PNUMBER low = pow2num(w - k);
+        DUPNUM(m, *pr);
+        divint(&m, low);
+        if (!zernum(m))
+        {
+            mulint(&low, m);
+            low->sign = -1;
+            addnum(pr, low, BASEX);
+        }
+        destroynum(low);
+        return m;
+    }
+
+    // Terms needed for the exp series of an argument below 2^l to reach
+    // 2^-bits, the tail is below the last term once c/(n+1) < 1/2.
+    int32_t expterms(double l, int32_t bits)
+    {
+        double term = 0;
+        int32_t n = 0;
+        do
+        {
+            n++;
+            term += l - log2((double)n);
+        } while (term > -bits || n < 2 * exp2(l));
+        return n + 1;
+    }
+
+    // Terms needed for the atan series of an argument below 2^l to reach
+    // 2^-bits.
+    int32_t atanterms(double l, int32_t bits)
+    {
+        int32_t n = 0;
+        while ((2 * n + 1) * l - log2(2.0 * n + 1) > -bits)
+        {
+            n++;
+        }
+        return n + 1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _bsfaster
+//
+//  ARGUMENTS: the series and precision
+//
+//  RETURN: true if binary splitting beats the term by term series at this
+//          precision.
+//
+//-----------------------------------------------------------------------------
+
+bool _bsfaster(SERIES_TYPE series, int32_t precision)
+
+{
+    return precisionbits(precision) >= SERIES_SPLIT_MIN_BITS[series];
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _bsexprat
+//
+//  ARGUMENTS: x PRAT representation of number to exponentiate
+//
+//  RETURN: exp of x in PRAT form.
+//
+//  EXPLANATION: abs(x) is carried as a fixed point number and split into
+//  pieces c  = m / 2^k  with k doubling from piece to piece, so
+//           j    j    j
+//
+//   exp(abs(x)) = exp(c ) * exp(c ) * ...
+//                      0        1
+//
+//  and each exp(c ) is summed by binary splitting with p(n) = m  and
+//                j                                             j
+//  q(n) = n * 2^k .  A negative x gives the reciprocal.
+//                j
+//
+//-----------------------------------------------------------------------------
+
+void _bsexprat(PRAT* px, int32_t precision)
+
+{
+    int32_t w = precisionbits(precision);
+    int32_t bits = w + SERIES_GUARD_BITS;
+    bool fneg = SIGN(*px) == -1;
+    PNUMBER r = fixedpoint(*px, w);
+
+    PRAT pret = nullptr;
+    DUPRAT(pret, g_ratpack->rat_one);
+
+    SPLITSERIES series = { g_ratpack->num_one, g_ratpack->num_one, nullptr, nullptr, true, false };
+    for (int32_t k = SERIES_FIRST_PIECE_BITS; !zernum(r); k = min(2 * k, w))
+    {
+        PNUMBER m = nextpiece(&r, k, w);
+        if (!zernum(m))
+        {
+            series.pn = m;
+            series.qn = pow2num(k);
+            PRAT piece = sumseries(series, expterms(log2num(m) - k, bits));
+            mulrat(&pret, piece, precision);
+            destroyrat(piece);
+            destroynum(series.qn);
+        }
+        destroynum(m);
+    }
+    destroynum(r);
+
+    if (fneg)
+    {
+        PNUMBER pnumtemp = pret->pp;
+        pret->pp = pret->pq;
+        pret->pq = pnumtemp;
+    }
+
+    destroyrat(*px);
+    trimit(&pret, precision);
+    *px = pret;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _bsatanrat, _bsatanhrat
+//
+//  ARGUMENTS: x PRAT representation of number to take the inverse tangent
+//             or inverse hyperbolic tangent of, abs(x) <= 1/2.
+//
+//  RETURN: atan or atanh of x in PRAT form.
+//
+//  EXPLANATION: abs(x) is carried as a fixed point number r, a piece
+//  c = m / 2^k is split off the top and
+//
+//                                  r - c
+//   atan(r) = atan(c) + atan( ----------- )
+//                               1 + r * c
+//
+//  (1 - r * c and atanh for atanh) leaves an argument below 2^-k.  Doubling
+//  k each time every atan(c) is a short numerator series summed by binary
+//  splitting with p(n) = -m^2 (m^2 for atanh), q(n) = 2^2k, b(n) = 2n+1.
+//  Both are odd so the sign of x is put back at the end.
+//
+//-----------------------------------------------------------------------------
+
+void _bsatanrat(PRAT* px, bool fhyperbolic, int32_t precision)
+
+{
+    int32_t sgn = SIGN(*px);
+
+    // The relative precision of a small x is kept.
+    int32_t lz = max(0, -(LOGRAT2(*px) + 1) * (int32_t)BASEXPWR);
+    int32_t w = precisionbits(precision) + lz;
+    int32_t bits = w + SERIES_GUARD_BITS;
+    PNUMBER r = fixedpoint(*px, w);
+
+    PRAT pret = nullptr;
+    DUPRAT(pret, g_ratpack->rat_zero);
+
+    SPLITSERIES series = { nullptr, nullptr, nullptr, nullptr, false, true };
+    for (int32_t k = lz + SERIES_FIRST_PIECE_BITS; !zernum(r); k = min(2 * k, w))
+    {
+        PNUMBER rm = nullptr;
+        DUPNUM(rm, r);
+        PNUMBER m = nextpiece(&r, k, w);
+        if (!zernum(m))
+        {
+            series.p0 = m;
+            series.q0 = pow2num(k);
+            DUPNUM(series.pn, m);
+            mulint(&series.pn, m);
+            series.pn->sign = fhyperbolic ? 1 : -1;
+            series.qn = pow2num(2 * k);
+            PRAT piece = sumseries(series, atanterms(log2num(m) - k, bits));
+            addrat(&pret, piece, precision);
+            destroyrat(piece);
+
+            // r = (r - c) / (1 +- r*c), in fixed point with r the rest
+            // and rm the whole argument that is
+            // r * 2^(w+k) / (2^(w+k) +- rm * m).
+            if (!zernum(r))
+            {
+                PNUMBER scale = pow2num(w + k);
+                PNUMBER den = nullptr;
+                mulint(&rm, m);
+                rm->sign = fhyperbolic ? -1 : 1;
+                DUPNUM(den, scale);
+                addnum(&den, rm, BASEX);
+                mulint(&r, scale);
+                divint(&r, den);
+                destroynum(den);
+                destroynum(scale);
+            }
+            destroynum(series.pn);
+            destroynum(series.q0);
+            destroynum(series.qn);
+        }
+        destroynum(m);
+        destroynum(rm);
+    }
+    destroynum(r);
+
+    pret->pp->sign *= sgn;
+    destroyrat(*px);
+    trimit(&pret, precision);
+    *px = pret;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _bspirat
+//
+//  ARGUMENTS: precision
+//
+//  RETURN: pi in PRAT form.
+//
+//  EXPLANATION: Machin's formula
+//
+//   pi = 16 * atan(1/5) - 4 * atan(1/239)
+//
+//  with both series summed by binary splitting with p(0) = 1, q(0) = n,
+//  p(n) = -1, q(n) = n^2, b(n) = 2n+1.
+//
+//-----------------------------------------------------------------------------
+
+PRAT _bspirat(int32_t precision)
+
+{
+    static constexpr int32_t MACHIN[][2] = { { 16, 5 }, { -4, 239 } };
+    int32_t bits = precisionbits(precision) + SERIES_GUARD_BITS;
+
+    PRAT pret = nullptr;
+    DUPRAT(pret, g_ratpack->rat_zero);
+
+    for (const auto& term : MACHIN)
+    {
+        SPLITSERIES series = { g_ratpack->num_one, i32tonum(term[1], BASEX), i32tonum(-1, BASEX), i32tonum(term[1] * term[1], BASEX), false, true };
+        PRAT piece = sumseries(series, atanterms(-log2((double)term[1]), bits));
+        PRAT factor = i32torat(term[0]);
+        mulrat(&piece, factor, precision);
+        addrat(&pret, piece, precision);
+        destroyrat(factor);
+        destroyrat(piece);
+        destroynum(series.q0);
+        destroynum(series.pn);
+        destroynum(series.qn);
+    }
+
+    trimit(&pret, precision);
+    return pret;
+}
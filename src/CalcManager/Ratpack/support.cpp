@@ -18,6 +18,7 @@
 //
 //----------------------------------------------------------------------------
 
+#include <list>
 #include <string>
 #include <cstring>  // for memmove
 #include <iostream> // for wostream
@@ -26,96 +27,223 @@
 using namespace std;
 
 void _readconstants(void);
+static void _buildconstants(uint32_t radix, int32_t precision);
 
 #if defined(GEN_CONST)
-static int cbitsofprecision = 0;
+static constexpr int32_t INITIAL_CBITSOFPRECISION = 0;
 #define READRAWRAT(v)
 #define READRAWNUM(v)
-#define DUMPRAWRAT(v) _dumprawrat(#v, v, wcout)
+#define DUMPRAWRAT(v) _dumprawrat(#v, g_ratpack->v, wcout)
 #define DUMPRAWNUM(v)                                                                                                                                          \
     fprintf(stderr, "// Autogenerated by _dumprawrat in support.cpp\n");                                                                                       \
     fprintf(stderr, "inline const NUMBER init_" #v "= {\n");                                                                                                   \
-    _dumprawnum(v, wcout);                                                                                                                                     \
+    _dumprawnum(g_ratpack->v, wcout);                                                                                                                          \
     fprintf(stderr, "};\n")
 
+#elif RATPAK_LIMB_BITS != 31
+
+// ratconst.h is in 31 bit digits, other limb sizes compute the constants the
+// first time ChangeConstants is called and keep them after that.
+static constexpr int32_t INITIAL_CBITSOFPRECISION = 0;
+#define READRAWRAT(v)
+#define READRAWNUM(v)
+#define DUMPRAWRAT(v)
+#define DUMPRAWNUM(v)
+
 #else
 
 #define DUMPRAWRAT(v)
 #define DUMPRAWNUM(v)
 #define READRAWRAT(v)                                                                                                                                          \
-    createrat(v);                                                                                                                                              \
-    DUPNUM((v)->pp, (&(init_p_##v)));                                                                                                                          \
-    DUPNUM((v)->pq, (&(init_q_##v)));
-#define READRAWNUM(v) DUPNUM(v, (&(init_##v)))
+    if (g_ratpack->v == nullptr)                                                                                                                               \
+    {                                                                                                                                                          \
+        createrat(g_ratpack->v);                                                                                                                               \
+    }                                                                                                                                                          \
+    DUPNUM(g_ratpack->v->pp, (&(init_p_##v)));                                                                                                                 \
+    DUPNUM(g_ratpack->v->pq, (&(init_q_##v)));
+#define READRAWNUM(v) DUPNUM(g_ratpack->v, (&(init_##v)))
+
+static constexpr int RATIO_FOR_DECIMAL = 9;
+static constexpr int DECIMAL = 10;
+static constexpr int CALC_DECIMAL_DIGITS_DEFAULT = 32;
+
+static constexpr int32_t INITIAL_CBITSOFPRECISION = RATIO_FOR_DECIMAL * DECIMAL * CALC_DECIMAL_DIGITS_DEFAULT;
+
+#include "ratconst.h"
+
+#endif
 
 #define INIT_AND_DUMP_RAW_NUM_IF_NULL(r, v)                                                                                                                    \
-    if (r == nullptr)                                                                                                                                          \
+    if (g_ratpack->r == nullptr)                                                                                                                               \
     {                                                                                                                                                          \
-        r = i32tonum(v, BASEX);                                                                                                                                \
-        DUMPRAWNUM(v);                                                                                                                                         \
+        g_ratpack->r = i32tonum(v, BASEX);                                                                                                                     \
+        DUMPRAWNUM(r);                                                                                                                                         \
     }
 #define INIT_AND_DUMP_RAW_RAT_IF_NULL(r, v)                                                                                                                    \
-    if (r == nullptr)                                                                                                                                          \
+    if (g_ratpack->r == nullptr)                                                                                                                               \
     {                                                                                                                                                          \
-        r = i32torat(v);                                                                                                                                       \
-        DUMPRAWRAT(v);                                                                                                                                         \
+        g_ratpack->r = i32torat(v);                                                                                                                            \
+        DUMPRAWRAT(r);                                                                                                                                         \
     }
 
-static constexpr int RATIO_FOR_DECIMAL = 9;
-static constexpr int DECIMAL = 10;
-static constexpr int CALC_DECIMAL_DIGITS_DEFAULT = 32;
+// The context of every thread until it picks another one.
+RATPACKCONTEXT g_ratpackdefault;
+thread_local RATPACKCONTEXT* g_ratpack = &g_ratpackdefault;
+
+// The constants a context owns.
+static constexpr PNUMBER RATPACKCONTEXT::*CONTEXT_NUMBERS[] = {
+    &RATPACKCONTEXT::num_one,
+    &RATPACKCONTEXT::num_two,
+    &RATPACKCONTEXT::num_five,
+    &RATPACKCONTEXT::num_six,
+    &RATPACKCONTEXT::num_ten,
+    &RATPACKCONTEXT::fx_pi,
+    &RATPACKCONTEXT::fx_ln_two,
+};
+static constexpr PRAT RATPACKCONTEXT::*CONTEXT_RATS[] = {
+    &RATPACKCONTEXT::ln_ten,
+    &RATPACKCONTEXT::ln_two,
+    &RATPACKCONTEXT::rat_zero,
+    &RATPACKCONTEXT::rat_neg_one,
+    &RATPACKCONTEXT::rat_one,
+    &RATPACKCONTEXT::rat_two,
+    &RATPACKCONTEXT::rat_six,
+    &RATPACKCONTEXT::rat_half,
+    &RATPACKCONTEXT::rat_ten,
+    &RATPACKCONTEXT::pt_eight_five,
+    &RATPACKCONTEXT::pi,
+    &RATPACKCONTEXT::pi_over_two,
+    &RATPACKCONTEXT::two_pi,
+    &RATPACKCONTEXT::one_pt_five_pi,
+    &RATPACKCONTEXT::e_to_one_half,
+    &RATPACKCONTEXT::rat_exp,
+    &RATPACKCONTEXT::rad_to_deg,
+    &RATPACKCONTEXT::rad_to_grad,
+    &RATPACKCONTEXT::rat_qword,
+    &RATPACKCONTEXT::rat_dword,
+    &RATPACKCONTEXT::rat_word,
+    &RATPACKCONTEXT::rat_byte,
+    &RATPACKCONTEXT::rat_360,
+    &RATPACKCONTEXT::rat_400,
+    &RATPACKCONTEXT::rat_180,
+    &RATPACKCONTEXT::rat_200,
+    &RATPACKCONTEXT::rat_nRadix,
+    &RATPACKCONTEXT::rat_smallest,
+    &RATPACKCONTEXT::rat_negsmallest,
+    &RATPACKCONTEXT::rat_max_exp,
+    &RATPACKCONTEXT::rat_min_exp,
+    &RATPACKCONTEXT::rat_max_fact,
+    &RATPACKCONTEXT::rat_min_fact,
+    &RATPACKCONTEXT::rat_max_i32,
+    &RATPACKCONTEXT::rat_min_i32,
+};
 
-static int cbitsofprecision = RATIO_FOR_DECIMAL * DECIMAL * CALC_DECIMAL_DIGITS_DEFAULT;
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: RATPACKCONTEXT
+//
+//  DESCRIPTION: A context with no constants yet, ChangeConstants fills
+//  them in.
+//
+//----------------------------------------------------------------------------
 
-#include "ratconst.h"
+RATPACKCONTEXT::RATPACKCONTEXT()
+    : radix(0)
+    , precision(0)
+    , ratio(0)
+    , cbitsofprecision(INITIAL_CBITSOFPRECISION)
+    , ftrueinfinite(false)
+    , decimalSeparator(L'.')
+    , fx_limbs(0)
+{
+    for (auto num : CONTEXT_NUMBERS)
+    {
+        this->*num = nullptr;
+    }
+    for (auto rat : CONTEXT_RATS)
+    {
+        this->*rat = nullptr;
+    }
+}
 
-#endif
+RATPACKCONTEXT::RATPACKCONTEXT(const RATPACKCONTEXT& src)
+    : RATPACKCONTEXT()
+{
+    *this = src;
+}
+
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: operator=
+//
+//  DESCRIPTION: Deep copies the settings and constants of src, the
+//  allocations already held are reused.
+//
+//----------------------------------------------------------------------------
+
+RATPACKCONTEXT& RATPACKCONTEXT::operator=(const RATPACKCONTEXT& src)
+{
+    if (this != &src)
+    {
+        radix = src.radix;
+        precision = src.precision;
+        ratio = src.ratio;
+        cbitsofprecision = src.cbitsofprecision;
+        ftrueinfinite = src.ftrueinfinite;
+        decimalSeparator = src.decimalSeparator;
+        fx_limbs = src.fx_limbs;
+        for (auto num : CONTEXT_NUMBERS)
+        {
+            if (src.*num == nullptr)
+            {
+                destroynum(this->*num);
+            }
+            else
+            {
+                DUPNUM(this->*num, src.*num);
+            }
+        }
+        for (auto rat : CONTEXT_RATS)
+        {
+            if (src.*rat == nullptr)
+            {
+                destroyrat(this->*rat);
+            }
+            else
+            {
+                DUPRAT(this->*rat, src.*rat);
+            }
+        }
+    }
+    return *this;
+}
+
+RATPACKCONTEXT::~RATPACKCONTEXT()
+{
+    for (auto num : CONTEXT_NUMBERS)
+    {
+        destroynum(this->*num);
+    }
+    for (auto rat : CONTEXT_RATS)
+    {
+        destroyrat(this->*rat);
+    }
+}
+
+// Constant sets kept per thread for the radix and precision pairs used
+// last, so switching back to a mode is a copy instead of recomputing pi and
+// the logs.
+static constexpr size_t CONSTANT_CACHE_SIZE = 8;
 
-bool g_ftrueinfinite = false; // Set to true if you don't want
-                              // chopping internally
-                              // precision used internally
-
-PNUMBER num_one = nullptr;
-PNUMBER num_two = nullptr;
-PNUMBER num_five = nullptr;
-PNUMBER num_six = nullptr;
-PNUMBER num_ten = nullptr;
-
-PRAT ln_ten = nullptr;
-PRAT ln_two = nullptr;
-PRAT rat_zero = nullptr;
-PRAT rat_one = nullptr;
-PRAT rat_neg_one = nullptr;
-PRAT rat_two = nullptr;
-PRAT rat_six = nullptr;
-PRAT rat_half = nullptr;
-PRAT rat_ten = nullptr;
-PRAT pt_eight_five = nullptr;
-PRAT pi = nullptr;
-PRAT pi_over_two = nullptr;
-PRAT two_pi = nullptr;
-PRAT one_pt_five_pi = nullptr;
-PRAT e_to_one_half = nullptr;
-PRAT rat_exp = nullptr;
-PRAT rad_to_deg = nullptr;
-PRAT rad_to_grad = nullptr;
-PRAT rat_qword = nullptr;
-PRAT rat_dword = nullptr; // unsigned max ui32
-PRAT rat_word = nullptr;
-PRAT rat_byte = nullptr;
-PRAT rat_360 = nullptr;
-PRAT rat_400 = nullptr;
-PRAT rat_180 = nullptr;
-PRAT rat_200 = nullptr;
-PRAT rat_nRadix = nullptr;
-PRAT rat_smallest = nullptr;
-PRAT rat_negsmallest = nullptr;
-PRAT rat_max_exp = nullptr;
-PRAT rat_min_exp = nullptr;
-PRAT rat_max_fact = nullptr;
-PRAT rat_min_fact = nullptr;
-PRAT rat_min_i32 = nullptr; // min signed i32
-PRAT rat_max_i32 = nullptr; // max signed i32
+typedef struct _constantset
+{
+    uint32_t radix;
+    int32_t precision;
+    RATPACKCONTEXT constants;
+} CONSTANTSET;
+
+static thread_local list<CONSTANTSET> t_constantsets; // most recently used first
+static thread_local CONSTANTCACHECOUNTERS t_constantcounters;
 
 //----------------------------------------------------------------------------
 //
@@ -125,32 +253,102 @@ PRAT rat_max_i32 = nullptr; // max signed i32
 //
 //  RETURN: None
 //
-//  SIDE EFFECTS: sets a mess of constants.
+//  SIDE EFFECTS: sets a mess of constants in this thread's context.
 //
+//  DESCRIPTION: The constant sets of the last CONSTANT_CACHE_SIZE radix and
+//  precision pairs are kept, a pair seen before is copied from its set
+//  instead of being rebuilt.
 //
 //----------------------------------------------------------------------------
 
 void ChangeConstants(uint32_t radix, int32_t precision)
+{
+    for (auto it = t_constantsets.begin(); it != t_constantsets.end(); ++it)
+    {
+        if (it->radix == radix && it->precision == precision)
+        {
+            t_constantcounters.hits++;
+            t_constantsets.splice(t_constantsets.begin(), t_constantsets, it);
+
+            // The separator and infinite precision flag are settings of the
+            // context, not constants.
+            wchar_t decimalSeparator = g_ratpack->decimalSeparator;
+            bool ftrueinfinite = g_ratpack->ftrueinfinite;
+            *g_ratpack = it->constants;
+            g_ratpack->decimalSeparator = decimalSeparator;
+            g_ratpack->ftrueinfinite = ftrueinfinite;
+            return;
+        }
+    }
+
+    t_constantcounters.misses++;
+    _buildconstants(radix, precision);
+
+    // The least recently used set is overwritten in place, its allocations
+    // are reused by the copy.
+    if (t_constantsets.size() >= CONSTANT_CACHE_SIZE)
+    {
+        t_constantsets.splice(t_constantsets.begin(), t_constantsets, prev(t_constantsets.end()));
+    }
+    else
+    {
+        t_constantsets.emplace_front();
+    }
+    CONSTANTSET& set = t_constantsets.front();
+    set.radix = radix;
+    set.precision = precision;
+    set.constants = *g_ratpack;
+}
+
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: _constantcachecounters
+//
+//  RETURN: This thread's ChangeConstants cache counters.
+//
+//----------------------------------------------------------------------------
+
+CONSTANTCACHECOUNTERS& _constantcachecounters()
+{
+    return t_constantcounters;
+}
+
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: _buildconstants
+//
+//  ARGUMENTS:  base changing to, and precision to use.
+//
+//  RETURN: None
+//
+//  SIDE EFFECTS: recalculates the constants of this thread's context that
+//  are not good enough for the radix and precision.
+//
+//----------------------------------------------------------------------------
+
+static void _buildconstants(uint32_t radix, int32_t precision)
 {
     // ratio is set to the number of digits in the current radix, you can get
     // in the internal BASEX radix, this is important for length calculations
     // in translating from radix to BASEX and back.
 
-    uint64_t limit = static_cast<uint64_t>(BASEX) / static_cast<uint64_t>(radix);
-    g_ratio = 0;
-    for (uint32_t digit = 1; digit < limit; digit *= radix)
+    TWO_MANTTYPE limit = ((TWO_MANTTYPE)1 << BASEXPWR) / radix;
+    g_ratpack->ratio = 0;
+    for (TWO_MANTTYPE digit = 1; digit < limit; digit *= radix)
     {
-        g_ratio++;
+        g_ratpack->ratio++;
     }
-    g_ratio += !g_ratio;
+    g_ratpack->ratio += !g_ratpack->ratio;
+    g_ratpack->radix = radix;
+    g_ratpack->precision = precision;
 
-    destroyrat(rat_nRadix);
-    rat_nRadix = i32torat(radix);
+    destroyrat(g_ratpack->rat_nRadix);
+    g_ratpack->rat_nRadix = i32torat(radix);
 
     // Check to see what we have to recalculate and what we don't
-    if (cbitsofprecision < (g_ratio * static_cast<int32_t>(radix) * precision))
+    if (g_ratpack->cbitsofprecision < (g_ratpack->ratio * static_cast<int32_t>(radix) * precision))
     {
-        g_ftrueinfinite = false;
+        g_ratpack->ftrueinfinite = false;
 
         INIT_AND_DUMP_RAW_NUM_IF_NULL(num_one, 1L);
         INIT_AND_DUMP_RAW_NUM_IF_NULL(num_two, 2L);
@@ -164,124 +362,129 @@ void ChangeConstants(uint32_t radix, int32_t precision)
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_neg_one, -1L);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_ten, 10L);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_word, 0xffff);
-        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_word, 0xff);
+        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_byte, 0xff);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_400, 400);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_360, 360);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_200, 200);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_180, 180);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_max_exp, 100000);
 
-        // 3248, is the max number for which calc is able to compute factorial, after that it is unable to compute due to overflow.
-        // Hence restricted factorial range as at most 3248.Beyond that calc will throw overflow error immediately.
-        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_max_fact, 3249);
+        // 11923 is the largest n with ln(n!) <= rat_max_exp, past it gamma would need the exp of more than exprat takes.
+        // Beyond it factorial throws overflow immediately.
+        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_max_fact, 11923);
 
-        // -1000, is the min number for which calc is able to compute factorial, after that it takes too long to compute.
-        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_min_fact, -1000);
+        // Below 0 x! is pi/(sin(pi x) (-x)!) which runs into the same limit at the same distance.
+        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_min_fact, -11923);
 
-        DUPRAT(rat_smallest, rat_nRadix);
-        ratpowi32(&rat_smallest, -precision, precision);
-        DUPRAT(rat_negsmallest, rat_smallest);
-        rat_negsmallest->pp->sign = -1;
+        DUPRAT(g_ratpack->rat_smallest, g_ratpack->rat_nRadix);
+        ratpowi32(&g_ratpack->rat_smallest, -precision, precision);
+        DUPRAT(g_ratpack->rat_negsmallest, g_ratpack->rat_smallest);
+        g_ratpack->rat_negsmallest->pp->sign = -1;
         DUMPRAWRAT(rat_smallest);
         DUMPRAWRAT(rat_negsmallest);
 
-        if (rat_half == nullptr)
+        if (g_ratpack->rat_half == nullptr)
         {
-            createrat(rat_half);
-            DUPNUM(rat_half->pp, num_one);
-            DUPNUM(rat_half->pq, num_two);
+            createrat(g_ratpack->rat_half);
+            DUPNUM(g_ratpack->rat_half->pp, g_ratpack->num_one);
+            DUPNUM(g_ratpack->rat_half->pq, g_ratpack->num_two);
             DUMPRAWRAT(rat_half);
         }
 
-        if (pt_eight_five == nullptr)
+        if (g_ratpack->pt_eight_five == nullptr)
         {
-            createrat(pt_eight_five);
-            pt_eight_five->pp = i32tonum(85L, BASEX);
-            pt_eight_five->pq = i32tonum(100L, BASEX);
+            createrat(g_ratpack->pt_eight_five);
+            g_ratpack->pt_eight_five->pp = i32tonum(85L, BASEX);
+            g_ratpack->pt_eight_five->pq = i32tonum(100L, BASEX);
             DUMPRAWRAT(pt_eight_five);
         }
 
-        DUPRAT(rat_qword, rat_two);
-        numpowi32(&(rat_qword->pp), 64, BASEX, precision);
-        subrat(&rat_qword, rat_one, precision);
+        DUPRAT(g_ratpack->rat_qword, g_ratpack->rat_two);
+        numpowi32(&(g_ratpack->rat_qword->pp), 64, BASEX, precision);
+        subrat(&g_ratpack->rat_qword, g_ratpack->rat_one, precision);
         DUMPRAWRAT(rat_qword);
 
-        DUPRAT(rat_dword, rat_two);
-        numpowi32(&(rat_dword->pp), 32, BASEX, precision);
-        subrat(&rat_dword, rat_one, precision);
+        DUPRAT(g_ratpack->rat_dword, g_ratpack->rat_two);
+        numpowi32(&(g_ratpack->rat_dword->pp), 32, BASEX, precision);
+        subrat(&g_ratpack->rat_dword, g_ratpack->rat_one, precision);
         DUMPRAWRAT(rat_dword);
 
-        DUPRAT(rat_max_i32, rat_two);
-        numpowi32(&(rat_max_i32->pp), 31, BASEX, precision);
-        DUPRAT(rat_min_i32, rat_max_i32);
-        subrat(&rat_max_i32, rat_one, precision); // rat_max_i32 = 2^31 -1
+        DUPRAT(g_ratpack->rat_max_i32, g_ratpack->rat_two);
+        numpowi32(&(g_ratpack->rat_max_i32->pp), 31, BASEX, precision);
+        DUPRAT(g_ratpack->rat_min_i32, g_ratpack->rat_max_i32);
+        subrat(&g_ratpack->rat_max_i32, g_ratpack->rat_one, precision); // rat_max_i32 = 2^31 -1
         DUMPRAWRAT(rat_max_i32);
 
-        rat_min_i32->pp->sign *= -1; // rat_min_i32 = -2^31
+        g_ratpack->rat_min_i32->pp->sign *= -1; // rat_min_i32 = -2^31
         DUMPRAWRAT(rat_min_i32);
 
-        DUPRAT(rat_min_exp, rat_max_exp);
-        rat_min_exp->pp->sign *= -1;
+        DUPRAT(g_ratpack->rat_min_exp, g_ratpack->rat_max_exp);
+        g_ratpack->rat_min_exp->pp->sign *= -1;
         DUMPRAWRAT(rat_min_exp);
 
-        cbitsofprecision = g_ratio * radix * precision;
+        g_ratpack->cbitsofprecision = g_ratpack->ratio * radix * precision;
 
         // Apparently when dividing 180 by pi, another (internal) digit of
         // precision is needed.
-        int32_t extraPrecision = precision + g_ratio;
-        DUPRAT(pi, rat_half);
-        asinrat(&pi, radix, extraPrecision);
-        mulrat(&pi, rat_six, extraPrecision);
+        int32_t extraPrecision = precision + g_ratpack->ratio;
+        destroyrat(g_ratpack->pi);
+        g_ratpack->pi = _bspirat(extraPrecision);
         DUMPRAWRAT(pi);
 
-        DUPRAT(two_pi, pi);
-        DUPRAT(pi_over_two, pi);
-        DUPRAT(one_pt_five_pi, pi);
-        addrat(&two_pi, pi, extraPrecision);
+        DUPRAT(g_ratpack->two_pi, g_ratpack->pi);
+        DUPRAT(g_ratpack->pi_over_two, g_ratpack->pi);
+        DUPRAT(g_ratpack->one_pt_five_pi, g_ratpack->pi);
+        addrat(&g_ratpack->two_pi, g_ratpack->pi, extraPrecision);
         DUMPRAWRAT(two_pi);
 
-        divrat(&pi_over_two, rat_two, extraPrecision);
+        divrat(&g_ratpack->pi_over_two, g_ratpack->rat_two, extraPrecision);
         DUMPRAWRAT(pi_over_two);
 
-        addrat(&one_pt_five_pi, pi_over_two, extraPrecision);
+        addrat(&g_ratpack->one_pt_five_pi, g_ratpack->pi_over_two, extraPrecision);
         DUMPRAWRAT(one_pt_five_pi);
 
-        DUPRAT(e_to_one_half, rat_half);
-        _exprat(&e_to_one_half, extraPrecision);
+        DUPRAT(g_ratpack->e_to_one_half, g_ratpack->rat_half);
+        _exprat(&g_ratpack->e_to_one_half, extraPrecision);
         DUMPRAWRAT(e_to_one_half);
 
-        DUPRAT(rat_exp, rat_one);
-        _exprat(&rat_exp, extraPrecision);
+        DUPRAT(g_ratpack->rat_exp, g_ratpack->rat_one);
+        _exprat(&g_ratpack->rat_exp, extraPrecision);
         DUMPRAWRAT(rat_exp);
 
-        // WARNING: remember lograt uses exponent constants calculated above...
+        // WARNING: remember lograt scales by ln_two, it has to come first
+        // and can't use lograt.
 
-        DUPRAT(ln_ten, rat_ten);
-        lograt(&ln_ten, extraPrecision);
-        DUMPRAWRAT(ln_ten);
-
-        DUPRAT(ln_two, rat_two);
-        lograt(&ln_two, extraPrecision);
+        DUPRAT(g_ratpack->ln_two, g_ratpack->rat_two);
+        _lograt(&g_ratpack->ln_two, extraPrecision);
         DUMPRAWRAT(ln_two);
 
-        destroyrat(rad_to_deg);
-        rad_to_deg = i32torat(180L);
-        divrat(&rad_to_deg, pi, extraPrecision);
+        DUPRAT(g_ratpack->ln_ten, g_ratpack->rat_ten);
+        lograt(&g_ratpack->ln_ten, extraPrecision);
+        DUMPRAWRAT(ln_ten);
+
+        destroyrat(g_ratpack->rad_to_deg);
+        g_ratpack->rad_to_deg = i32torat(180L);
+        divrat(&g_ratpack->rad_to_deg, g_ratpack->pi, extraPrecision);
         DUMPRAWRAT(rad_to_deg);
 
-        destroyrat(rad_to_grad);
-        rad_to_grad = i32torat(200L);
-        divrat(&rad_to_grad, pi, extraPrecision);
+        destroyrat(g_ratpack->rad_to_grad);
+        g_ratpack->rad_to_grad = i32torat(200L);
+        divrat(&g_ratpack->rad_to_grad, g_ratpack->pi, extraPrecision);
         DUMPRAWRAT(rad_to_grad);
     }
     else
     {
-        _readconstants();
+        // The ratconst.h constants are only good for the initial precision,
+        // constants computed for a higher one are kept.
+        if (g_ratpack->cbitsofprecision == INITIAL_CBITSOFPRECISION)
+        {
+            _readconstants();
+        }
 
-        DUPRAT(rat_smallest, rat_nRadix);
-        ratpowi32(&rat_smallest, -precision, precision);
-        DUPRAT(rat_negsmallest, rat_smallest);
-        rat_negsmallest->pp->sign = -1;
+        DUPRAT(g_ratpack->rat_smallest, g_ratpack->rat_nRadix);
+        ratpowi32(&g_ratpack->rat_smallest, -precision, precision);
+        DUPRAT(g_ratpack->rat_negsmallest, g_ratpack->rat_smallest);
+        g_ratpack->rat_negsmallest->pp->sign = -1;
     }
 }
 
@@ -300,14 +503,14 @@ void intrat(PRAT* px, uint32_t radix, int32_t precision)
 {
     // Only do the intrat operation if number is nonzero.
     // and only if the bottom part is not one.
-    if (!zernum((*px)->pp) && !equnum((*px)->pq, num_one))
+    if (!zernum((*px)->pp) && !equnum((*px)->pq, g_ratpack->num_one))
     {
         flatrat(*px, radix, precision);
 
         // Subtract the fractional part of the rational
         PRAT pret = nullptr;
         DUPRAT(pret, *px);
-        remrat(&pret, rat_one);
+        remrat(&pret, g_ratpack->rat_one);
 
         subrat(px, pret, precision);
         destroyrat(pret);
@@ -477,7 +680,7 @@ void scale(PRAT* px, PRAT scalefact, uint32_t radix, int32_t precision)
 
     // Logscale is a quick way to tell how much extra precision is needed for
     // scaling by scalefact.
-    int32_t logscale = g_ratio * ((pret->pp->cdigit + pret->pp->exp) - (pret->pq->cdigit + pret->pq->exp));
+    int32_t logscale = g_ratpack->ratio * ((pret->pp->cdigit + pret->pp->exp) - (pret->pq->cdigit + pret->pq->exp));
     if (logscale > 0)
     {
         precision += logscale;
@@ -511,18 +714,16 @@ void scale2pi(PRAT* px, uint32_t radix, int32_t precision)
 
     // Logscale is a quick way to tell how much extra precision is needed for
     // scaling by 2 pi.
-    int32_t logscale = g_ratio * ((pret->pp->cdigit + pret->pp->exp) - (pret->pq->cdigit + pret->pq->exp));
+    int32_t logscale = g_ratpack->ratio * ((pret->pp->cdigit + pret->pp->exp) - (pret->pq->cdigit + pret->pq->exp));
     if (logscale > 0)
     {
         precision += logscale;
-        DUPRAT(my_two_pi, rat_half);
-        asinrat(&my_two_pi, radix, precision);
-        mulrat(&my_two_pi, rat_six, precision);
-        mulrat(&my_two_pi, rat_two, precision);
+        my_two_pi = _bspirat(precision);
+        mulrat(&my_two_pi, g_ratpack->rat_two, precision);
     }
     else
     {
-        DUPRAT(my_two_pi, two_pi);
+        DUPRAT(my_two_pi, g_ratpack->two_pi);
         logscale = 0;
     }
 
@@ -679,15 +880,15 @@ void _readconstants(void)
 void trimit(PRAT* px, int32_t precision)
 
 {
-    if (!g_ftrueinfinite)
+    if (!g_ratpack->ftrueinfinite)
     {
         int32_t trim;
         PNUMBER pp = (*px)->pp;
         PNUMBER pq = (*px)->pq;
-        trim = g_ratio * (min((pp->cdigit + pp->exp), (pq->cdigit + pq->exp)) - 1) - precision;
-        if (trim > g_ratio)
+        trim = g_ratpack->ratio * (min((pp->cdigit + pp->exp), (pq->cdigit + pq->exp)) - 1) - precision;
+        if (trim > g_ratpack->ratio)
         {
-            trim /= g_ratio;
+            trim /= g_ratpack->ratio;
 
             if (trim <= pp->exp)
             {
@@ -24,10 +24,10 @@ void scalerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_t pr
         scale2pi(pa, radix, precision);
         break;
     case ANGLE_DEG:
-        scale(pa, rat_360, radix, precision);
+        scale(pa, g_ratpack->rat_360, radix, precision);
         break;
     case ANGLE_GRAD:
-        scale(pa, rat_400, radix, precision);
+        scale(pa, g_ratpack->rat_400, radix, precision);
         break;
     }
 }
@@ -68,27 +68,27 @@ void _sinrat(PRAT* px, int32_t precision)
 {
     CREATETAYLOR();
 
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
+    DUPNUM(pret, x);
+    DUPNUM(thisterm, x);
 
-    DUPNUM(n2, num_one);
-    xx->pp->sign *= -1;
+    DUPNUM(n2, g_ratpack->num_one);
+    xx->sign *= -1;
 
     do
     {
         NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+    } while (!SMALL_ENOUGH_NUM(thisterm, precision));
 
     DESTROYTAYLOR();
 
     // Since *px might be epsilon above 1 or below -1, due to TRIMIT we need
     // this trick here.
-    inbetween(px, rat_one, precision);
+    inbetween(px, g_ratpack->rat_one, precision);
 
     // Since *px might be epsilon near zero we must set it to zero.
-    if (rat_le(*px, rat_smallest, precision) && rat_ge(*px, rat_negsmallest, precision))
+    if (rat_le(*px, g_ratpack->rat_smallest, precision) && rat_ge(*px, g_ratpack->rat_negsmallest, precision))
     {
-        DUPRAT(*px, rat_zero);
+        DUPRAT(*px, g_ratpack->rat_zero);
     }
 }
 
@@ -105,20 +105,20 @@ void sinanglerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_t
     switch (angletype)
     {
     case ANGLE_DEG:
-        if (rat_gt(*pa, rat_180, precision))
+        if (rat_gt(*pa, g_ratpack->rat_180, precision))
         {
-            subrat(pa, rat_360, precision);
+            subrat(pa, g_ratpack->rat_360, precision);
         }
-        divrat(pa, rat_180, precision);
-        mulrat(pa, pi, precision);
+        divrat(pa, g_ratpack->rat_180, precision);
+        mulrat(pa, g_ratpack->pi, precision);
         break;
     case ANGLE_GRAD:
-        if (rat_gt(*pa, rat_200, precision))
+        if (rat_gt(*pa, g_ratpack->rat_200, precision))
         {
-            subrat(pa, rat_400, precision);
+            subrat(pa, g_ratpack->rat_400, precision);
         }
-        divrat(pa, rat_200, precision);
-        mulrat(pa, pi, precision);
+        divrat(pa, g_ratpack->rat_200, precision);
+        mulrat(pa, g_ratpack->pi, precision);
         break;
     }
     _sinrat(pa, precision);
@@ -160,30 +160,25 @@ void _cosrat(PRAT* px, uint32_t radix, int32_t precision)
 {
     CREATETAYLOR();
 
-    destroynum(pret->pp);
-    destroynum(pret->pq);
-
-    pret->pp = i32tonum(1L, radix);
-    pret->pq = i32tonum(1L, radix);
-
-    DUPRAT(thisterm, pret)
+    DUPNUM(pret, g_ratpack->num_one);
+    DUPNUM(thisterm, pret);
 
     n2 = i32tonum(0L, radix);
-    xx->pp->sign *= -1;
+    xx->sign *= -1;
 
     do
     {
         NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+    } while (!SMALL_ENOUGH_NUM(thisterm, precision));
 
     DESTROYTAYLOR();
     // Since *px might be epsilon above 1 or below -1, due to TRIMIT we need
     // this trick here.
-    inbetween(px, rat_one, precision);
+    inbetween(px, g_ratpack->rat_one, precision);
     // Since *px might be epsilon near zero we must set it to zero.
-    if (rat_le(*px, rat_smallest, precision) && rat_ge(*px, rat_negsmallest, precision))
+    if (rat_le(*px, g_ratpack->rat_smallest, precision) && rat_ge(*px, g_ratpack->rat_negsmallest, precision))
     {
-        DUPRAT(*px, rat_zero);
+        DUPRAT(*px, g_ratpack->rat_zero);
     }
 }
 
@@ -200,28 +195,28 @@ void cosanglerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_t
     switch (angletype)
     {
     case ANGLE_DEG:
-        if (rat_gt(*pa, rat_180, precision))
+        if (rat_gt(*pa, g_ratpack->rat_180, precision))
         {
             PRAT ptmp = nullptr;
-            DUPRAT(ptmp, rat_360);
+            DUPRAT(ptmp, g_ratpack->rat_360);
             subrat(&ptmp, *pa, precision);
             destroyrat(*pa);
             *pa = ptmp;
         }
-        divrat(pa, rat_180, precision);
-        mulrat(pa, pi, precision);
+        divrat(pa, g_ratpack->rat_180, precision);
+        mulrat(pa, g_ratpack->pi, precision);
         break;
     case ANGLE_GRAD:
-        if (rat_gt(*pa, rat_200, precision))
+        if (rat_gt(*pa, g_ratpack->rat_200, precision))
         {
             PRAT ptmp = nullptr;
-            DUPRAT(ptmp, rat_400);
+            DUPRAT(ptmp, g_ratpack->rat_400);
             subrat(&ptmp, *pa, precision);
             destroyrat(*pa);
             *pa = ptmp;
         }
-        divrat(pa, rat_200, precision);
-        mulrat(pa, pi, precision);
+        divrat(pa, g_ratpack->rat_200, precision);
+        mulrat(pa, g_ratpack->pi, precision);
         break;
     }
     _cosrat(pa, radix, precision);
@@ -270,20 +265,20 @@ void tananglerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_t
     switch (angletype)
     {
     case ANGLE_DEG:
-        if (rat_gt(*pa, rat_180, precision))
+        if (rat_gt(*pa, g_ratpack->rat_180, precision))
         {
-            subrat(pa, rat_180, precision);
+            subrat(pa, g_ratpack->rat_180, precision);
         }
-        divrat(pa, rat_180, precision);
-        mulrat(pa, pi, precision);
+        divrat(pa, g_ratpack->rat_180, precision);
+        mulrat(pa, g_ratpack->pi, precision);
         break;
     case ANGLE_GRAD:
-        if (rat_gt(*pa, rat_200, precision))
+        if (rat_gt(*pa, g_ratpack->rat_200, precision))
         {
-            subrat(pa, rat_200, precision);
+            subrat(pa, g_ratpack->rat_200, precision);
         }
-        divrat(pa, rat_200, precision);
-        mulrat(pa, pi, precision);
+        divrat(pa, g_ratpack->rat_200, precision);
+        mulrat(pa, g_ratpack->pi, precision);
         break;
     }
     _tanrat(pa, radix, precision);
@@ -21,8 +21,8 @@ bool IsValidForHypFunc(PRAT px, int32_t precision)
     PRAT ptmp = nullptr;
     bool bRet = true;
 
-    DUPRAT(ptmp, rat_min_exp);
-    divrat(&ptmp, rat_ten, precision);
+    DUPRAT(ptmp, g_ratpack->rat_min_exp);
+    divrat(&ptmp, g_ratpack->rat_ten, precision);
     if (rat_lt(px, ptmp, precision))
     {
         bRet = false;
@@ -75,15 +75,15 @@ void _sinhrat(PRAT* px, int32_t precision)
 
     CREATETAYLOR();
 
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, pret);
+    DUPNUM(pret, x);
+    DUPNUM(thisterm, pret);
 
-    DUPNUM(n2, num_one);
+    DUPNUM(n2, g_ratpack->num_one);
 
     do
     {
         NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+    } while (!SMALL_ENOUGH_NUM(thisterm, precision));
 
     DESTROYTAYLOR();
 }
@@ -93,14 +93,14 @@ void sinhrat(PRAT* px, uint32_t radix, int32_t precision)
 {
     PRAT tmpx = nullptr;
 
-    if (rat_ge(*px, rat_one, precision))
+    if (rat_ge(*px, g_ratpack->rat_one, precision))
     {
         DUPRAT(tmpx, *px);
         exprat(px, radix, precision);
         tmpx->pp->sign *= -1;
         exprat(&tmpx, radix, precision);
         subrat(px, tmpx, precision);
-        divrat(px, rat_two, precision);
+        divrat(px, g_ratpack->rat_two, precision);
         destroyrat(tmpx);
     }
     else
@@ -154,17 +154,15 @@ void _coshrat(PRAT* px, uint32_t radix, int32_t precision)
 
     CREATETAYLOR();
 
-    pret->pp = i32tonum(1L, radix);
-    pret->pq = i32tonum(1L, radix);
-
-    DUPRAT(thisterm, pret)
+    DUPNUM(pret, g_ratpack->num_one);
+    DUPNUM(thisterm, pret);
 
     n2 = i32tonum(0L, radix);
 
     do
     {
         NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+    } while (!SMALL_ENOUGH_NUM(thisterm, precision));
 
     DESTROYTAYLOR();
 }
@@ -176,14 +174,14 @@ void coshrat(PRAT* px, uint32_t radix, int32_t precision)
 
     (*px)->pp->sign = 1;
     (*px)->pq->sign = 1;
-    if (rat_ge(*px, rat_one, precision))
+    if (rat_ge(*px, g_ratpack->rat_one, precision))
     {
         DUPRAT(tmpx, *px);
         exprat(px, radix, precision);
         tmpx->pp->sign *= -1;
         exprat(&tmpx, radix, precision);
         addrat(px, tmpx, precision);
-        divrat(px, rat_two, precision);
+        divrat(px, g_ratpack->rat_two, precision);
         destroyrat(tmpx);
     }
     else
@@ -192,9 +190,9 @@ void coshrat(PRAT* px, uint32_t radix, int32_t precision)
     }
     // Since *px might be epsilon below 1 due to TRIMIT
     // we need this trick here.
-    if (rat_lt(*px, rat_one, precision))
+    if (rat_lt(*px, g_ratpack->rat_one, precision))
     {
-        DUPRAT(*px, rat_one);
+        DUPRAT(*px, g_ratpack->rat_one);
     }
 }
 
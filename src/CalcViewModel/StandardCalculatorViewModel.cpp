@@ -1662,7 +1662,8 @@ void StandardCalculatorViewModel::UpdateProgrammerPanelDisplay()
     {
         // we want the precision to be set to maximum value so that the autoconversions result as desired
         int32_t precision = 64;
-        if (m_standardCalculatorManager.GetResultForRadix(16, precision) == L"")
+        auto results = m_standardCalculatorManager.GetResultForAllRadixes(precision);
+        if (results[HEX_RADIX] == L"")
         {
             hexDisplayString = DisplayValue->Data();
             decimalDisplayString = DisplayValue->Data();
@@ -1671,10 +1672,10 @@ void StandardCalculatorViewModel::UpdateProgrammerPanelDisplay()
         }
         else
         {
-            hexDisplayString = m_standardCalculatorManager.GetResultForRadix(16, precision);
-            decimalDisplayString = m_standardCalculatorManager.GetResultForRadix(10, precision);
-            octalDisplayString = m_standardCalculatorManager.GetResultForRadix(8, precision);
-            binaryDisplayString = m_standardCalculatorManager.GetResultForRadix(2, precision);
+            hexDisplayString = results[HEX_RADIX];
+            decimalDisplayString = results[DEC_RADIX];
+            octalDisplayString = results[OCT_RADIX];
+            binaryDisplayString = results[BIN_RADIX];
         }
     }
     const auto& localizer = LocalizationSettings::GetInstance();
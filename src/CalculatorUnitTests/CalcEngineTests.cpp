@@ -229,6 +229,30 @@ namespace CalculatorEngineTests
                 L"Verify expanded form multigroup non-repeating grouping.");
         }
 
+        TEST_METHOD(TestDisplayCache)
+        {
+            // Showing the same value again is a lookup, for the number and for its grouping.
+            m_calcEngine->DisplayNum();
+            uint64_t lookups = m_calcEngine->DisplayCacheLookups();
+            uint64_t hits = m_calcEngine->DisplayCacheHits();
+            m_calcEngine->DisplayNum();
+            VERIFY_ARE_EQUAL(lookups + 2, m_calcEngine->DisplayCacheLookups());
+            VERIFY_ARE_EQUAL(hits + 2, m_calcEngine->DisplayCacheHits());
+            VERIFY_ARE_EQUAL(L"0", m_calcEngine->m_numberString);
+
+            // A new value is formatted and grouped again.
+            m_calcEngine->m_currentVal = CalcEngine::Rational(1234567);
+            m_calcEngine->DisplayNum();
+            VERIFY_ARE_EQUAL(hits + 2, m_calcEngine->DisplayCacheHits());
+            VERIFY_ARE_EQUAL(L"1234567", m_calcEngine->m_numberString);
+            VERIFY_ARE_EQUAL(L"1,234,567", m_calcEngine->GroupDigitsPerRadix(L"1234567", 10));
+            VERIFY_ARE_EQUAL(hits + 3, m_calcEngine->DisplayCacheHits());
+
+            // So is the same value in another radix.
+            m_calcEngine->ProcessCommand(IDM_HEX);
+            VERIFY_ARE_EQUAL(L"12D687", m_calcEngine->m_numberString);
+        }
+
     private:
         unique_ptr<CCalcEngine> m_calcEngine;
         shared_ptr<IResourceProvider> m_resourceProvider;
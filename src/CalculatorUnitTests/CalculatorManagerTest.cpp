@@ -178,6 +178,7 @@ namespace CalculatorManagerTest
         TEST_METHOD(CalculatorManagerTestScientificModeChange);
 
         TEST_METHOD(CalculatorManagerTestModeChange);
+        TEST_METHOD(CalculatorManagerTestHeadless);
 
         TEST_METHOD(CalculatorManagerTestMemory);
 
@@ -644,6 +645,42 @@ namespace CalculatorManagerTest
         TestDriver::Test(L"0", L"", commands8, true, false);
     }
 
+    void CalculatorManagerTest::CalculatorManagerTestHeadless()
+    {
+        CalculatorManagerDisplayTester* pCalculatorDisplay = (CalculatorManagerDisplayTester*)m_calculatorDisplayTester.get();
+
+        m_calculatorManager->SetStandardMode();
+        size_t historyCount = m_calculatorManager->GetHistoryItems().size();
+        m_calculatorManager->SetHeadlessMode(true);
+        VERIFY_IS_TRUE(m_calculatorManager->IsHeadlessMode());
+
+        Command commands1[] = { Command::Command1, Command::Command2, Command::CommandADD, Command::Command3, Command::CommandEQU, Command::CommandNULL };
+        ExecuteCommands(commands1);
+        VERIFY_ARE_EQUAL(wstring(L"0"), pCalculatorDisplay->GetPrimaryDisplay());
+        VERIFY_ARE_EQUAL(wstring(L"15"), m_calculatorManager->GetResultForRadix(10, 32));
+
+        // The line is added to the history once the history is read
+        auto historyItems = m_calculatorManager->GetHistoryItems();
+        VERIFY_ARE_EQUAL(historyCount + 1, historyItems.size());
+        VERIFY_ARE_EQUAL(wstring(L"15"), historyItems.back()->historyItemVector.result);
+
+        Command commands2[] = { Command::Command1, Command::CommandDIV, Command::Command0, Command::CommandEQU, Command::CommandNULL };
+        ExecuteCommands(commands2);
+        VERIFY_IS_TRUE(m_calculatorManager->IsEngineInError());
+        VERIFY_IS_TRUE(pCalculatorDisplay->GetIsError());
+
+        m_calculatorManager->SendCommand(Command::CommandCLEAR);
+        Command commands3[] = { Command::Command7, Command::CommandMUL, Command::Command6, Command::CommandNULL };
+        ExecuteCommands(commands3);
+        m_calculatorManager->SetHeadlessMode(false);
+        VERIFY_IS_FALSE(m_calculatorManager->IsHeadlessMode());
+        VERIFY_ARE_EQUAL(wstring(L"6"), pCalculatorDisplay->GetPrimaryDisplay());
+
+        m_calculatorManager->SendCommand(Command::CommandEQU);
+        VERIFY_ARE_EQUAL(wstring(L"42"), pCalculatorDisplay->GetPrimaryDisplay());
+        VERIFY_ARE_EQUAL(historyCount + 2, m_calculatorManager->GetHistoryItems().size());
+    }
+
     void CalculatorManagerTest::CalculatorManagerTestMemory()
     {
         Command scientificCalculatorTest52[] = { Command::Command1, Command::CommandSTORE, Command::CommandNULL };
@@ -1,10 +1,12 @@
-// Copyright (c) Microsoft Corporation. All rights reserved.
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
 #include "pch.h"
 #include <CppUnitTest.h>
+#include <thread>
 #include "Header Files/Rational.h"
 #include "Header Files/RationalMath.h"
+#include "Header Files/IntegerMath.h"
 
 using namespace CalcEngine;
 using namespace CalcEngine::RationalMath;
@@ -216,6 +218,710 @@ TEST_METHOD(TestRemainderRational)
     res = Rational(-834345) % Rational(Number(1, 0, { 103 }), Number(1, 0, { 100 }));
     VERIFY_ARE_EQUAL(res.ToString(10, FMT_FLOAT, 8), L"-0.71");
 }
+
+TEST_METHOD(TestGcd)
+{
+    // Single digit numbers, finished by the binary gcd
+    PNUMBER a = i32tonum(1071, BASEX);
+    PNUMBER b = i32tonum(462, BASEX);
+    PNUMBER g = gcd(a, b);
+    VERIFY_ARE_EQUAL(numtoi32(g, BASEX), 21);
+    destroynum(g);
+
+    // A zero operand gives back a copy of the other one
+    PNUMBER zero = i32tonum(0, BASEX);
+    g = gcd(zero, b);
+    VERIFY_ARE_EQUAL(numtoi32(g, BASEX), 462);
+    VERIFY_IS_TRUE(g != b);
+    destroynum(g);
+    destroynum(zero);
+
+    // Multi digit numbers go through the Lehmer steps,
+    // gcd(1071 * 3^200, 462 * 3^150) = 21 * 3^150
+    PNUMBER pow200 = i32tonum(3, BASEX);
+    numpowi32x(&pow200, 200);
+    PNUMBER pow150 = i32tonum(3, BASEX);
+    numpowi32x(&pow150, 150);
+    mulnumx(&a, pow200);
+    mulnumx(&b, pow150);
+    PNUMBER expected = i32tonum(21, BASEX);
+    mulnumx(&expected, pow150);
+    g = gcd(a, b);
+    VERIFY_IS_TRUE(equnum(g, expected));
+    destroynum(g);
+
+    destroynum(expected);
+    destroynum(pow150);
+    destroynum(pow200);
+    destroynum(b);
+    destroynum(a);
+}
+
+TEST_METHOD(TestFullDigitCarry)
+{
+    // The largest BASEX digit, whatever the limb configuration.
+    Rational top(Number(1, 0, { BASEXMAX }), Number(1, 0, { 1 }));
+    Rational carried(Number(1, 0, { 0, 1 }), Number(1, 0, { 1 }));
+
+    VERIFY_ARE_EQUAL(top + 1, carried);
+    VERIFY_ARE_EQUAL(carried - 1, top);
+    VERIFY_IS_TRUE(top > 1);
+    VERIFY_IS_TRUE(1 < top);
+
+    // The remainder compares top digits that differ by more than half a digit.
+    Rational big(Number(1, 0, { 5, BASEXMAX }), Number(1, 0, { 1 }));
+    VERIFY_ARE_EQUAL(big % carried, 5);
+}
+
+TEST_METHOD(TestLongRadixConversion)
+{
+    // Long enough to take the divide and conquer path both ways.
+    Rational decimal = 1;
+    Rational hex = 1;
+    for (int i = 0; i < 1000; i++)
+    {
+        decimal = decimal * 10;
+        hex = hex * 16;
+    }
+    decimal = decimal + 1;
+    hex = hex - 1;
+
+    VERIFY_ARE_EQUAL(decimal.ToString(10, FMT_FLOAT, 1100), L"1" + std::wstring(999, L'0') + L"1");
+    VERIFY_ARE_EQUAL(hex.ToString(16, FMT_FLOAT, 1100), std::wstring(1000, L'F'));
+}
+
+TEST_METHOD(TestPoolAllocator)
+{
+    Rational expected = Exp(Rational(3) / Rational(2));
+
+    // The temporaries of a second run come from the free lists.
+    POOLCOUNTERS before = _poolcounters();
+    Rational pooled = Exp(Rational(3) / Rational(2));
+    POOLCOUNTERS after = _poolcounters();
+    VERIFY_ARE_EQUAL(pooled, expected);
+    VERIFY_IS_TRUE(after.reused > before.reused);
+    VERIFY_IS_TRUE(after.heap - before.heap < after.requests - before.requests);
+
+    // Inside an arena they are carved from its chunks, nested arenas and
+    // results that outlive them are fine.
+    Rational carved;
+    before = _poolcounters();
+    {
+        RATPACKARENA outer;
+        {
+            RATPACKARENA inner;
+            carved = Exp(Rational(3) / Rational(2));
+        }
+        carved = carved + Exp(Rational(3) / Rational(2));
+    }
+    after = _poolcounters();
+    VERIFY_ARE_EQUAL(carved, expected + expected);
+    VERIFY_IS_TRUE(after.carved > before.carved);
+}
+
+TEST_METHOD(TestRatpackContext)
+{
+    RATPACKCONTEXT* outside = g_ratpack;
+    RATPACKCONTEXT low(*g_ratpack);
+    RATPACKCONTEXT high(*g_ratpack);
+    std::wstring expectedLow;
+    std::wstring expectedHigh;
+    {
+        RATPACKCONTEXTSCOPE scope(low);
+        ChangeConstants(10, 20);
+        expectedLow = Exp(Rational(1)).ToString(10, FMT_FLOAT, 20);
+    }
+    {
+        RATPACKCONTEXTSCOPE scope(high);
+        ChangeConstants(16, 60);
+        expectedHigh = Log(Rational(3)).ToString(16, FMT_FLOAT, 60);
+    }
+    VERIFY_IS_TRUE(g_ratpack == outside);
+    VERIFY_ARE_EQUAL(g_ratpack->precision, 128);
+
+    // Threads working in different contexts do not see each other's
+    // precision or radix.
+    std::wstring resultLow;
+    std::wstring resultHigh;
+    std::thread threadLow([&] {
+        RATPACKCONTEXTSCOPE scope(low);
+        for (int i = 0; i < 10; i++)
+        {
+            resultLow = Exp(Rational(1)).ToString(10, FMT_FLOAT, 20);
+        }
+    });
+    std::thread threadHigh([&] {
+        RATPACKCONTEXTSCOPE scope(high);
+        for (int i = 0; i < 10; i++)
+        {
+            resultHigh = Log(Rational(3)).ToString(16, FMT_FLOAT, 60);
+        }
+    });
+    threadLow.join();
+    threadHigh.join();
+    VERIFY_ARE_EQUAL(resultLow, expectedLow);
+    VERIFY_ARE_EQUAL(resultHigh, expectedHigh);
+    VERIFY_ARE_EQUAL(g_ratpack->precision, 128);
+}
+
+TEST_METHOD(TestConstantCache)
+{
+    ChangeConstants(10, 128);
+    std::wstring expected = Log(Rational(3)).ToString(10, FMT_FLOAT, 100);
+
+    // Going back to a radix and precision used before copies the constant
+    // set built for it, even after a detour through a lower precision.
+    ChangeConstants(16, 64);
+    ChangeConstants(10, 32);
+    CONSTANTCACHECOUNTERS before = _constantcachecounters();
+    ChangeConstants(16, 64);
+    ChangeConstants(10, 128);
+    CONSTANTCACHECOUNTERS after = _constantcachecounters();
+    VERIFY_IS_TRUE(after.hits - before.hits == 2);
+    VERIFY_IS_TRUE(after.misses == before.misses);
+    VERIFY_ARE_EQUAL(g_ratpack->radix, 10u);
+    VERIFY_ARE_EQUAL(g_ratpack->precision, 128);
+    VERIFY_ARE_EQUAL(Log(Rational(3)).ToString(10, FMT_FLOAT, 100), expected);
+}
+
+TEST_METHOD(TestBinarySplittingSeries)
+{
+    // Above _bsfaster's thresholds exp, log, atan and pi come from the
+    // binary splitting series.
+    ChangeConstants(10, 1000);
+    VERIFY_IS_TRUE(_bsfaster(SERIES_EXP, 1000));
+    VERIFY_IS_TRUE(_bsfaster(SERIES_LOG, 1000));
+    VERIFY_IS_TRUE(_bsfaster(SERIES_ATAN, 1000));
+
+    std::wstring e = L"2.718281828459045235360287471352662497757247093699959574966967627724076630353547594571382178525166427";
+    std::wstring ln2 = L"0.6931471805599453094172321214581765680755001343602552541206800094933936219696947156058633269964186875";
+    std::wstring pi = L"3.141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117068";
+    VERIFY_ARE_EQUAL(Exp(Rational(1)).ToString(10, FMT_FLOAT, 100), e);
+    VERIFY_ARE_EQUAL(Log(Rational(2)).ToString(10, FMT_FLOAT, 100), ln2);
+    VERIFY_ARE_EQUAL(Rational(g_ratpack->pi).ToString(10, FMT_FLOAT, 100), pi);
+    VERIFY_ARE_EQUAL((ATan(Rational(1), ANGLE_RAD) * 4).ToString(10, FMT_FLOAT, 100), pi);
+    VERIFY_ARE_EQUAL(Exp(Log(Rational(7))).ToString(10, FMT_FLOAT, 100), L"7");
+    VERIFY_ARE_EQUAL(Tan(ATan(Rational(Number(-1, 0, { 3 }), Number(1, 0, { 4 })), ANGLE_RAD), ANGLE_RAD).ToString(10, FMT_FLOAT, 100), L"-0.75");
+
+    ChangeConstants(10, 128);
+}
+
+TEST_METHOD(TestFixedPointSeries)
+{
+    // Below _bsfaster's thresholds the taylor series are summed in fixed
+    // point, they must still be good to the last digit shown.
+    ChangeConstants(10, 128);
+    VERIFY_IS_FALSE(_bsfaster(SERIES_EXP, 128));
+    VERIFY_IS_FALSE(_bsfaster(SERIES_LOG, 128));
+    VERIFY_IS_FALSE(_bsfaster(SERIES_ATAN, 128));
+
+    Rational third(Number(1, 0, { 1 }), Number(1, 0, { 3 }));
+    VERIFY_ARE_EQUAL(
+        Sin(Rational(1), ANGLE_RAD).ToString(10, FMT_FLOAT, 100),
+        L"0.8414709848078965066525023216302989996225630607983710656727517099919104043912396689486397435430526959");
+    VERIFY_ARE_EQUAL(
+        Cos(Rational(1), ANGLE_RAD).ToString(10, FMT_FLOAT, 100),
+        L"0.5403023058681397174009366074429766037323104206179222276700972553811003947744717645179518560871830893");
+    VERIFY_ARE_EQUAL(
+        Exp(third).ToString(10, FMT_FLOAT, 100),
+        L"1.395612425086089528628125319602586837597906515199406982617516706031739015645951846969788817295830224");
+    VERIFY_ARE_EQUAL(
+        ASin(third, ANGLE_RAD).ToString(10, FMT_FLOAT, 100),
+        L"0.3398369094541219370963925133917640663882446903324580714319239624899158886648484114607657925001976129");
+    VERIFY_ARE_EQUAL(
+        Sinh(Rational(Number(-1, 0, { 1 }), Number(1, 0, { 2 }))).ToString(10, FMT_FLOAT, 100),
+        L"-0.5210953054937473616224256264114915591059289826114805279460935764528022508902335923170644542741885935");
+
+    // exp squares the series of x/2^k back up and log scales by powers of two
+    // and sums atanh, neither may cost digits.
+    VERIFY_ARE_EQUAL(
+        Exp(Rational(73) / 100).ToString(10, FMT_FLOAT, 100),
+        L"2.075080607674122644986375834989246758691584725229698613059643188654114677935800983333936172371409641");
+    VERIFY_ARE_EQUAL(
+        Log(Rational(123456789) / 10000).ToString(10, FMT_FLOAT, 100),
+        L"9.421061394191835297121967529225747379309275886505310071051778341221927028546941856712127599831909502");
+    VERIFY_ARE_EQUAL(
+        Log(Rational(1) / 7).ToString(10, FMT_FLOAT, 100),
+        L"-1.945910149055313305105352743443179729637084729581861188459390149937579862752069267787658498587871527");
+}
+
+TEST_METHOD(TestFixedPointSeriesSmallArguments)
+{
+    // A small argument's series are summed to its own precision, not to
+    // precision digits past the point.
+    ChangeConstants(10, 128);
+    Rational tiny = Rational(1) / Pow(10, 200);
+    VERIFY_ARE_EQUAL(ASin(tiny, ANGLE_RAD).ToString(10, FMT_FLOAT, 100), L"1.e-200");
+    VERIFY_ARE_EQUAL(ATan(tiny, ANGLE_RAD).ToString(10, FMT_FLOAT, 100), L"1.e-200");
+    VERIFY_ARE_EQUAL(Sinh(tiny).ToString(10, FMT_FLOAT, 100), L"1.e-200");
+    VERIFY_ARE_EQUAL(Tanh(tiny).ToString(10, FMT_FLOAT, 100), L"1.e-200");
+    VERIFY_ARE_EQUAL(ASinh(tiny).ToString(10, FMT_FLOAT, 100), L"1.e-200");
+
+    // RationalMath stays at 128 digits, a short precision is ratpak's.
+    ChangeConstants(10, 32);
+    PRAT x = (Rational(1) / Pow(10, 30)).ToPRAT();
+    sinanglerat(&x, ANGLE_RAD, 10, 32);
+    VERIFY_ARE_EQUAL(Rational(x).ToString(10, FMT_FLOAT, 32), L"0.000000000000000000000000000001");
+    destroyrat(x);
+
+    x = (Rational(1) / Pow(10, 30)).ToPRAT();
+    asinrat(&x, 10, 32);
+    VERIFY_ARE_EQUAL(Rational(x).ToString(10, FMT_FLOAT, 32), L"0.000000000000000000000000000001");
+    destroyrat(x);
+
+    ChangeConstants(10, 128);
+}
+
+TEST_METHOD(TestLogNearOne)
+{
+    // Near one log takes no power of two out, the atanh series gets a tiny
+    // z and must keep all of its digits.
+    ChangeConstants(10, 32);
+    Rational eps = Rational(1) / Pow(10, 25);
+    PRAT x = (Rational(1) - eps).ToPRAT();
+    lograt(&x, 32);
+    VERIFY_ARE_EQUAL(Rational(x).ToString(10, FMT_FLOAT, 32), L"-1.00000000000000000000000005e-25");
+    destroyrat(x);
+
+    x = (Rational(1) - eps).ToPRAT();
+    log10rat(&x, 32);
+    VERIFY_ARE_EQUAL(Rational(x).ToString(10, FMT_FLOAT, 32), L"-4.3429448190325182765112894063133e-26");
+    destroyrat(x);
+
+    x = (Rational(1) + eps).ToPRAT();
+    lograt(&x, 32);
+    VERIFY_ARE_EQUAL(Rational(x).ToString(10, FMT_FLOAT, 32), L"9.9999999999999999999999995e-26");
+    destroyrat(x);
+
+    ChangeConstants(10, 128);
+}
+
+TEST_METHOD(TestSmallRationalFastPath)
+{
+    // Values that fit in 64 bits are worked on directly, anything bigger
+    // goes through ratpack and comes back once it fits again.
+    Rational third = Rational(1) / Rational(3);
+    VERIFY_ARE_EQUAL(third + Rational(1) / Rational(6), Rational(1) / Rational(2));
+    VERIFY_IS_TRUE(third < Rational(1) / Rational(2));
+    VERIFY_IS_TRUE(-third < Rational(0));
+    VERIFY_ARE_EQUAL(third.P().Mantissa().front(), 1u);
+    VERIFY_ARE_EQUAL(third.Q().Mantissa().front(), 3u);
+    VERIFY_ARE_EQUAL(Rational(-7) % Rational(3), -1);
+    VERIFY_ARE_EQUAL(Rational(7) % Rational(-3), 1);
+    VERIFY_ARE_EQUAL(Rational((int32_t)INT32_MIN).ToString(10, FMT_FLOAT, 128), L"-2147483648");
+
+    Rational max = Rational((uint64_t)INT64_MAX);
+    Rational square = max * max;
+    VERIFY_ARE_EQUAL(square.ToString(10, FMT_FLOAT, 128), L"85070591730234615847396907784232501249");
+    VERIFY_ARE_EQUAL((max + max).ToString(10, FMT_FLOAT, 128), L"18446744073709551614");
+    VERIFY_ARE_EQUAL(square / max, max);
+    VERIFY_IS_TRUE(max < square);
+    VERIFY_ARE_EQUAL(Rational((uint64_t)UINT64_MAX).ToUInt64_t(), UINT64_MAX);
+
+    try
+    {
+        third /= Rational(0);
+        Assert::Fail();
+    }
+    catch (uint32_t t)
+    {
+        if (t != CALC_E_DIVIDEBYZERO)
+        {
+            Assert::Fail();
+        }
+    }
+    catch (...)
+    {
+        Assert::Fail();
+    }
+}
+
+TEST_METHOD(TestRationalInPlaceArithmetic)
+{
+    Rational big = Pow(Rational(2), Rational(100)) / Rational(3);
+    Rational other = Pow(Rational(3), Rational(70)) / Rational(7);
+    std::wstring expected = big.ToString(10, FMT_FLOAT, 128);
+
+    // Moves hand the ratpack blocks over without allocating.
+    POOLCOUNTERS before = _poolcounters();
+    Rational moved = std::move(big);
+    big = std::move(moved);
+    POOLCOUNTERS after = _poolcounters();
+    VERIFY_ARE_EQUAL(after.requests, before.requests);
+    VERIFY_ARE_EQUAL(big.ToString(10, FMT_FLOAT, 128), expected);
+
+    // Copying into a value of the same size reuses its blocks.
+    moved = other;
+    before = _poolcounters();
+    moved = big;
+    after = _poolcounters();
+    VERIFY_ARE_EQUAL(after.dupkept - before.dupkept, 2u);
+    VERIFY_ARE_EQUAL(moved, big);
+
+    Rational sum = big;
+    sum += other;
+    sum -= other;
+    VERIFY_ARE_EQUAL(sum, big);
+    sum += sum;
+    VERIFY_ARE_EQUAL(sum, big * Rational(2));
+    sum /= sum;
+    VERIFY_ARE_EQUAL(sum, 1);
+
+    // Operators that fail leave the value alone.
+    for (auto operand : { Rational(0), Rational(100000000) })
+    {
+        Rational value = big;
+        try
+        {
+            if (operand == 0)
+            {
+                value /= operand;
+            }
+            else
+            {
+                value <<= operand;
+            }
+            Assert::Fail();
+        }
+        catch (uint32_t)
+        {
+        }
+        VERIFY_ARE_EQUAL(value, big);
+    }
+}
+
+TEST_METHOD(TestNumberMantissaStorage)
+{
+    // Up to MANTISSA_INLINE_DIGITS digits live inside the Number, longer
+    // mantissas go to the heap, copies and moves must keep both intact.
+    std::vector<MANTTYPE> longDigits;
+    for (MANTTYPE digit = 1; digit <= MANTISSA_INLINE_DIGITS + 3; digit++)
+    {
+        longDigits.push_back(digit);
+    }
+    Number shortNumber(-1, 2, { 7, 8 });
+    Number longNumber(1, 0, longDigits);
+
+    Number copy = shortNumber;
+    VERIFY_ARE_EQUAL(copy.Sign(), -1);
+    VERIFY_ARE_EQUAL(copy.Exp(), 2);
+    VERIFY_ARE_EQUAL(copy.Mantissa().size(), 2u);
+    VERIFY_ARE_EQUAL(copy.Mantissa()[1], 8u);
+
+    copy = longNumber;
+    VERIFY_IS_TRUE(std::equal(copy.Mantissa().begin(), copy.Mantissa().end(), longDigits.begin(), longDigits.end()));
+    Number moved = std::move(copy);
+    VERIFY_ARE_EQUAL(moved.Mantissa().back(), MANTTYPE(MANTISSA_INLINE_DIGITS + 3));
+    moved = shortNumber;
+    VERIFY_ARE_EQUAL(moved.Mantissa().front(), 7u);
+    VERIFY_IS_FALSE(moved.IsZero());
+    VERIFY_IS_TRUE(Number().IsZero());
+
+    // Round trips through ratpack either way.
+    PNUMBER pnum = longNumber.ToPNUMBER();
+    Number back{ pnum };
+    destroynum(pnum);
+    VERIFY_IS_TRUE(std::equal(back.Mantissa().begin(), back.Mantissa().end(), longDigits.begin(), longDigits.end()));
+}
+
+TEST_METHOD(TestIntegerMathWords)
+{
+    // Words are two's complement in the low bitWidth bits.
+    VERIFY_ARE_EQUAL(IntegerMath::Divide(0xF9, 2, 8), 0xFDu);   // -7 / 2 = -3
+    VERIFY_ARE_EQUAL(IntegerMath::Remainder(0xF9, 2, 8), 0xFFu); // -7 % 2 = -1
+    VERIFY_ARE_EQUAL(IntegerMath::Remainder(7, 0xFE, 8), 1u);    // 7 % -2 = 1
+    VERIFY_ARE_EQUAL(IntegerMath::Divide(0x8000, 0xFFFF, 16), 0x8000u);
+    VERIFY_ARE_EQUAL(IntegerMath::Add(0xFF, 1, 8), 0u);
+    VERIFY_ARE_EQUAL(IntegerMath::Subtract(0, 1, 64), UINT64_MAX);
+    VERIFY_ARE_EQUAL(IntegerMath::ShiftRight(0x80, 3, 8), 0xF0u);
+    VERIFY_ARE_EQUAL(IntegerMath::ShiftRight(0x40, 3, 8), 0x08u);
+    VERIFY_ARE_EQUAL(IntegerMath::ShiftLeft(0x81, 1, 8), 0x02u);
+    VERIFY_ARE_EQUAL(IntegerMath::RotateLeft(0x81, 8), 0x03u);
+    VERIFY_ARE_EQUAL(IntegerMath::RotateRight(0x81, 8), 0xC0u);
+    VERIFY_ARE_EQUAL(IntegerMath::RotateRight(1, 64), 0x8000000000000000u);
+    VERIFY_ARE_EQUAL(IntegerMath::Complement(0x0F, 16), 0xFFF0u);
+
+    uint64_t word;
+    VERIFY_IS_TRUE(IntegerMath::TryToWord(Rational(-1), 32, word));
+    VERIFY_ARE_EQUAL(word, 0xFFFFFFFFu);
+    VERIFY_IS_TRUE(IntegerMath::TryToWord(Rational(UINT64_MAX), 64, word));
+    VERIFY_ARE_EQUAL(word, UINT64_MAX);
+    VERIFY_IS_TRUE(IntegerMath::TryToWord(-Rational(UINT64_MAX), 64, word));
+    VERIFY_ARE_EQUAL(word, 1u);
+    VERIFY_IS_FALSE(IntegerMath::TryToWord(Rational(7) / Rational(2), 8, word));
+    VERIFY_IS_FALSE(IntegerMath::TryToWord(Rational(UINT64_MAX) + 1, 64, word));
+
+    auto verifyThrows = [](auto op, uint32_t expected) {
+        try
+        {
+            op();
+            Assert::Fail();
+        }
+        catch (uint32_t error)
+        {
+            VERIFY_ARE_EQUAL(error, expected);
+        }
+    };
+    verifyThrows([] { IntegerMath::Divide(5, 0, 8); }, CALC_E_DIVIDEBYZERO);
+    verifyThrows([] { IntegerMath::Divide(0, 0, 8); }, CALC_E_INDEFINITE);
+    verifyThrows([] { IntegerMath::Remainder(5, 0, 8); }, CALC_E_INDEFINITE);
+    verifyThrows([] { IntegerMath::ShiftLeft(1, 8, 8); }, CALC_E_NORESULT);
+}
+
+TEST_METHOD(TestIntegerMathWideWords)
+{
+    auto toWide = [](Rational const& rat, int32_t bitWidth) {
+        IntegerMath::WideWord word;
+        VERIFY_IS_TRUE(IntegerMath::TryToWideWord(rat, bitWidth, word));
+        return word;
+    };
+    auto fromWide = [](IntegerMath::WideWord const& word, int32_t bitWidth) { return IntegerMath::FromWideWord(word, bitWidth); };
+
+    Rational two127 = Rational(1) << 127;
+    Rational max128 = (Rational(1) << 128) - 1;
+
+    // -1 is every bit of the word, and wraps back to -1.
+    VERIFY_ARE_EQUAL(fromWide(toWide(Rational(-1), 128), 128), max128);
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::Add(toWide(max128, 128), toWide(1, 128), 128), 128), 0);
+    VERIFY_IS_TRUE(IntegerMath::IsNegative(toWide(two127, 128), 128));
+    VERIFY_IS_TRUE(IntegerMath::IsMsbSet(-Rational(5), 256));
+
+    // Products and quotients spanning several limbs.
+    Rational a = (Rational(UINT64_MAX) << 100) + 12345;
+    Rational b = (Rational(1) << 70) + 3;
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::Multiply(toWide(a, 256), toWide(b, 256), 256), 256), a * b);
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::Divide(toWide(a * b + 7, 256), toWide(b, 256), 256), 256), a);
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::Remainder(toWide(a * b + 7, 256), toWide(b, 256), 256), 256), 7);
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::Divide(toWide(-a, 512), toWide(b, 512), 512), 512), fromWide(toWide(-Integer(a / b), 512), 512));
+
+    // Shifts and rotates across the limb boundaries.
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::ShiftLeft(toWide(a, 1024), toWide(333, 1024), 1024), 1024), a << 333);
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::ShiftRight(toWide(two127, 128), toWide(64, 128), 128), 128), max128 - ((Rational(1) << 63) - 1));
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::RotateLeft(toWide(two127 + 1, 128), 128), 128), 3);
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::RotateRight(toWide(1, 128), 128), 128), two127);
+    VERIFY_ARE_EQUAL(fromWide(IntegerMath::Complement(toWide(0, 128), 128), 128), max128);
+
+    try
+    {
+        IntegerMath::ShiftLeft(toWide(1, 128), toWide(128, 128), 128);
+        Assert::Fail();
+    }
+    catch (uint32_t error)
+    {
+        VERIFY_ARE_EQUAL(error, CALC_E_NORESULT);
+    }
+}
+
+TEST_METHOD(TestBitKernels)
+{
+    // Shifts across several BASEX digits, and back down to the value.
+    Rational a = (Rational(UINT64_MAX) << 100) + 12345;
+    VERIFY_ARE_EQUAL(a << 333, a * Pow(2, 333));
+    VERIFY_ARE_EQUAL((a << 333) >> 333, a);
+    VERIFY_ARE_EQUAL(-a << 1, -(a * 2));
+    VERIFY_ARE_EQUAL(Integer(a >> 101), Rational(UINT64_MAX >> 1));
+    VERIFY_ARE_EQUAL(a >> -7, a << 7);
+    VERIFY_ARE_EQUAL(Rational(7) >> 1, Rational(7) / 2);
+
+    // Logicals on operands of different lengths.
+    Rational b = (Rational(1) << 200) + 0xF0F0;
+    VERIFY_ARE_EQUAL(a & b, Rational(12345 & 0xF0F0));
+    VERIFY_ARE_EQUAL(a | b, (Rational(UINT64_MAX) << 100) + (Rational(1) << 200) + (12345 | 0xF0F0));
+    VERIFY_ARE_EQUAL(a ^ a, 0);
+
+    PNUMBER num = b.P().ToPNUMBER();
+    VERIFY_ARE_EQUAL(_popcountnum(num), 9);
+    VERIFY_ARE_EQUAL(_ctznum(num), 4);
+    _shlnum(&num, 100);
+    VERIFY_ARE_EQUAL(_popcountnum(num), 9);
+    VERIFY_ARE_EQUAL(_ctznum(num), 104);
+    destroynum(num);
+}
+
+TEST_METHOD(TestIntegerMathRadixStrings)
+{
+    auto spell = [](Rational const& rat, uint32_t radix, int32_t bitWidth) {
+        IntegerMath::WideWord word;
+        VERIFY_IS_TRUE(IntegerMath::TryToWideWord(rat, bitWidth, word));
+        return IntegerMath::ToRadixString(word, radix, bitWidth);
+    };
+
+    VERIFY_ARE_EQUAL(spell(0, 16, 64), L"0");
+    VERIFY_ARE_EQUAL(spell(0, 2, 64), L"0");
+    VERIFY_ARE_EQUAL(spell(0x2F, 16, 8), L"2F");
+    VERIFY_ARE_EQUAL(spell(0x2F, 8, 8), L"57");
+    VERIFY_ARE_EQUAL(spell(0x2F, 2, 8), L"101111");
+    VERIFY_ARE_EQUAL(spell(0x2F, 10, 8), L"47");
+
+    // Only decimal reads the top bit as a sign.
+    VERIFY_ARE_EQUAL(spell(-1, 16, 16), L"FFFF");
+    VERIFY_ARE_EQUAL(spell(-1, 10, 16), L"-1");
+    VERIFY_ARE_EQUAL(spell(Rational(1) << 127, 10, 128), L"-170141183460469231731687303715884105728");
+    VERIFY_ARE_EQUAL(spell(Rational(1) << 127, 8, 128), L"2" + std::wstring(42, L'0'));
+
+    // Nine digit groups past the first have their zeros kept, and the
+    // strings agree with the ones ToString would give.
+    Rational big = Pow(10, 40) + 7;
+    VERIFY_ARE_EQUAL(spell(big, 10, 256), L"1" + std::wstring(39, L'0') + L"7");
+    for (uint32_t radix : { 2u, 8u, 10u, 16u })
+    {
+        VERIFY_ARE_EQUAL(spell(big, radix, 1024), big.ToString(radix, FMT_FLOAT, 1024));
+    }
+}
+
+TEST_METHOD(TestFactorial)
+{
+    // Integers get the exact product, anything else gamma from Stirling's
+    // series, good to the last digit shown.
+    ChangeConstants(10, 128);
+    VERIFY_ARE_EQUAL(Fact(20), Rational((uint64_t)2432902008176640000));
+    VERIFY_ARE_EQUAL(Fact(3249), Fact(3248) * 3249);
+    VERIFY_ARE_EQUAL(Fact(10000), Fact(9999) * 10000);
+    VERIFY_ARE_EQUAL(Fact(Rational(5) + Pow(10, -200)), 120);
+
+    VERIFY_ARE_EQUAL(
+        Fact(Rational(1) / 2).ToString(10, FMT_FLOAT, 100),
+        L"0.8862269254527580136490837416705725913987747280611935641069038949264556422955160906874753283692723327");
+    VERIFY_ARE_EQUAL(
+        Fact(Rational(33) / 10).ToString(10, FMT_FLOAT, 100),
+        L"8.855343360454037018867880138730147153473017114370768905233868578796006391790695477272968485565901439");
+    VERIFY_ARE_EQUAL(
+        Fact(Rational(-3) / 2).ToString(10, FMT_FLOAT, 100),
+        L"-3.544907701811032054596334966682290365595098912244774256427615579705822569182064362749901313477089331");
+
+    std::pair<Rational, uint32_t> errors[] = { { 11924, CALC_E_OVERFLOW }, { Rational(-23849) / 2, CALC_E_OVERFLOW }, { -3, CALC_E_DOMAIN } };
+    for (auto const& error : errors)
+    {
+        try
+        {
+            Fact(error.first);
+            Assert::Fail();
+        }
+        catch (uint32_t t)
+        {
+            VERIFY_ARE_EQUAL(t, error.second);
+        }
+    }
+}
+
+TEST_METHOD(TestRoot)
+{
+    // Perfect powers come out exact however long they are.
+    ChangeConstants(10, 128);
+    Rational f = Fact(3000);
+    VERIFY_ARE_EQUAL(Root(f * f, 2), f);
+    VERIFY_ARE_EQUAL(Root(f * f * f, 3), f);
+    VERIFY_ARE_EQUAL(Root(Rational(4) / 9, 2), Rational(2) / 3);
+    VERIFY_ARE_EQUAL(Root(-27, 3), -3);
+    VERIFY_ARE_EQUAL(Root(Rational(8) / 27, -3), Rational(3) / 2);
+    VERIFY_ARE_EQUAL(Pow(32, Rational(3) / 5), 8);
+
+    VERIFY_ARE_EQUAL(
+        Root(2, 2).ToString(10, FMT_FLOAT, 100),
+        L"1.414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641573");
+    VERIFY_ARE_EQUAL(
+        Root(Rational(7) / 11, 5).ToString(10, FMT_FLOAT, 100),
+        L"0.9135684039934859067504734156175544879914986326845433121478698273635279918169152195834648170352930665");
+
+    // Roots below one keep the exponent on the denominator, typed small
+    // numbers are over a power of ten.
+    auto typed = [](const wchar_t* mantissa, const wchar_t* exponent) {
+        PRAT x = StringToRat(false, mantissa, true, exponent, 10, 128);
+        Rational r(x);
+        destroyrat(x);
+        return r;
+    };
+    VERIFY_ARE_EQUAL(Root(typed(L"1", L"60"), 2).ToString(10, FMT_FLOAT, 100), L"0.000000000000000000000000000001");
+    VERIFY_ARE_EQUAL(Root(typed(L"1", L"40"), 2).ToString(10, FMT_FLOAT, 100), L"0.00000000000000000001");
+    VERIFY_ARE_EQUAL(Root(typed(L"1", L"200"), 5).ToString(10, FMT_FLOAT, 100), L"0.0000000000000000000000000000000000000001");
+    VERIFY_ARE_EQUAL(Root(typed(L"1", L"60"), -2).ToString(10, FMT_FLOAT, 100), L"1000000000000000000000000000000");
+    VERIFY_ARE_EQUAL(Root(typed(L"1", L"40"), -2).ToString(10, FMT_FLOAT, 100), L"100000000000000000000");
+    VERIFY_ARE_EQUAL(Pow(typed(L"1", L"60"), Rational(1) / 2).ToString(10, FMT_FLOAT, 100), L"0.000000000000000000000000000001");
+
+    try
+    {
+        Root(-4, 2);
+        Assert::Fail();
+    }
+    catch (uint32_t t)
+    {
+        VERIFY_ARE_EQUAL(t, CALC_E_DOMAIN);
+    }
+}
+
+TEST_METHOD(TestIntegerPowers)
+{
+    // Integer powers of integers and of rationals are exact, squares take
+    // the squaring kernels.
+    ChangeConstants(10, 128);
+    VERIFY_ARE_EQUAL(Pow(2, 100000), Rational(1) << 100000);
+    VERIFY_ARE_EQUAL(Pow(7, 1001), Pow(7, 1000) * 7);
+    VERIFY_ARE_EQUAL(Pow(Rational(2) / 3, 45), Pow(2, 45) / Pow(3, 45));
+    VERIFY_ARE_EQUAL(Pow(Rational(-5) / 4, -3), Rational(-64) / 125);
+    VERIFY_ARE_EQUAL(Pow(0, 7), 0);
+
+    Rational f = Fact(3000);
+    VERIFY_ARE_EQUAL(Pow(f, 2), f * f);
+    VERIFY_ARE_EQUAL(Pow(f, 3), f * f * f);
+
+    VERIFY_ARE_EQUAL(
+        Pow(Rational(7) / 3, 1000).ToString(10, FMT_FLOAT, 100),
+        L"9.479497024659295575327296734405774076946276306568863808493561096354552532604191797739449052905343965e+367");
+}
+
+TEST_METHOD(TestZeroResults)
+{
+    // Typed powers of ten carry a BASEX exponent, a zero made from them
+    // must not.
+    ChangeConstants(10, 128);
+    auto typed = [](const wchar_t* mantissa, const wchar_t* exponent) {
+        PRAT x = StringToRat(false, mantissa, false, exponent, 10, 128);
+        Rational r(x);
+        destroyrat(x);
+        return r;
+    };
+    for (auto exponent : { L"400", L"1000" })
+    {
+        Rational big = typed(L"7", exponent);
+        VERIFY_ARE_EQUAL((big * 0).ToString(10, FMT_FLOAT, 100), L"0");
+        VERIFY_ARE_EQUAL((-big * 0).ToString(10, FMT_FLOAT, 100), L"0");
+        VERIFY_ARE_EQUAL((big - big).ToString(10, FMT_FLOAT, 100), L"0");
+        VERIFY_ARE_EQUAL((Pow(big, 2) * 0).ToString(10, FMT_FLOAT, 100), L"0");
+    }
+}
+
+TEST_METHOD(TestAgmLog)
+{
+    // Past _agmfaster's threshold lograt takes the arithmetic-geometric mean,
+    // RationalMath stays at 128 digits so ratpak is called directly.
+    ChangeConstants(10, 1000);
+    VERIFY_IS_TRUE(_agmfaster(1000));
+    VERIFY_IS_FALSE(_agmfaster(128));
+
+    PRAT x = (Rational(123456789) / 10000).ToPRAT();
+    lograt(&x, 1000);
+    VERIFY_ARE_EQUAL(
+        Rational(x).ToString(10, FMT_FLOAT, 100),
+        L"9.421061394191835297121967529225747379309275886505310071051778341221927028546941856712127599831909502");
+    destroyrat(x);
+
+    x = (Rational(1) / 7).ToPRAT();
+    lograt(&x, 1000);
+    VERIFY_ARE_EQUAL(
+        Rational(x).ToString(10, FMT_FLOAT, 100),
+        L"-1.945910149055313305105352743443179729637084729581861188459390149937579862752069267787658498587871527");
+    exprat(&x, 10, 1000);
+    VERIFY_ARE_EQUAL(Rational(x).ToString(10, FMT_FLOAT, 990), (Rational(1) / 7).ToString(10, FMT_FLOAT, 990));
+    destroyrat(x);
+
+    x = Rational(7).ToPRAT();
+    lograt(&x, 1000);
+    exprat(&x, 10, 1000);
+    VERIFY_ARE_EQUAL(Rational(x).ToString(10, FMT_FLOAT, 990), L"7");
+    destroyrat(x);
+
+    ChangeConstants(10, 128);
+}
 }
 ;
 }